@@ -0,0 +1,435 @@
+#include "../StringSearcher.h"
+#include "../Timer.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+command line format:
+	Benchmark.exe [--corpus <dir>] [--scale <factor>] [--repetitions N] [--regenerate]
+
+	command line options :
+		--corpus			directory the corpora are generated in. Defaults to StringSearcherBenchmark in the temp directory
+		--scale				multiplies the size of every corpus, e.g. 0.1 for a quick run. Defaults to 1
+		--repetitions		number of timed runs of every benchmark, after one untimed warm-up run. Defaults to 5
+		--regenerate		generate the corpora even if they already exist
+
+	output:
+		one JSON object per line on stdout for every corpus and mode, progress is printed on stderr
+		{"corpus":"small_files","mode":"literal","files":20000,"bytes":81920000,"seconds":0.1,"gb_per_s":0.8,"files_per_s":200000,"p50_ms":0.004,"p99_ms":0.01,"lines_found":812,"lines_expected":812}
+
+		seconds is the median of all repetitions, p50_ms and p99_ms are the per file latencies and are null for the recursive modes
+		the exit code is 1 if any search did not find exactly the lines the generator put in
+
+	example:
+		D:\ExampleDir\> Benchmark.exe --scale 0.1 > baseline.json
+*/
+
+namespace RDW_SS::Benchmark
+{
+	namespace
+	{
+		// the corpora are generated from a fixed seed, so every machine and every run searches the same bytes
+		// only the numbers std::mt19937 gives are the same for every standard library, the std distributions are not, so none are used
+		// bump CorpusVersion whenever the generator changes, so old corpora are regenerated
+		inline static constexpr uint32_t CorpusVersion{ 2 };
+		inline static constexpr uint32_t Seed{ 0x5EED };
+		inline static constexpr std::string_view Needle{ "benchmark_needle" };
+
+		inline static constexpr std::string_view Words[]
+		{
+			"alpha", "beta", "gamma", "delta", "error", "warning", "info", "value", "index", "buffer",
+			"string", "return", "const", "static", "struct", "void", "template", "namespace", "0x1F", "42",
+		};
+
+		struct CorpusDescription final
+		{
+			std::string_view Name;
+			uint32_t NrOfFiles;
+			uint32_t FileSize;
+			uint32_t NrOfDirectories; // the files are spread over this many directories
+			bool IsDeep; // the directories are nested in each other instead of side by side
+			double MatchDensity; // chance of a line containing the needle
+			bool IsMixedCase; // text and needles in random case
+		};
+
+		inline static constexpr CorpusDescription Corpora[]
+		{
+			{ "small_files", 20'000, 4 * 1024, 100, false, 0.01, false },
+			{ "huge_files", 4, 64 * 1024 * 1024, 1, false, 0.001, false },
+			{ "deep_tree", 2'000, 16 * 1024, 32, true, 0.01, false },
+			{ "high_density", 200, 256 * 1024, 10, false, 0.5, false },
+			{ "low_density", 200, 256 * 1024, 10, false, 0.00001, false },
+			{ "mixed_case", 200, 256 * 1024, 10, false, 0.01, true },
+		};
+
+		/// <summary>
+		/// What the generator put in a corpus, so every search can be checked against it
+		/// </summary>
+		struct Corpus final
+		{
+			std::string Name;
+			std::vector<std::string> Files;
+			uint64_t NrOfBytes;
+			uint64_t NrOfExactMatches; // lines with the needle in lowercase
+			uint64_t NrOfMatches; // lines with the needle in any case
+		};
+
+		struct BenchmarkOptions final
+		{
+			std::string CorpusDir;
+			double Scale;
+			uint32_t NrOfRepetitions;
+			bool Regenerate;
+		};
+
+		static bool ParseCmdArgs(int argc, char* argv[], BenchmarkOptions& options)
+		{
+			for (int i{ 1 }; i < argc; ++i)
+			{
+				const std::string currentArg{ argv[i] };
+				const bool hasValue{ i < argc - 1 };
+
+				if (currentArg == "--corpus" && hasValue)
+				{
+					options.CorpusDir = argv[++i];
+				}
+				else if (currentArg == "--scale" && hasValue)
+				{
+					options.Scale = std::atof(argv[++i]);
+				}
+				else if (currentArg == "--repetitions" && hasValue)
+				{
+					options.NrOfRepetitions = static_cast<uint32_t>(std::max(std::atoi(argv[++i]), 1));
+				}
+				else if (currentArg == "--regenerate")
+				{
+					options.Regenerate = true;
+				}
+				else
+				{
+					std::cerr << "Unknown or incomplete argument: " << currentArg << "\n";
+					return false;
+				}
+			}
+
+			return options.Scale > 0.0;
+		}
+
+		static CorpusDescription ScaleCorpus(CorpusDescription description, const double scale)
+		{
+			// a corpus of few files grows by making them bigger, every other corpus by adding files
+			if (description.NrOfFiles < 10)
+			{
+				description.FileSize = std::max(static_cast<uint32_t>(description.FileSize * scale), 1024u);
+			}
+			else
+			{
+				description.NrOfFiles = std::max(static_cast<uint32_t>(description.NrOfFiles * scale), 1u);
+			}
+
+			return description;
+		}
+
+		static std::string GetFileDirectory(const CorpusDescription& description, const uint32_t fileIndex)
+		{
+			const uint32_t directoryIndex{ fileIndex % description.NrOfDirectories };
+			if (!description.IsDeep) return "d" + std::to_string(directoryIndex);
+
+			std::string directory{};
+			for (uint32_t i{}; i <= directoryIndex; ++i)
+			{
+				if (i > 0) directory += '/';
+				directory += "d" + std::to_string(i);
+			}
+
+			return directory;
+		}
+
+		static void AppendWord(std::string& line, const std::string_view word, const bool isMixedCase, std::mt19937& random)
+		{
+			for (const char c : word)
+			{
+				line += (isMixedCase && (random() & 1) && c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c;
+			}
+		}
+
+		/// <summary>
+		/// Writes one file of roughly description.FileSize bytes, lines of 40 to 120 characters
+		/// </summary>
+		static bool GenerateFile(const std::string& path, const CorpusDescription& description, std::mt19937& random, Corpus& corpus)
+		{
+			std::ofstream stream{ path, std::ios::binary | std::ios::trunc };
+			if (!stream.is_open()) return false;
+
+			// random() is uniform over 32 bits, so a line has the needle with a chance of MatchDensity
+			const uint64_t needleThreshold{ static_cast<uint64_t>(description.MatchDensity * 4294967296.0) };
+
+			std::string data{}, line{};
+			data.reserve(description.FileSize + 128);
+
+			while (data.size() < description.FileSize)
+			{
+				line.clear();
+
+				const uint32_t length{ 40 + static_cast<uint32_t>(random() % 81) };
+				const bool hasNeedle{ random() < needleThreshold };
+				const uint32_t needlePosition{ hasNeedle ? static_cast<uint32_t>(random() % length) : length };
+
+				bool isNeedleAdded{};
+				while (line.size() < length)
+				{
+					if (!line.empty()) line += ' ';
+
+					if (hasNeedle && !isNeedleAdded && line.size() >= needlePosition)
+					{
+						const size_t start{ line.size() };
+						AppendWord(line, Needle, description.IsMixedCase, random);
+
+						isNeedleAdded = true;
+						if (std::string_view{ line }.substr(start) == Needle) ++corpus.NrOfExactMatches;
+						++corpus.NrOfMatches;
+					}
+					else
+					{
+						AppendWord(line, Words[random() % std::size(Words)], description.IsMixedCase, random);
+					}
+				}
+
+				data += line;
+				data += '\n';
+			}
+
+			stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+			corpus.NrOfBytes += data.size();
+
+			return stream.good();
+		}
+
+		static bool GenerateCorpus(const std::string& corpusDir, const CorpusDescription& description, Corpus& corpus)
+		{
+			std::mt19937 random{ Seed };
+
+			std::error_code error{};
+			std::filesystem::remove_all(corpusDir, error);
+
+			for (uint32_t i{}; i < description.NrOfFiles; ++i)
+			{
+				const std::filesystem::path directory{ std::filesystem::path{ corpusDir } / GetFileDirectory(description, i) };
+				std::filesystem::create_directories(directory, error);
+
+				if (!GenerateFile((directory / ("file" + std::to_string(i) + ".txt")).string(), description, random, corpus))
+				{
+					std::cerr << "Could not write corpus: " << corpusDir << "\n";
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		static std::string GetMarkerFile(const std::string& corpusDir)
+		{
+			return corpusDir + "/corpus.txt";
+		}
+
+		/// <summary>
+		/// The marker file holds the generator version, scale and expected matches, it is written last so a half generated corpus is never reused
+		/// </summary>
+		static bool ReadMarkerFile(const std::string& corpusDir, const double scale, Corpus& corpus)
+		{
+			std::ifstream stream{ GetMarkerFile(corpusDir) };
+
+			uint32_t version{};
+			double corpusScale{};
+			if (!(stream >> version >> corpusScale >> corpus.NrOfBytes >> corpus.NrOfExactMatches >> corpus.NrOfMatches)) return false;
+
+			return version == CorpusVersion && corpusScale == scale;
+		}
+
+		static void WriteMarkerFile(const std::string& corpusDir, const double scale, const Corpus& corpus)
+		{
+			std::ofstream stream{ GetMarkerFile(corpusDir) };
+			stream << CorpusVersion << " " << scale << " " << corpus.NrOfBytes << " " << corpus.NrOfExactMatches << " " << corpus.NrOfMatches << "\n";
+		}
+
+		static bool PrepareCorpus(const BenchmarkOptions& options, const CorpusDescription& description, Corpus& corpus)
+		{
+			const std::string corpusDir{ (std::filesystem::path{ options.CorpusDir } / description.Name).string() };
+			corpus = Corpus{ std::string{ description.Name }, {}, 0, 0, 0 };
+
+			if (options.Regenerate || !ReadMarkerFile(corpusDir, options.Scale, corpus))
+			{
+				std::cerr << "Generating " << description.Name << "\n";
+
+				corpus = Corpus{ std::string{ description.Name }, {}, 0, 0, 0 };
+				if (!GenerateCorpus(corpusDir, ScaleCorpus(description, options.Scale), corpus)) return false;
+
+				WriteMarkerFile(corpusDir, options.Scale, corpus);
+			}
+
+			for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator{ corpusDir })
+			{
+				if (entry.is_regular_file() && entry.path().filename() != "corpus.txt") corpus.Files.push_back(entry.path().string());
+			}
+
+			std::sort(corpus.Files.begin(), corpus.Files.end());
+			return true;
+		}
+
+		static double GetPercentile(std::vector<double>& samples, const double percentile)
+		{
+			if (samples.empty()) return 0.0;
+
+			const size_t index{ static_cast<size_t>(std::ceil(percentile * samples.size())) };
+			std::nth_element(samples.begin(), samples.begin() + (std::max<size_t>(index, 1) - 1), samples.end());
+
+			return samples[std::max<size_t>(index, 1) - 1];
+		}
+
+		static uint64_t CountLines(const std::vector<FileSearchResult>& results)
+		{
+			uint64_t nrOfLines{};
+			for (const FileSearchResult& result : results)
+			{
+				nrOfLines += result.LineNumbers.size();
+			}
+
+			return nrOfLines;
+		}
+
+		struct BenchmarkResult final
+		{
+			double Seconds;
+			std::vector<double> FileLatencies; // in milliseconds, empty for the recursive modes
+			uint64_t NrOfLinesFound;
+		};
+
+		/// <summary>
+		/// Searches every file on its own and on a single thread, which is what the per file latencies are measured on
+		/// </summary>
+		static void RunPerFile(const std::string& corpusDir, const Corpus& corpus, const bool ignoreCase, BenchmarkResult& result)
+		{
+			const std::vector<std::string> stringsToSearch{ std::string{ Needle } };
+			std::vector<FileSearchResult> results{};
+
+			result.NrOfLinesFound = 0;
+			const Time::Timepoint start{ Time::Timer::Now() };
+
+			for (const std::string& file : corpus.Files)
+			{
+				const Time::Timepoint fileStart{ Time::Timer::Now() };
+				IsStringInFile(corpusDir, file, stringsToSearch, SearchOptions{ .IgnoreCase = ignoreCase }, results);
+
+				result.FileLatencies.push_back((Time::Timer::Now() - fileStart).Count<Time::TimeLength::MilliSeconds>());
+				result.NrOfLinesFound += CountLines(results);
+			}
+
+			result.Seconds = (Time::Timer::Now() - start).Count();
+		}
+
+		static void RunRecursive(const std::string& corpusDir, const bool ignoreCase, BenchmarkResult& result)
+		{
+			const std::vector<std::string> stringsToSearch{ std::string{ Needle } };
+			std::vector<FileSearchResult> results{};
+
+			const Time::Timepoint start{ Time::Timer::Now() };
+			IsStringInFile(corpusDir, "", stringsToSearch, SearchOptions{ .IgnoreCase = ignoreCase, .RecursivelySearch = true }, results);
+			result.Seconds = (Time::Timer::Now() - start).Count();
+
+			result.NrOfLinesFound = CountLines(results);
+		}
+
+		/// <summary>
+		/// Prints one JSON line, returns false if the search did not find what the generator put in
+		/// </summary>
+		static bool RunBenchmark(const BenchmarkOptions& options, const Corpus& corpus, const std::string_view mode, const bool recursivelySearch, const bool ignoreCase)
+		{
+			const std::string corpusDir{ (std::filesystem::path{ options.CorpusDir } / corpus.Name).string() };
+			const uint64_t nrOfLinesExpected{ ignoreCase ? corpus.NrOfMatches : corpus.NrOfExactMatches };
+
+			std::vector<double> seconds{}, fileLatencies{};
+			uint64_t nrOfLinesFound{};
+
+			// the first run only warms the page cache
+			for (uint32_t i{}; i <= options.NrOfRepetitions; ++i)
+			{
+				BenchmarkResult result{};
+				if (recursivelySearch) RunRecursive(corpusDir, ignoreCase, result);
+				else RunPerFile(corpusDir, corpus, ignoreCase, result);
+
+				nrOfLinesFound = result.NrOfLinesFound;
+				if (i == 0) continue;
+
+				seconds.push_back(result.Seconds);
+				fileLatencies.insert(fileLatencies.end(), result.FileLatencies.begin(), result.FileLatencies.end());
+			}
+
+			const double medianSeconds{ std::max(GetPercentile(seconds, 0.5), 1e-9) };
+
+			char line[512]{};
+			int length{ std::snprintf(line, sizeof(line),
+				"{\"corpus\":\"%s\",\"mode\":\"%.*s\",\"files\":%zu,\"bytes\":%llu,\"seconds\":%.6f,\"gb_per_s\":%.3f,\"files_per_s\":%.1f,",
+				corpus.Name.c_str(), static_cast<int>(mode.size()), mode.data(), corpus.Files.size(), static_cast<unsigned long long>(corpus.NrOfBytes),
+				medianSeconds, static_cast<double>(corpus.NrOfBytes) / medianSeconds / 1e9, static_cast<double>(corpus.Files.size()) / medianSeconds) };
+
+			if (fileLatencies.empty())
+			{
+				length += std::snprintf(line + length, sizeof(line) - length, "\"p50_ms\":null,\"p99_ms\":null,");
+			}
+			else
+			{
+				const double p50{ GetPercentile(fileLatencies, 0.5) };
+				const double p99{ GetPercentile(fileLatencies, 0.99) };
+				length += std::snprintf(line + length, sizeof(line) - length, "\"p50_ms\":%.4f,\"p99_ms\":%.4f,", p50, p99);
+			}
+
+			std::snprintf(line + length, sizeof(line) - length, "\"lines_found\":%llu,\"lines_expected\":%llu}",
+				static_cast<unsigned long long>(nrOfLinesFound), static_cast<unsigned long long>(nrOfLinesExpected));
+
+			std::cout << line << std::endl;
+
+			if (nrOfLinesFound != nrOfLinesExpected)
+			{
+				std::cerr << "Mismatch in " << corpus.Name << " (" << mode << "): found " << nrOfLinesFound << " lines, expected " << nrOfLinesExpected << "\n";
+				return false;
+			}
+
+			return true;
+		}
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	using namespace RDW_SS::Benchmark;
+
+	BenchmarkOptions options{ (std::filesystem::temp_directory_path() / "StringSearcherBenchmark").string(), 1.0, 5, false };
+	if (!ParseCmdArgs(argc, argv, options))
+	{
+		std::cerr << "Usage: Benchmark.exe [--corpus <dir>] [--scale <factor>] [--repetitions N] [--regenerate]\n";
+		return 1;
+	}
+
+	bool isCorrect{ true };
+	for (const CorpusDescription& description : Corpora)
+	{
+		Corpus corpus{};
+		if (!PrepareCorpus(options, description, corpus)) return 1;
+
+		std::cerr << "Searching " << corpus.Name << "\n";
+
+		isCorrect &= RunBenchmark(options, corpus, "literal", false, false);
+		isCorrect &= RunBenchmark(options, corpus, "ignorecase", false, true);
+		isCorrect &= RunBenchmark(options, corpus, "recursive", true, false);
+		isCorrect &= RunBenchmark(options, corpus, "recursive_ignorecase", true, true);
+	}
+
+	return isCorrect ? 0 : 1;
+}
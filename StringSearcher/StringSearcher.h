@@ -1,22 +1,96 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
 #include <mutex>
+#include <new>
+#include <set>
+#include <span>
 #include <stack>
 #include <string>
 #include <string_view>
 #include <thread>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
+#include <variant>
 #include <vector>
+
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define RDW_SS_HAS_SSE2
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define RDW_SS_TARGET_SSSE3
+#define RDW_SS_TARGET_AVX2
+#else
+#define RDW_SS_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define RDW_SS_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+// Searching inside compressed files is opt-in, as it needs zlib or zstd to be linked
+// Define RDW_SS_USE_ZLIB for .gz files and RDW_SS_USE_ZSTD for .zst files before including this header
+// The StringSearcher project defines both and gets the libraries from vcpkg, see vcpkg.json
+#if defined(RDW_SS_USE_ZLIB) && __has_include(<zlib.h>)
+#define RDW_SS_HAS_ZLIB
+#include <zlib.h>
+#endif
+
+#if defined(RDW_SS_USE_ZSTD) && __has_include(<zstd.h>)
+#define RDW_SS_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+#ifdef _WIN32
 #include <Windows.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#ifdef __linux__
+#define RDW_SS_HAS_INOTIFY
+#include <sys/inotify.h>
+#include <sys/syscall.h>
+#if __has_include(<linux/io_uring.h>)
+#define RDW_SS_HAS_IO_URING
+#include <linux/io_uring.h>
+#endif
+#endif
+#endif
+
+#ifdef _MSC_VER
+#define RDW_SS_DEBUG_BREAK() __debugbreak()
+#else
+#define RDW_SS_DEBUG_BREAK() __builtin_trap()
+#endif
 
 #ifdef _DEBUG
 #define RDW_SS_ASSERT(expr) if (!(expr))	\
 							{	\
 								std::cout << "Assertion triggered at line: " << __LINE__ << " in file: " << __FILE__ << "\n";	\
-								__debugbreak();	\
+								RDW_SS_DEBUG_BREAK();	\
 							}
 #else
 #define RDW_SS_ASSERT(expr)
@@ -24,244 +98,8165 @@
 
 namespace RDW_SS
 {
+	/// <summary>
+	/// All lines of one file that contain one of the searched strings
+	/// </summary>
+	struct FileSearchResult final
+	{
+		std::string Path;
+		uint32_t PatternIndex; // index in the searched strings
+		std::vector<uint32_t> LineNumbers; // empty for a binary file searched with BinaryFileMode::ReportMatch
+		bool IsBinary;
+	};
+
+	/// <summary>
+	/// A line of a buffer searched by a Searcher that contains one of its patterns
+	/// </summary>
+	struct BufferMatch final
+	{
+		size_t PatternIndex; // index in the Searcher's patterns
+		uint32_t LineNumber; // the first line is 1
+		std::string_view Line; // without its '\n', points into the searched buffer
+	};
+
+	/// <summary>
+	/// What to do with a file whose first block looks like binary data rather than text
+	/// </summary>
+	enum class BinaryFileMode
+	{
+		Skip,
+		ReportMatch, // only report which strings the file contains, the search stops once all of them are found
+		SearchAsText,
+	};
+
+	/// <summary>
+	/// Lets a search stop reading before it has seen every line of every file
+	/// The files are still searched in blocks, so up to a block is read past the match a search stops at
+	/// </summary>
+	struct SearchLimits final
+	{
+		uint32_t MaxMatchesPerFile; // 0 for no limit, a file is not read any further once this many of its lines matched
+		bool StopAtFirstMatch; // the whole search stops at the first match, only the files that matched by then are reported
+	};
+
+	/// <summary>
+	/// Called with every result as soon as its file has been searched, always from the same thread
+	/// </summary>
+	using ResultCallback = std::function<void(FileSearchResult&&)>;
+
 	namespace Detail
 	{
+		template<typename ... Ts>
+		struct Overloaded final : Ts...
+		{
+			using Ts::operator()...;
+		};
+
+		template<typename ... Ts>
+		Overloaded(Ts...) -> Overloaded<Ts...>;
+
+		/// <summary>
+		/// Prints message followed by path as one write, so the lines of threads printing at the same time never run into each other
+		/// </summary>
+		inline static void PrintMessage(const std::string_view message, const std::string_view path)
+		{
+			std::string line{};
+			line.reserve(message.size() + path.size() + 1);
+			line.append(message).append(path).push_back('\n');
+
+			std::cout.write(line.data(), static_cast<std::streamsize>(line.size()));
+		}
+
+		/// <summary>
+		/// ASCII only, which is what std::tolower does in the default "C" locale
+		/// </summary>
+		inline static constexpr char ToLowercase(const char c)
+		{
+			return (c >= 'A' && c <= 'Z') ? static_cast<char>(c | 0x20) : c;
+		}
+
+		inline static constexpr bool IsAlpha(const char c)
+		{
+			return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+		}
+
 		inline static void TransformStringToLowercase(std::string& str)
 		{
-			std::transform(str.begin(), str.end(), str.begin(), [](const char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+			std::transform(str.begin(), str.end(), str.begin(), ToLowercase);
 		}
 
-		inline void SearchFilesForString(
-			const std::vector<std::string>& filesToLookThrough,
-			std::string stringToSearch,
-			const bool ignoreCase,
-			std::unordered_map<std::string, std::vector<uint32_t>>& foundStrings,
-			std::mutex& mutex)
+		inline int CountTrailingZeros(const uint32_t value)
 		{
-			std::ifstream stream{};
+			RDW_SS_ASSERT(value != 0);
 
-			for (const std::string& filename : filesToLookThrough)
+#ifdef _MSC_VER
+			unsigned long index{};
+			_BitScanForward(&index, value);
+			return static_cast<int>(index);
+#else
+			return __builtin_ctz(value);
+#endif
+		}
+
+		/// <summary>
+		/// Compares haystack bytes against the needle, when IgnoreCase is set the needle must already be lowercase
+		/// </summary>
+		template<bool IgnoreCase>
+		inline bool AreBytesEqual(const char* pHaystack, const char* pNeedle, const size_t size)
+		{
+			if constexpr (IgnoreCase)
+			{
+				for (size_t i{}; i < size; ++i)
+				{
+					if (ToLowercase(pHaystack[i]) != pNeedle[i]) return false;
+				}
+
+				return true;
+			}
+			else
 			{
-				stream.open(filename);
+				return std::memcmp(pHaystack, pNeedle, size) == 0;
+			}
+		}
 
-				if (!stream.is_open())
+		/// <summary>
+		/// Byte that has to be OR'ed into a haystack byte before comparing it against a (lowercase) needle byte
+		/// Letters differ from their uppercase version only in bit 0x20. Non-letters that end up equal are weeded out during verification
+		/// </summary>
+		template<bool IgnoreCase>
+		inline constexpr char GetCaseMask(const char c)
+		{
+			return (IgnoreCase && IsAlpha(c)) ? static_cast<char>(0x20) : static_cast<char>(0);
+		}
+
+		template<bool IgnoreCase>
+		inline size_t FindStringScalar(const std::string_view haystack, const std::string_view needle)
+		{
+			if (needle.empty()) return 0;
+			if (needle.size() > haystack.size()) return std::string_view::npos;
+
+			const char first{ needle.front() };
+			const char* pCurrent{ haystack.data() };
+			const char* const pLast{ haystack.data() + haystack.size() - needle.size() };
+
+			if constexpr (IgnoreCase)
+			{
+				if (IsAlpha(first))
 				{
-					std::cout << "Could not open file: " << filename << "\n";
-					return;
+					for (; pCurrent <= pLast; ++pCurrent)
+					{
+						if (ToLowercase(*pCurrent) == first && AreBytesEqual<true>(pCurrent + 1, needle.data() + 1, needle.size() - 1))
+						{
+							return static_cast<size_t>(pCurrent - haystack.data());
+						}
+					}
+
+					return std::string_view::npos;
 				}
+			}
+
+			while (pCurrent <= pLast)
+			{
+				pCurrent = static_cast<const char*>(std::memchr(pCurrent, first, static_cast<size_t>(pLast - pCurrent) + 1));
+				if (!pCurrent) break;
 
-				if (ignoreCase)
+				if (AreBytesEqual<IgnoreCase>(pCurrent + 1, needle.data() + 1, needle.size() - 1))
 				{
-					TransformStringToLowercase(stringToSearch);
+					return static_cast<size_t>(pCurrent - haystack.data());
 				}
 
-				// Notepad++ starts counting at 1, so let's do the same
-				std::string line{};
-				for (uint32_t lineNumber{ 1 }; std::getline(stream, line); ++lineNumber)
+				++pCurrent;
+			}
+
+			return std::string_view::npos;
+		}
+
+		/// <summary>
+		/// Kernel for needles of a single byte. Without case folding (or for a byte that is not a letter) this is memchr,
+		/// a letter is folded into the haystack bytes 16 at a time
+		/// </summary>
+		template<bool IgnoreCase>
+		inline size_t FindByte(const std::string_view haystack, const std::string_view needle)
+		{
+			RDW_SS_ASSERT(needle.size() == 1);
+
+			const char byte{ needle.front() };
+
+#ifdef RDW_SS_HAS_SSE2
+			if (IgnoreCase && IsAlpha(byte))
+			{
+				constexpr size_t blockSize{ 16 };
+
+				const __m128i folded{ _mm_set1_epi8(byte) };
+				const __m128i caseMask{ _mm_set1_epi8(0x20) };
+				const char* const pHaystack{ haystack.data() };
+
+				size_t i{};
+				for (; i + blockSize <= haystack.size(); i += blockSize)
 				{
-					if (ignoreCase)
-					{
-						TransformStringToLowercase(line);
-					}
+					const __m128i block{ _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pHaystack + i)), caseMask) };
 
-					if (line.find(stringToSearch) != std::string::npos)
-					{
-						const std::scoped_lock<std::mutex> lock{ mutex };
-						foundStrings[filename].push_back(lineNumber);
-					}
+					const uint32_t mask{ static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, folded))) };
+					if (mask != 0) return i + static_cast<size_t>(CountTrailingZeros(mask));
 				}
 
-				stream.close();
+				const size_t tail{ FindStringScalar<true>(haystack.substr(i), needle) };
+				return tail == std::string_view::npos ? tail : i + tail;
 			}
+#else
+			if (IgnoreCase && IsAlpha(byte)) return FindStringScalar<true>(haystack, needle);
+#endif
+
+			const void* pHit{ std::memchr(haystack.data(), byte, haystack.size()) };
+			return pHit ? static_cast<size_t>(static_cast<const char*>(pHit) - haystack.data()) : std::string_view::npos;
 		}
 
-		inline bool IsFilenameValid(const std::string_view filename, const std::string_view filenameFilter)
+#ifdef RDW_SS_HAS_SSE2
+		/// <summary>
+		/// Compares the needle's first and last byte against 16 haystack positions at a time and only
+		/// verifies the full needle on positions where both match. Handles needles of 2 bytes or longer,
+		/// the scalar search takes care of the tail
+		/// A FixedSize other than 0 compiles the kernel for needles of exactly that size, so the verification is unrolled
+		/// </summary>
+		template<bool IgnoreCase, size_t FixedSize = 0>
+		inline size_t FindStringSSE2(const std::string_view haystack, const std::string_view needle)
 		{
-			if (filenameFilter == "*") return true;
+			constexpr size_t blockSize{ 16 };
+
+			RDW_SS_ASSERT(FixedSize == 0 || needle.size() == FixedSize);
+			const size_t needleSize{ FixedSize != 0 ? FixedSize : needle.size() };
+			if (needleSize < 2 || haystack.size() < needleSize + blockSize) return FindStringScalar<IgnoreCase>(haystack, needle);
+
+			const __m128i first{ _mm_set1_epi8(needle.front()) };
+			const __m128i last{ _mm_set1_epi8(needle.back()) };
+			const __m128i firstCaseMask{ _mm_set1_epi8(GetCaseMask<IgnoreCase>(needle.front())) };
+			const __m128i lastCaseMask{ _mm_set1_epi8(GetCaseMask<IgnoreCase>(needle.back())) };
+
+			const char* const pHaystack{ haystack.data() };
+			const size_t lastBlockStart{ haystack.size() - needleSize - blockSize + 1 };
+
+			size_t i{};
+			for (; i <= lastBlockStart; i += blockSize)
+			{
+				__m128i blockFirst{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(pHaystack + i)) };
+				__m128i blockLast{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(pHaystack + i + needleSize - 1)) };
+
+				if constexpr (IgnoreCase)
+				{
+					blockFirst = _mm_or_si128(blockFirst, firstCaseMask);
+					blockLast = _mm_or_si128(blockLast, lastCaseMask);
+				}
+
+				uint32_t mask{ static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, last)))) };
+				while (mask != 0)
+				{
+					const size_t candidate{ i + static_cast<size_t>(CountTrailingZeros(mask)) };
+					if (AreBytesEqual<IgnoreCase>(pHaystack + candidate, needle.data(), needleSize)) return candidate;
 
-			return filename.find(filenameFilter) != std::string_view::npos;
+					mask &= mask - 1;
+				}
+			}
+
+			const size_t tail{ FindStringScalar<IgnoreCase>(haystack.substr(i), needle) };
+			return tail == std::string_view::npos ? tail : i + tail;
 		}
 
-		inline bool IsExtensionValid(const std::string_view filename, const std::string_view extensionFilter)
+		template<bool IgnoreCase, size_t FixedSize = 0>
+		RDW_SS_TARGET_AVX2 inline size_t FindStringAVX2(const std::string_view haystack, const std::string_view needle)
 		{
-			if (extensionFilter == "*") return true;
+			constexpr size_t blockSize{ 32 };
+
+			RDW_SS_ASSERT(FixedSize == 0 || needle.size() == FixedSize);
+			const size_t needleSize{ FixedSize != 0 ? FixedSize : needle.size() };
+			if (needleSize < 2 || haystack.size() < needleSize + blockSize) return FindStringSSE2<IgnoreCase, FixedSize>(haystack, needle);
+
+			const __m256i first{ _mm256_set1_epi8(needle.front()) };
+			const __m256i last{ _mm256_set1_epi8(needle.back()) };
+			const __m256i firstCaseMask{ _mm256_set1_epi8(GetCaseMask<IgnoreCase>(needle.front())) };
+			const __m256i lastCaseMask{ _mm256_set1_epi8(GetCaseMask<IgnoreCase>(needle.back())) };
+
+			const char* const pHaystack{ haystack.data() };
+			const size_t lastBlockStart{ haystack.size() - needleSize - blockSize + 1 };
+
+			size_t i{};
+			for (; i <= lastBlockStart; i += blockSize)
+			{
+				__m256i blockFirst{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pHaystack + i)) };
+				__m256i blockLast{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pHaystack + i + needleSize - 1)) };
+
+				if constexpr (IgnoreCase)
+				{
+					blockFirst = _mm256_or_si256(blockFirst, firstCaseMask);
+					blockLast = _mm256_or_si256(blockLast, lastCaseMask);
+				}
+
+				uint32_t mask{ static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(blockFirst, first), _mm256_cmpeq_epi8(blockLast, last)))) };
+				while (mask != 0)
+				{
+					const size_t candidate{ i + static_cast<size_t>(CountTrailingZeros(mask)) };
+					if (AreBytesEqual<IgnoreCase>(pHaystack + candidate, needle.data(), needleSize)) return candidate;
+
+					mask &= mask - 1;
+				}
+			}
 
-			return filename.find(extensionFilter) != std::string_view::npos;
+			const size_t tail{ FindStringSSE2<IgnoreCase, FixedSize>(haystack.substr(i), needle) };
+			return tail == std::string_view::npos ? tail : i + tail;
 		}
 
-		inline bool ShouldDirectoryBeConsidered(const std::string& rootDir, const std::string& currentDir, const uint32_t recursiveDepth)
+		inline bool IsAVX2Supported()
 		{
-			if (recursiveDepth == 0) return true;
+#ifdef _MSC_VER
+			int cpuInfo[4]{};
+			__cpuid(cpuInfo, 0);
+			if (cpuInfo[0] < 7) return false;
 
-			const int64_t depth{ std::count(currentDir.cbegin(), currentDir.cend(), '\\') - std::count(rootDir.cbegin(), rootDir.cend(), '\\') };
+			// AVX2 also needs the OS to save the YMM registers
+			__cpuid(cpuInfo, 1);
+			const bool hasOSXSave{ (cpuInfo[2] & (1 << 27)) != 0 };
+			const bool hasAVX{ (cpuInfo[2] & (1 << 28)) != 0 };
+			if (!hasOSXSave || !hasAVX || (_xgetbv(0) & 0x6) != 0x6) return false;
 
-			return depth <= recursiveDepth;
+			__cpuidex(cpuInfo, 7, 0);
+			return (cpuInfo[1] & (1 << 5)) != 0;
+#else
+			return __builtin_cpu_supports("avx2");
+#endif
 		}
 
-		inline std::vector<std::string> GetAllFilesInDirectory(const std::string& rootDir, const std::string& mask, const uint32_t recursiveDepth)
+		inline bool IsSSSE3Supported()
 		{
-			std::vector<std::string> files{};
-			files.reserve(80);
+#ifdef _MSC_VER
+			int cpuInfo[4]{};
+			__cpuid(cpuInfo, 1);
+			return (cpuInfo[2] & (1 << 9)) != 0;
+#else
+			return __builtin_cpu_supports("ssse3");
+#endif
+		}
+#endif
 
-			WIN32_FIND_DATAA findFileData;
-			HANDLE fileHandle = INVALID_HANDLE_VALUE;
+		using FindStringFunction = size_t(*)(std::string_view, std::string_view);
+
+		/// <summary>
+		/// Picks the substring kernel for needles of needleSize bytes, matchers do this once per query instead of once per call
+		/// Single bytes get their own kernel, longer needles the widest kernel the CPU supports, which is only looked up once
+		/// needleSize 0 means the size is not known up front. When IgnoreCase is set, the kernel expects a lowercase needle and folds
+		/// the haystack bytes while comparing. A FixedSize other than 0 picks the kernels compiled for needles of exactly that size
+		/// </summary>
+		template<bool IgnoreCase, size_t FixedSize = 0>
+		inline FindStringFunction GetFindStringFunction(const size_t needleSize = FixedSize)
+		{
+			if (needleSize == 1) return &FindByte<IgnoreCase>;
 
-			std::stack<std::string> fileStack{};
-			fileStack.push(rootDir);
+#ifdef RDW_SS_HAS_SSE2
+			static const FindStringFunction findString{ IsAVX2Supported() ? &FindStringAVX2<IgnoreCase, FixedSize> : &FindStringSSE2<IgnoreCase, FixedSize> };
+#else
+			static const FindStringFunction findString{ &FindStringScalar<IgnoreCase> };
+#endif
 
-			const std::string filterFilename{ mask.empty() ? "*" : mask.substr(0, mask.find(".")) };
-			const std::string filterExtension{ mask.empty() ? "*" : mask.substr(mask.find(".")) };
+			return findString;
+		}
 
-			while (!fileStack.empty())
+		/// <summary>
+		/// Read-only view of a file's contents
+		/// Regular files are memory-mapped, anything that cannot be mapped (empty files, pipes, files too large for the address space)
+		/// is read through Read() in fixed size blocks instead
+		/// </summary>
+		class MappedFile final
+		{
+		public:
+			explicit MappedFile(const std::string& filename)
+#ifdef _WIN32
+				: m_FileHandle{ INVALID_HANDLE_VALUE }
+				, m_MappingHandle{}
+#else
+				: m_FileDescriptor{ -1 }
+#endif
+				, m_pData{}
+				, m_Size{}
 			{
-				const std::string child{ fileStack.top() };
-				fileStack.pop();
+#ifdef _WIN32
+				m_FileHandle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+				if (m_FileHandle == INVALID_HANDLE_VALUE) return;
+
+				LARGE_INTEGER fileSize{};
+				if (!GetFileSizeEx(m_FileHandle, &fileSize) || fileSize.QuadPart <= 0) return;
+				if (static_cast<uint64_t>(fileSize.QuadPart) > static_cast<uint64_t>(SIZE_MAX)) return;
+
+				m_MappingHandle = CreateFileMappingA(m_FileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+				if (!m_MappingHandle) return;
+
+				m_pData = static_cast<const char*>(MapViewOfFile(m_MappingHandle, FILE_MAP_READ, 0, 0, 0));
+				if (m_pData) m_Size = static_cast<size_t>(fileSize.QuadPart);
+#else
+				m_FileDescriptor = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+				if (m_FileDescriptor == -1) return;
+
+				struct stat fileStat {};
+				if (fstat(m_FileDescriptor, &fileStat) != 0 || !S_ISREG(fileStat.st_mode) || fileStat.st_size <= 0) return;
+				if (static_cast<uint64_t>(fileStat.st_size) > static_cast<uint64_t>(SIZE_MAX)) return;
+
+				void* pData{ mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, m_FileDescriptor, 0) };
+				if (pData == MAP_FAILED) return;
+
+				madvise(pData, static_cast<size_t>(fileStat.st_size), MADV_SEQUENTIAL);
+
+				m_pData = static_cast<const char*>(pData);
+				m_Size = static_cast<size_t>(fileStat.st_size);
+#endif
+			}
+
+			~MappedFile()
+			{
+#ifdef _WIN32
+				if (m_pData) UnmapViewOfFile(m_pData);
+				if (m_MappingHandle) CloseHandle(m_MappingHandle);
+				if (m_FileHandle != INVALID_HANDLE_VALUE) CloseHandle(m_FileHandle);
+#else
+				if (m_pData) munmap(const_cast<char*>(m_pData), m_Size);
+				if (m_FileDescriptor != -1) close(m_FileDescriptor);
+#endif
+			}
+
+			MappedFile(const MappedFile&) noexcept = delete;
+			MappedFile(MappedFile&&) noexcept = delete;
+			MappedFile& operator=(const MappedFile&) noexcept = delete;
+			MappedFile& operator=(MappedFile&&) noexcept = delete;
+
+			[[nodiscard]] bool IsOpen() const
+			{
+#ifdef _WIN32
+				return m_FileHandle != INVALID_HANDLE_VALUE;
+#else
+				return m_FileDescriptor != -1;
+#endif
+			}
+
+			[[nodiscard]] bool IsMapped() const { return m_pData != nullptr; }
+			[[nodiscard]] std::string_view GetView() const { return std::string_view{ m_pData, m_Size }; }
+
+			/// <summary>
+			/// Reads the next block of an unmapped file, returns 0 at the end of the file or on error
+			/// </summary>
+			[[nodiscard]] size_t Read(char* pBuffer, const size_t size)
+			{
+#ifdef _WIN32
+				DWORD bytesRead{};
+				const DWORD bytesToRead{ static_cast<DWORD>(std::min<size_t>(size, 1u << 30)) };
+				if (!ReadFile(m_FileHandle, pBuffer, bytesToRead, &bytesRead, nullptr)) return 0;
 
-				const std::string rootWildcard{ child + "\\*" };
-				fileHandle = FindFirstFileA(rootWildcard.c_str(), &findFileData);
-				if (fileHandle == INVALID_HANDLE_VALUE)
+				return bytesRead;
+#else
+				for (;;)
 				{
-					std::cout << "FindFirstFile failed on file" << child << "\n";
-					if (!fileStack.empty())
-					{
-						continue;
-					}
-					else
-					{
-						return files;
-					}
+					const ssize_t bytesRead{ read(m_FileDescriptor, pBuffer, size) };
+					if (bytesRead >= 0) return static_cast<size_t>(bytesRead);
+					if (errno != EINTR) return 0;
 				}
+#endif
+			}
+
+		private:
+#ifdef _WIN32
+			HANDLE m_FileHandle;
+			HANDLE m_MappingHandle;
+#else
+			int m_FileDescriptor;
+#endif
+			const char* m_pData;
+			size_t m_Size;
+		};
 
-				do
+		/// <summary>
+		/// Block size used for files that could not be memory-mapped
+		/// </summary>
+		inline static constexpr size_t ReadBlockSize{ 1u << 20 };
+
+		/// <summary>
+		/// Fixed set of equally sized buffers in one allocation, so they can be registered with the kernel once
+		/// </summary>
+		class ReadBufferPool final
+		{
+		public:
+			ReadBufferPool(const uint32_t nrOfBuffers, const size_t bufferSize)
+				: m_Mutex{}
+				, m_BufferReleased{}
+				, m_Memory(nrOfBuffers * bufferSize)
+				, m_FreeBuffers(nrOfBuffers)
+				, m_BufferSize{ bufferSize }
+				, m_NrOfBuffers{ nrOfBuffers }
+			{
+				for (uint32_t i{}; i < nrOfBuffers; ++i)
 				{
-					if (strcmp(findFileData.cFileName, ".") == 0 ||
-						strcmp(findFileData.cFileName, "..") == 0)
-					{
-						continue;
-					}
+					m_FreeBuffers[i] = nrOfBuffers - 1 - i;
+				}
+			}
 
-					if (findFileData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
-					{
-						const std::string directoryName{ child + "\\" + findFileData.cFileName };
+			ReadBufferPool(const ReadBufferPool&) noexcept = delete;
+			ReadBufferPool(ReadBufferPool&&) noexcept = delete;
+			ReadBufferPool& operator=(const ReadBufferPool&) noexcept = delete;
+			ReadBufferPool& operator=(ReadBufferPool&&) noexcept = delete;
 
-						if (ShouldDirectoryBeConsidered(rootDir, directoryName, recursiveDepth)) fileStack.push(directoryName);
-					}
-					else
-					{
-						if (IsFilenameValid(findFileData.cFileName, filterFilename) && IsExtensionValid(findFileData.cFileName, filterExtension))
-						{
-							files.push_back(child + "\\" + findFileData.cFileName);
-						}
-					}
-				} while (FindNextFileA(fileHandle, &findFileData) != 0);
+			[[nodiscard]] char* GetBuffer(const uint32_t index) { return m_Memory.data() + index * m_BufferSize; }
+			[[nodiscard]] size_t GetBufferSize() const { return m_BufferSize; }
+			[[nodiscard]] uint32_t GetNrOfBuffers() const { return m_NrOfBuffers; }
+
+			/// <summary>
+			/// Returns false instead of blocking when every buffer is in use
+			/// </summary>
+			bool TryAcquire(uint32_t& index)
+			{
+				const std::scoped_lock<std::mutex> lock{ m_Mutex };
+				if (m_FreeBuffers.empty()) return false;
+
+				index = m_FreeBuffers.back();
+				m_FreeBuffers.pop_back();
+				return true;
 			}
 
-			FindClose(fileHandle);
+			void Acquire(uint32_t& index)
+			{
+				std::unique_lock<std::mutex> lock{ m_Mutex };
+				m_BufferReleased.wait(lock, [this]() { return !m_FreeBuffers.empty(); });
 
-			return files;
-		}
-	}
+				index = m_FreeBuffers.back();
+				m_FreeBuffers.pop_back();
+			}
 
-	struct StringSearchStatistics final
-	{
-		int32_t NumberOfFilesSearched;
-	};
+			void Release(const uint32_t index)
+			{
+				{
+					const std::scoped_lock<std::mutex> lock{ m_Mutex };
+					m_FreeBuffers.push_back(index);
+				}
 
-	inline static void IsStringInFile(
-		const std::string& currentDir,
-		const std::string& fileToSearch,
-		const std::string& mask,
-		const std::string& stringToSearch,
-		const bool ignoreCase,
-		const bool recursivelySearch,
-		const uint32_t recursiveDepth,
-		std::unordered_map<std::string, std::vector<uint32_t>>& foundStrings,
-		StringSearchStatistics* pStatistics)
-	{
-		if (recursivelySearch)
+				m_BufferReleased.notify_one();
+			}
+
+		private:
+			std::mutex m_Mutex;
+			std::condition_variable m_BufferReleased;
+			std::vector<char> m_Memory;
+			std::vector<uint32_t> m_FreeBuffers;
+			const size_t m_BufferSize;
+			const uint32_t m_NrOfBuffers;
+		};
+
+		/// <summary>
+		/// The whole contents of a file that was read ahead into a buffer of a ReadBufferPool, the buffer goes back to the pool on destruction
+		/// Has the same interface as MappedFile, so the search treats it like a mapped file
+		/// </summary>
+		class ReadBuffer final
 		{
-			size_t nrOfThreads{ std::thread::hardware_concurrency() };
-			const std::vector<std::string> allFiles{ Detail::GetAllFilesInDirectory(currentDir, mask, recursiveDepth) };
+		public:
+			ReadBuffer()
+				: m_pPool{}
+				, m_Index{}
+				, m_Size{}
+			{}
 
-			if (nrOfThreads > allFiles.size()) nrOfThreads = allFiles.size();
+			ReadBuffer(ReadBufferPool& pool, const uint32_t index, const size_t size)
+				: m_pPool{ &pool }
+				, m_Index{ index }
+				, m_Size{ size }
+			{}
 
-			const size_t nrOfFilesPerThread{ allFiles.size() / nrOfThreads };
+			~ReadBuffer()
+			{
+				if (m_pPool) m_pPool->Release(m_Index);
+			}
 
-			if (nrOfFilesPerThread == 0) return;
+			ReadBuffer(const ReadBuffer&) noexcept = delete;
+			ReadBuffer& operator=(const ReadBuffer&) noexcept = delete;
 
-			std::vector<std::jthread> threads{};
-			threads.reserve(nrOfThreads);
-			std::mutex mutex{};
+			ReadBuffer(ReadBuffer&& other) noexcept
+				: m_pPool{ std::exchange(other.m_pPool, nullptr) }
+				, m_Index{ other.m_Index }
+				, m_Size{ other.m_Size }
+			{}
 
-			size_t nrOfFilesAdded{};
-			for (size_t i{}; i < nrOfThreads - 1; ++i)
+			ReadBuffer& operator=(ReadBuffer&& other) noexcept
 			{
-				const size_t startOffset{ nrOfFilesPerThread * i };
-				const size_t endOffset{ nrOfFilesPerThread * (i + 1) };
+				if (this != &other)
+				{
+					if (m_pPool) m_pPool->Release(m_Index);
+
+					m_pPool = std::exchange(other.m_pPool, nullptr);
+					m_Index = other.m_Index;
+					m_Size = other.m_Size;
+				}
+
+				return *this;
+			}
 
-				nrOfFilesAdded += endOffset - startOffset;
+			[[nodiscard]] bool IsOpen() const { return m_pPool != nullptr; }
+			[[nodiscard]] bool IsMapped() const { return m_pPool != nullptr; }
+			[[nodiscard]] std::string_view GetView() const { return std::string_view{ m_pPool->GetBuffer(m_Index), m_Size }; }
+			[[nodiscard]] size_t Read(char*, const size_t) { return 0; }
 
-				RDW_SS_ASSERT((endOffset - startOffset) == nrOfFilesPerThread);
+		private:
+			ReadBufferPool* m_pPool;
+			uint32_t m_Index;
+			size_t m_Size;
+		};
 
-				threads.emplace_back(&Detail::SearchFilesForString, std::vector<std::string>{ allFiles.begin() + startOffset, allFiles.begin() + endOffset },
-					stringToSearch, ignoreCase, std::ref(foundStrings), std::ref(mutex));
+#ifdef RDW_SS_HAS_ZLIB
+		/// <summary>
+		/// Streaming gzip decoder, a file of several gzip members in a row is decoded as one
+		/// </summary>
+		class GzipDecoder final
+		{
+		public:
+			explicit GzipDecoder(const std::string_view compressed)
+				: m_Stream{}
+				, m_Input{ compressed }
+				, m_IsValid{}
+				, m_IsAtStreamEnd{}
+				, m_HasFailed{}
+			{
+				// 16 makes zlib expect a gzip header instead of a zlib one
+				m_IsValid = inflateInit2(&m_Stream, 16 + MAX_WBITS) == Z_OK;
+				m_HasFailed = !m_IsValid;
 			}
 
-			threads.emplace_back(&Detail::SearchFilesForString, std::vector<std::string>{ allFiles.begin() + nrOfFilesAdded, allFiles.end() },
-				stringToSearch, ignoreCase, std::ref(foundStrings), std::ref(mutex));
+			~GzipDecoder()
+			{
+				if (m_IsValid) inflateEnd(&m_Stream);
+			}
 
-			nrOfFilesAdded += allFiles.size() - nrOfFilesAdded;
+			GzipDecoder(const GzipDecoder&) noexcept = delete;
+			GzipDecoder(GzipDecoder&&) noexcept = delete;
+			GzipDecoder& operator=(const GzipDecoder&) noexcept = delete;
+			GzipDecoder& operator=(GzipDecoder&&) noexcept = delete;
 
-			RDW_SS_ASSERT(nrOfFilesAdded == allFiles.size());
+			[[nodiscard]] bool HasFailed() const { return m_HasFailed; }
 
-			if (pStatistics)
+			/// <summary>
+			/// Returns the number of bytes written, 0 once all data has been decoded or the data turned out to be corrupt or cut off
+			/// </summary>
+			size_t Decode(char* pOutput, const size_t size)
 			{
-				pStatistics->NumberOfFilesSearched = static_cast<int32_t>(nrOfFilesAdded);
+				m_Stream.next_out = reinterpret_cast<Bytef*>(pOutput);
+				m_Stream.avail_out = static_cast<uInt>(size);
+
+				while (m_Stream.avail_out > 0 && !m_HasFailed)
+				{
+					if (m_Stream.avail_in == 0)
+					{
+						if (m_Input.empty())
+						{
+							m_HasFailed = !m_IsAtStreamEnd;
+							break;
+						}
+
+						// avail_in is 32 bits, so bigger files are fed in pieces
+						const size_t inputSize{ std::min<size_t>(m_Input.size(), 1u << 30) };
+						m_Stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(m_Input.data()));
+						m_Stream.avail_in = static_cast<uInt>(inputSize);
+						m_Input.remove_prefix(inputSize);
+					}
+
+					const int result{ inflate(&m_Stream, Z_NO_FLUSH) };
+					m_IsAtStreamEnd = result == Z_STREAM_END;
+
+					if (result == Z_STREAM_END)
+					{
+						// another member can follow, for example when a log was compressed a piece at a time
+						if (m_Stream.avail_in == 0 && m_Input.empty()) break;
+
+						inflateReset(&m_Stream);
+					}
+					else if (result != Z_OK)
+					{
+						m_HasFailed = true;
+					}
+				}
+
+				return size - m_Stream.avail_out;
 			}
-		}
-		else
+
+		private:
+			z_stream m_Stream;
+			std::string_view m_Input; // the part not handed to zlib yet
+			bool m_IsValid;
+			bool m_IsAtStreamEnd;
+			bool m_HasFailed;
+		};
+#endif
+
+#ifdef RDW_SS_HAS_ZSTD
+		/// <summary>
+		/// Streaming zstd decoder, a file of several frames in a row is decoded as one
+		/// </summary>
+		class ZstdDecoder final
 		{
-			std::mutex mutex{};
-			Detail::SearchFilesForString(std::vector<std::string>{ fileToSearch }, stringToSearch, ignoreCase, foundStrings, mutex);
-		}
-	}
+		public:
+			explicit ZstdDecoder(const std::string_view compressed)
+				: m_pStream{ ZSTD_createDStream() }
+				, m_Input{ compressed.data(), compressed.size(), 0 }
+				, m_IsAtFrameEnd{ true }
+				, m_HasFailed{ m_pStream == nullptr }
+			{}
+
+			~ZstdDecoder()
+			{
+				ZSTD_freeDStream(m_pStream);
+			}
+
+			ZstdDecoder(const ZstdDecoder&) noexcept = delete;
+			ZstdDecoder(ZstdDecoder&&) noexcept = delete;
+			ZstdDecoder& operator=(const ZstdDecoder&) noexcept = delete;
+			ZstdDecoder& operator=(ZstdDecoder&&) noexcept = delete;
+
+			[[nodiscard]] bool HasFailed() const { return m_HasFailed; }
+
+			/// <summary>
+			/// Returns the number of bytes written, 0 once all data has been decoded or the data turned out to be corrupt or cut off
+			/// </summary>
+			size_t Decode(char* pOutput, const size_t size)
+			{
+				ZSTD_outBuffer output{ pOutput, size, 0 };
+
+				while (output.pos < output.size && !m_HasFailed)
+				{
+					if (m_Input.pos == m_Input.size && m_IsAtFrameEnd) break;
+
+					const size_t result{ ZSTD_decompressStream(m_pStream, &output, &m_Input) };
+					if (ZSTD_isError(result))
+					{
+						m_HasFailed = true;
+						break;
+					}
+
+					m_IsAtFrameEnd = result == 0;
+
+					// with room left in the output, zstd has flushed everything it can decode from the input
+					if (m_Input.pos == m_Input.size && output.pos < output.size)
+					{
+						m_HasFailed = !m_IsAtFrameEnd;
+						break;
+					}
+				}
+
+				return output.pos;
+			}
+
+		private:
+			ZSTD_DStream* m_pStream;
+			ZSTD_inBuffer m_Input;
+			bool m_IsAtFrameEnd;
+			bool m_HasFailed;
+		};
+#endif
+
+#if defined(RDW_SS_HAS_ZLIB) || defined(RDW_SS_HAS_ZSTD)
+		/// <summary>
+		/// Decompresses a mapped file on a thread of its own into two blocks that take turns, so the next block is decompressed while
+		/// the search matches the previous one and the decompressed file is never held in memory as a whole
+		/// Has the same interface as an unmapped MappedFile, so the search reads it in blocks like any file it could not map
+		/// </summary>
+		template<typename Decoder>
+		class DecompressedFile final
+		{
+		public:
+			explicit DecompressedFile(const std::string_view compressed)
+				: m_Decoder{ compressed }
+				, m_Mutex{}
+				, m_BlockChanged{}
+				, m_Blocks{}
+				, m_ReadIndex{}
+				, m_IsDone{}
+				, m_IsStopped{}
+				, m_HasFailed{}
+				, m_Thread{}
+			{
+				for (Block& block : m_Blocks)
+				{
+					block.Data.resize(ReadBlockSize);
+				}
+
+				m_Thread = std::jthread{ &DecompressedFile::Decompress, this };
+			}
+
+			~DecompressedFile()
+			{
+				{
+					const std::scoped_lock<std::mutex> lock{ m_Mutex };
+					m_IsStopped = true;
+				}
+
+				m_BlockChanged.notify_all();
+				m_Thread.join();
+			}
+
+			DecompressedFile(const DecompressedFile&) noexcept = delete;
+			DecompressedFile(DecompressedFile&&) noexcept = delete;
+			DecompressedFile& operator=(const DecompressedFile&) noexcept = delete;
+			DecompressedFile& operator=(DecompressedFile&&) noexcept = delete;
+
+			[[nodiscard]] bool IsOpen() const { return true; }
+			[[nodiscard]] bool IsMapped() const { return false; }
+			[[nodiscard]] std::string_view GetView() const { return {}; }
+
+			/// <summary>
+			/// Only known once everything has been read
+			/// </summary>
+			[[nodiscard]] bool HasFailed()
+			{
+				const std::scoped_lock<std::mutex> lock{ m_Mutex };
+				return m_HasFailed;
+			}
+
+			/// <summary>
+			/// Waits for the next decompressed block, returns 0 once everything has been read
+			/// </summary>
+			[[nodiscard]] size_t Read(char* pBuffer, const size_t size)
+			{
+				Block& block{ m_Blocks[m_ReadIndex] };
+
+				{
+					std::unique_lock<std::mutex> lock{ m_Mutex };
+					m_BlockChanged.wait(lock, [this, &block]() { return block.IsFull || m_IsDone; });
+
+					// blocks are filled in turn, so once the decompressor is done an empty block means there is nothing left
+					if (!block.IsFull) return 0;
+				}
+
+				const size_t bytesRead{ std::min(size, block.Size - block.Offset) };
+				std::memcpy(pBuffer, block.Data.data() + block.Offset, bytesRead);
+				block.Offset += bytesRead;
+
+				if (block.Offset == block.Size)
+				{
+					{
+						const std::scoped_lock<std::mutex> lock{ m_Mutex };
+						block.IsFull = false;
+					}
+
+					m_BlockChanged.notify_all();
+					m_ReadIndex ^= 1;
+				}
+
+				return bytesRead;
+			}
+
+		private:
+			struct Block final
+			{
+				std::vector<char> Data;
+				size_t Size;
+				size_t Offset;
+				bool IsFull; // owned by the reader while set, by the decompressor otherwise
+			};
+
+			void Decompress()
+			{
+				for (size_t index{};; index ^= 1)
+				{
+					Block& block{ m_Blocks[index] };
+
+					{
+						std::unique_lock<std::mutex> lock{ m_Mutex };
+						m_BlockChanged.wait(lock, [this, &block]() { return !block.IsFull || m_IsStopped; });
+
+						if (m_IsStopped) return;
+					}
+
+					block.Size = m_Decoder.Decode(block.Data.data(), block.Data.size());
+					block.Offset = 0;
+
+					{
+						const std::scoped_lock<std::mutex> lock{ m_Mutex };
+						block.IsFull = block.Size > 0;
+						m_IsDone = block.Size == 0;
+						m_HasFailed = m_Decoder.HasFailed();
+					}
+
+					m_BlockChanged.notify_all();
+
+					if (block.Size == 0) return;
+				}
+			}
+
+			Decoder m_Decoder;
+			std::mutex m_Mutex;
+			std::condition_variable m_BlockChanged;
+			std::array<Block, 2> m_Blocks;
+			size_t m_ReadIndex;
+			bool m_IsDone;
+			bool m_IsStopped;
+			bool m_HasFailed;
+			std::jthread m_Thread;
+		};
+#endif
+
+		/// <summary>
+		/// Every matcher counts the newlines up to its hits and after its last hit, so this runs over most of every file
+		/// </summary>
+		inline uint32_t CountNewlines(const char* pBegin, const char* pEnd)
+		{
+			uint64_t nrOfNewlines{};
+
+#ifdef RDW_SS_HAS_SSE2
+			constexpr size_t blockSize{ 16 };
+			constexpr size_t maxBlocksPerRound{ 255 }; // a byte counter overflows after 255 blocks
+
+			const __m128i newline{ _mm_set1_epi8('\n') };
+
+			while (static_cast<size_t>(pEnd - pBegin) >= blockSize)
+			{
+				const size_t nrOfBlocks{ std::min(static_cast<size_t>(pEnd - pBegin) / blockSize, maxBlocksPerRound) };
+
+				// a matching byte compares to -1, so subtracting the comparison counts it
+				__m128i counts{ _mm_setzero_si128() };
+				for (size_t i{}; i < nrOfBlocks; ++i, pBegin += blockSize)
+				{
+					counts = _mm_sub_epi8(counts, _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pBegin)), newline));
+				}
+
+				const __m128i sums{ _mm_sad_epu8(counts, _mm_setzero_si128()) };
+				nrOfNewlines += static_cast<uint64_t>(_mm_cvtsi128_si32(sums)) + static_cast<uint64_t>(_mm_cvtsi128_si32(_mm_srli_si128(sums, 8)));
+			}
+#endif
+
+			nrOfNewlines += static_cast<uint64_t>(std::count(pBegin, pEnd, '\n'));
+
+			return static_cast<uint32_t>(nrOfNewlines);
+		}
+
+		/// <summary>
+		/// Finds the lines the matchers report by their number, moving on from the last line it found
+		/// Matches are sparse, so this only looks at the lines between them instead of keeping track of every line during the scan
+		/// </summary>
+		class LineCursor final
+		{
+		public:
+			explicit LineCursor(const std::string_view buffer)
+				: m_Buffer{ buffer }
+				, m_pLine{ buffer.data() }
+				, m_LineNumber{ 1 }
+			{}
+
+			[[nodiscard]] std::string_view GetLine(const uint32_t lineNumber)
+			{
+				const char* const pEnd{ m_Buffer.data() + m_Buffer.size() };
+
+				// every regex of a RegexMatcher gets its own pass, which starts at the first line again
+				if (lineNumber < m_LineNumber)
+				{
+					m_pLine = m_Buffer.data();
+					m_LineNumber = 1;
+				}
+
+				for (; m_LineNumber < lineNumber; ++m_LineNumber)
+				{
+					const void* pNewline{ std::memchr(m_pLine, '\n', static_cast<size_t>(pEnd - m_pLine)) };
+					RDW_SS_ASSERT(pNewline);
+
+					m_pLine = static_cast<const char*>(pNewline) + 1;
+				}
+
+				const void* pNewline{ std::memchr(m_pLine, '\n', static_cast<size_t>(pEnd - m_pLine)) };
+				const char* const pLineEnd{ pNewline ? static_cast<const char*>(pNewline) : pEnd };
+
+				return std::string_view{ m_pLine, static_cast<size_t>(pLineEnd - m_pLine) };
+			}
+
+		private:
+			std::string_view m_Buffer;
+			const char* m_pLine; // start of line m_LineNumber
+			uint32_t m_LineNumber;
+		};
+
+		/// <summary>
+		/// SearchBuffer() of the matchers for a single string, findString(haystack) returns the position of the string in haystack
+		/// </summary>
+		template<typename FindFunction, typename Callback>
+		const char* SearchBufferForString(const std::string_view buffer, uint32_t& lineNumber, FindFunction&& findString, Callback& onMatch)
+		{
+			const char* pCounted{ buffer.data() };
+
+			size_t position{};
+			while (position < buffer.size())
+			{
+				const size_t hit{ findString(buffer.substr(position)) };
+				if (hit == std::string_view::npos) break;
+
+				const char* pHit{ buffer.data() + position + hit };
+				lineNumber += CountNewlines(pCounted, pHit);
+				pCounted = pHit;
+
+				onMatch(size_t{}, lineNumber);
+
+				// only report every line once, so continue at the start of the next line
+				const void* pNewline{ std::memchr(pHit, '\n', static_cast<size_t>(buffer.data() + buffer.size() - pHit)) };
+				if (!pNewline) break;
+
+				pCounted = static_cast<const char*>(pNewline) + 1;
+				++lineNumber;
+				position = static_cast<size_t>(pCounted - buffer.data());
+			}
+
+			return pCounted;
+		}
+
+		/// <summary>
+		/// SearchBuffer() of the matchers that search for their patterns one at a time, searchPattern(patternIndex, buffer, lineNumber)
+		/// searches for one of them. With several patterns every pass counts its own lines, so nothing is reported as counted
+		/// </summary>
+		template<typename PatternSearch>
+		const char* SearchBufferPerPattern(const size_t nrOfPatterns, const std::string_view buffer, uint32_t& lineNumber, PatternSearch&& searchPattern)
+		{
+			if (nrOfPatterns == 1) return searchPattern(size_t{}, buffer, lineNumber);
+
+			for (size_t i{}; i < nrOfPatterns; ++i)
+			{
+				uint32_t passLineNumber{ lineNumber };
+				searchPattern(i, buffer, passLineNumber);
+			}
+
+			return buffer.data();
+		}
+
+		/// <summary>
+		/// Matcher for a single string
+		/// All matchers share the same interface: SearchBuffer() searches a buffer of whole lines and calls onMatch(patternIndex, lineNumber)
+		/// once for every line containing a pattern. lineNumber is the number of the first line in the buffer. Newlines are only counted
+		/// up to each hit, so on return lineNumber is the number of the line starting at the returned pointer
+		/// Case folding is a template parameter and the kernel for the string's size is picked on construction, so the scan
+		/// checks no options. See DispatchStringMatcher for picking the matcher at runtime
+		/// </summary>
+		template<bool IgnoreCase>
+		class StringMatcher final
+		{
+		public:
+			explicit StringMatcher(const std::string_view stringToSearch)
+				: m_String{ stringToSearch }
+				, m_FindString{ GetFindStringFunction<IgnoreCase>(stringToSearch.size()) }
+			{
+				// fold the needle once, the search kernels compare the file data case-insensitively without modifying it
+				if constexpr (IgnoreCase)
+				{
+					TransformStringToLowercase(m_String);
+				}
+			}
+
+			[[nodiscard]] size_t GetNrOfPatterns() const { return 1; }
+
+			/// <summary>
+			/// Adds strings of which every matching line contains at least one, returns false if no such strings are known
+			/// </summary>
+			[[nodiscard]] bool GetRequiredLiterals(std::vector<std::string>& literals) const
+			{
+				literals.push_back(m_String);
+				return true;
+			}
+
+			template<typename Callback>
+			const char* SearchBuffer(const std::string_view buffer, uint32_t& lineNumber, Callback&& onMatch) const
+			{
+				// lines are split on '\n', same as std::getline, so a needle spanning multiple lines can never match
+				if (m_String.find('\n') != std::string::npos) return buffer.data();
+
+				return SearchBufferForString(buffer, lineNumber, [this](const std::string_view haystack)->size_t { return m_FindString(haystack, m_String); }, onMatch);
+			}
+
+		private:
+			std::string m_String;
+			FindStringFunction m_FindString;
+		};
+
+		/// <summary>
+		/// Aho-Corasick automaton compiled to a dense DFA over byte classes
+		/// Bytes that do not occur in any pattern share one class, and with ignoreCase both cases of a letter share a class,
+		/// so the transition table stays small and case folding costs nothing during the scan
+		/// With that shared class there can be 257 classes, when the patterns hold every byte value, so they do not fit a byte
+		/// </summary>
+		class AhoCorasick final
+		{
+		public:
+			AhoCorasick(const std::vector<std::string>& patterns, const std::vector<uint32_t>& patternIndices, const bool ignoreCase)
+				: m_ByteClasses{}
+				, m_NrOfClasses{ 1 }
+				, m_Transitions{}
+				, m_OutputOffsets{}
+				, m_Outputs{}
+			{
+				for (const uint32_t patternIndex : patternIndices)
+				{
+					for (const char c : patterns[patternIndex])
+					{
+						const unsigned char byte{ static_cast<unsigned char>(c) };
+						if (m_ByteClasses[byte] != 0) continue;
+
+						m_ByteClasses[byte] = static_cast<uint16_t>(m_NrOfClasses);
+						if (ignoreCase && IsAlpha(c))
+						{
+							m_ByteClasses[static_cast<unsigned char>(c ^ 0x20)] = static_cast<uint16_t>(m_NrOfClasses);
+						}
+
+						++m_NrOfClasses;
+					}
+				}
+
+				constexpr uint32_t noState{ std::numeric_limits<uint32_t>::max() };
+
+				// build the trie, state 0 is the root
+				std::vector<std::vector<uint32_t>> stateOutputs(1);
+				m_Transitions.assign(m_NrOfClasses, noState);
+
+				for (const uint32_t patternIndex : patternIndices)
+				{
+					uint32_t state{};
+					for (const char c : patterns[patternIndex])
+					{
+						uint32_t& next{ m_Transitions[state * m_NrOfClasses + m_ByteClasses[static_cast<unsigned char>(c)]] };
+						if (next == noState)
+						{
+							next = static_cast<uint32_t>(stateOutputs.size());
+							stateOutputs.emplace_back();
+							m_Transitions.resize(m_Transitions.size() + m_NrOfClasses, noState);
+						}
+
+						// the resize may have moved the table
+						state = m_Transitions[state * m_NrOfClasses + m_ByteClasses[static_cast<unsigned char>(c)]];
+					}
+
+					stateOutputs[state].push_back(patternIndex);
+				}
+
+				// turn the trie into a DFA breadth first, filling in the failure transitions
+				const size_t nrOfStates{ stateOutputs.size() };
+				std::vector<uint32_t> failure(nrOfStates);
+				std::deque<uint32_t> states{};
+
+				for (uint32_t byteClass{}; byteClass < m_NrOfClasses; ++byteClass)
+				{
+					uint32_t& next{ m_Transitions[byteClass] };
+					if (next == noState)
+					{
+						next = 0;
+					}
+					else
+					{
+						failure[next] = 0;
+						states.push_back(next);
+					}
+				}
+
+				while (!states.empty())
+				{
+					const uint32_t state{ states.front() };
+					states.pop_front();
+
+					const std::vector<uint32_t>& failureOutputs{ stateOutputs[failure[state]] };
+					stateOutputs[state].insert(stateOutputs[state].end(), failureOutputs.begin(), failureOutputs.end());
+
+					for (uint32_t byteClass{}; byteClass < m_NrOfClasses; ++byteClass)
+					{
+						const uint32_t failureNext{ m_Transitions[failure[state] * m_NrOfClasses + byteClass] };
+						uint32_t& next{ m_Transitions[state * m_NrOfClasses + byteClass] };
+
+						if (next == noState)
+						{
+							next = failureNext;
+						}
+						else
+						{
+							failure[next] = failureNext;
+							states.push_back(next);
+						}
+					}
+				}
+
+				m_OutputOffsets.reserve(nrOfStates + 1);
+				for (const std::vector<uint32_t>& outputs : stateOutputs)
+				{
+					m_OutputOffsets.push_back(static_cast<uint32_t>(m_Outputs.size()));
+					m_Outputs.insert(m_Outputs.end(), outputs.begin(), outputs.end());
+				}
+				m_OutputOffsets.push_back(static_cast<uint32_t>(m_Outputs.size()));
+			}
+
+			/// <summary>
+			/// Calls onMatch(position, patternIndex) for every occurrence of every pattern, position is the match's last byte
+			/// </summary>
+			template<typename Callback>
+			void Scan(const std::string_view buffer, Callback&& onMatch) const
+			{
+				const unsigned char* const pData{ reinterpret_cast<const unsigned char*>(buffer.data()) };
+
+				uint32_t state{};
+				for (size_t i{}; i < buffer.size(); ++i)
+				{
+					state = m_Transitions[state * m_NrOfClasses + m_ByteClasses[pData[i]]];
+
+					for (uint32_t output{ m_OutputOffsets[state] }; output < m_OutputOffsets[state + 1]; ++output)
+					{
+						onMatch(i, m_Outputs[output]);
+					}
+				}
+			}
+
+		private:
+			std::array<uint16_t, 256> m_ByteClasses;
+			uint32_t m_NrOfClasses;
+			std::vector<uint32_t> m_Transitions;
+			std::vector<uint32_t> m_OutputOffsets;
+			std::vector<uint32_t> m_Outputs;
+		};
+
+#ifdef RDW_SS_HAS_SSE2
+		/// <summary>
+		/// SIMD prefilter for small pattern sets, after the Teddy algorithm from Hyperscan
+		/// Patterns are spread over 8 buckets. For the first (up to 3) bytes of the patterns, a nibble lookup table per byte position
+		/// says which buckets have a pattern with that low/high nibble there. pshufb does 16 (or 32) of those lookups at once,
+		/// and only positions where a bucket survives all byte positions get verified against that bucket's patterns
+		/// </summary>
+		class Teddy final
+		{
+		public:
+			inline static constexpr size_t MaxNrOfPatterns{ 32 };
+			inline static constexpr size_t NrOfBuckets{ 8 };
+			inline static constexpr size_t MaxFingerprintSize{ 3 };
+
+			Teddy(const std::vector<std::string>& patterns, const std::vector<uint32_t>& patternIndices, const bool ignoreCase)
+				: m_Patterns{ patterns }
+				, m_Buckets{}
+				, m_LowNibbleMasks{}
+				, m_HighNibbleMasks{}
+				, m_FingerprintSize{ MaxFingerprintSize }
+				, m_IgnoreCase{ ignoreCase }
+				, m_UseAVX2{ IsAVX2Supported() }
+			{
+				RDW_SS_ASSERT(!patternIndices.empty() && patternIndices.size() <= MaxNrOfPatterns);
+
+				for (const uint32_t patternIndex : patternIndices)
+				{
+					m_FingerprintSize = std::min(m_FingerprintSize, patterns[patternIndex].size());
+				}
+
+				for (size_t i{}; i < patternIndices.size(); ++i)
+				{
+					const size_t bucket{ i % NrOfBuckets };
+					const std::string& pattern{ patterns[patternIndices[i]] };
+
+					m_Buckets[bucket].push_back(patternIndices[i]);
+
+					for (size_t j{}; j < m_FingerprintSize; ++j)
+					{
+						AddToMasks(j, pattern[j], bucket);
+						if (ignoreCase && IsAlpha(pattern[j])) AddToMasks(j, static_cast<char>(pattern[j] ^ 0x20), bucket);
+					}
+				}
+			}
+
+			[[nodiscard]] static bool IsSupported() { return IsSSSE3Supported(); }
+
+			/// <summary>
+			/// Calls onMatch(position, patternIndex) for every occurrence of every pattern, position is the match's first byte
+			/// </summary>
+			template<typename Callback>
+			void Scan(const std::string_view buffer, Callback&& onMatch) const
+			{
+				if (m_IgnoreCase)
+				{
+					m_UseAVX2 ? ScanAVX2<true>(buffer, onMatch) : ScanSSSE3<true>(buffer, onMatch);
+				}
+				else
+				{
+					m_UseAVX2 ? ScanAVX2<false>(buffer, onMatch) : ScanSSSE3<false>(buffer, onMatch);
+				}
+			}
+
+		private:
+			void AddToMasks(const size_t bytePosition, const char c, const size_t bucket)
+			{
+				const unsigned char byte{ static_cast<unsigned char>(c) };
+
+				m_LowNibbleMasks[bytePosition][byte & 0x0F] |= static_cast<uint8_t>(1u << bucket);
+				m_HighNibbleMasks[bytePosition][byte >> 4] |= static_cast<uint8_t>(1u << bucket);
+			}
+
+			template<bool IgnoreCase, typename Callback>
+			void VerifyBuckets(const std::string_view buffer, const size_t position, uint32_t buckets, Callback& onMatch) const
+			{
+				while (buckets != 0)
+				{
+					for (const uint32_t patternIndex : m_Buckets[CountTrailingZeros(buckets)])
+					{
+						const std::string& pattern{ m_Patterns[patternIndex] };
+
+						if (pattern.size() <= buffer.size() - position && AreBytesEqual<IgnoreCase>(buffer.data() + position, pattern.data(), pattern.size()))
+						{
+							onMatch(position, patternIndex);
+						}
+					}
+
+					buckets &= buckets - 1;
+				}
+			}
+
+			template<bool IgnoreCase, typename Callback>
+			void ScanTail(const std::string_view buffer, const size_t start, Callback& onMatch) const
+			{
+				for (size_t position{ start }; position < buffer.size(); ++position)
+				{
+					VerifyBuckets<IgnoreCase>(buffer, position, (1u << NrOfBuckets) - 1, onMatch);
+				}
+			}
+
+			template<bool IgnoreCase, typename Callback>
+			RDW_SS_TARGET_SSSE3 void ScanSSSE3(const std::string_view buffer, Callback& onMatch) const
+			{
+				constexpr size_t blockSize{ 16 };
+
+				__m128i lowMasks[MaxFingerprintSize]{};
+				__m128i highMasks[MaxFingerprintSize]{};
+				for (size_t j{}; j < m_FingerprintSize; ++j)
+				{
+					lowMasks[j] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_LowNibbleMasks[j].data()));
+					highMasks[j] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_HighNibbleMasks[j].data()));
+				}
+
+				const __m128i lowNibble{ _mm_set1_epi8(0x0F) };
+				const char* const pData{ buffer.data() };
+
+				size_t i{};
+				for (; i + blockSize + m_FingerprintSize - 1 <= buffer.size(); i += blockSize)
+				{
+					__m128i candidates{ _mm_set1_epi8(static_cast<char>(0xFF)) };
+					for (size_t j{}; j < m_FingerprintSize; ++j)
+					{
+						const __m128i block{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + i + j)) };
+						const __m128i low{ _mm_shuffle_epi8(lowMasks[j], _mm_and_si128(block, lowNibble)) };
+						const __m128i high{ _mm_shuffle_epi8(highMasks[j], _mm_and_si128(_mm_srli_epi16(block, 4), lowNibble)) };
+						candidates = _mm_and_si128(candidates, _mm_and_si128(low, high));
+					}
+
+					uint32_t mask{ static_cast<uint32_t>(~_mm_movemask_epi8(_mm_cmpeq_epi8(candidates, _mm_setzero_si128()))) & 0xFFFFu };
+					if (mask == 0) continue;
+
+					alignas(16) uint8_t buckets[blockSize];
+					_mm_store_si128(reinterpret_cast<__m128i*>(buckets), candidates);
+
+					while (mask != 0)
+					{
+						const size_t offset{ static_cast<size_t>(CountTrailingZeros(mask)) };
+						VerifyBuckets<IgnoreCase>(buffer, i + offset, buckets[offset], onMatch);
+
+						mask &= mask - 1;
+					}
+				}
+
+				ScanTail<IgnoreCase>(buffer, i, onMatch);
+			}
+
+			template<bool IgnoreCase, typename Callback>
+			RDW_SS_TARGET_AVX2 void ScanAVX2(const std::string_view buffer, Callback& onMatch) const
+			{
+				constexpr size_t blockSize{ 32 };
+
+				__m256i lowMasks[MaxFingerprintSize]{};
+				__m256i highMasks[MaxFingerprintSize]{};
+				for (size_t j{}; j < m_FingerprintSize; ++j)
+				{
+					// vpshufb looks up within each 128 bit lane, so both lanes get the same table
+					lowMasks[j] = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(m_LowNibbleMasks[j].data())));
+					highMasks[j] = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(m_HighNibbleMasks[j].data())));
+				}
+
+				const __m256i lowNibble{ _mm256_set1_epi8(0x0F) };
+				const char* const pData{ buffer.data() };
+
+				size_t i{};
+				for (; i + blockSize + m_FingerprintSize - 1 <= buffer.size(); i += blockSize)
+				{
+					__m256i candidates{ _mm256_set1_epi8(static_cast<char>(0xFF)) };
+					for (size_t j{}; j < m_FingerprintSize; ++j)
+					{
+						const __m256i block{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pData + i + j)) };
+						const __m256i low{ _mm256_shuffle_epi8(lowMasks[j], _mm256_and_si256(block, lowNibble)) };
+						const __m256i high{ _mm256_shuffle_epi8(highMasks[j], _mm256_and_si256(_mm256_srli_epi16(block, 4), lowNibble)) };
+						candidates = _mm256_and_si256(candidates, _mm256_and_si256(low, high));
+					}
+
+					uint32_t mask{ ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(candidates, _mm256_setzero_si256()))) };
+					if (mask == 0) continue;
+
+					alignas(32) uint8_t buckets[blockSize];
+					_mm256_store_si256(reinterpret_cast<__m256i*>(buckets), candidates);
+
+					while (mask != 0)
+					{
+						const size_t offset{ static_cast<size_t>(CountTrailingZeros(mask)) };
+						VerifyBuckets<IgnoreCase>(buffer, i + offset, buckets[offset], onMatch);
+
+						mask &= mask - 1;
+					}
+				}
+
+				const auto onTailMatch{ [&onMatch, i](const size_t position, const uint32_t patternIndex)->void { onMatch(i + position, patternIndex); } };
+				ScanSSSE3<IgnoreCase>(buffer.substr(i), onTailMatch);
+			}
+
+			const std::vector<std::string>& m_Patterns;
+			std::array<std::vector<uint32_t>, NrOfBuckets> m_Buckets;
+			std::array<std::array<uint8_t, 16>, MaxFingerprintSize> m_LowNibbleMasks;
+			std::array<std::array<uint8_t, 16>, MaxFingerprintSize> m_HighNibbleMasks;
+			size_t m_FingerprintSize;
+			bool m_IgnoreCase;
+			bool m_UseAVX2;
+		};
+#endif
+
+		/// <summary>
+		/// Matcher for many strings at once, in a single pass over the buffer
+		/// Small sets go through the Teddy SIMD prefilter, larger sets (or CPUs without SSSE3) through Aho-Corasick
+		/// Patterns that are empty or contain a newline can never match a line and are ignored
+		/// </summary>
+		class MultiStringMatcher final
+		{
+		public:
+			MultiStringMatcher(const std::vector<std::string>& stringsToSearch, const bool ignoreCase)
+				: m_Patterns{ stringsToSearch }
+				, m_pAhoCorasick{}
+#ifdef RDW_SS_HAS_SSE2
+				, m_pTeddy{}
+#endif
+			{
+				std::vector<uint32_t> patternIndices{};
+
+				for (size_t i{}; i < m_Patterns.size(); ++i)
+				{
+					if (ignoreCase)
+					{
+						TransformStringToLowercase(m_Patterns[i]);
+					}
+
+					if (!m_Patterns[i].empty() && m_Patterns[i].find('\n') == std::string::npos)
+					{
+						patternIndices.push_back(static_cast<uint32_t>(i));
+					}
+				}
+
+#ifdef RDW_SS_HAS_SSE2
+				if (!patternIndices.empty() && patternIndices.size() <= Teddy::MaxNrOfPatterns && Teddy::IsSupported())
+				{
+					m_pTeddy = std::make_unique<Teddy>(m_Patterns, patternIndices, ignoreCase);
+					return;
+				}
+#endif
+
+				m_pAhoCorasick = std::make_unique<AhoCorasick>(m_Patterns, patternIndices, ignoreCase);
+			}
+
+			MultiStringMatcher(const MultiStringMatcher&) noexcept = delete;
+			MultiStringMatcher(MultiStringMatcher&&) noexcept = delete;
+			MultiStringMatcher& operator=(const MultiStringMatcher&) noexcept = delete;
+			MultiStringMatcher& operator=(MultiStringMatcher&&) noexcept = delete;
+
+			[[nodiscard]] size_t GetNrOfPatterns() const { return m_Patterns.size(); }
+
+			[[nodiscard]] bool GetRequiredLiterals(std::vector<std::string>& literals) const
+			{
+				for (const std::string& pattern : m_Patterns)
+				{
+					// a pattern spanning lines never matches, so it needs no file to be searched
+					if (pattern.find('\n') == std::string::npos) literals.push_back(pattern);
+				}
+
+				return true;
+			}
+
+			template<typename Callback>
+			const char* SearchBuffer(const std::string_view buffer, uint32_t& lineNumber, Callback&& onMatch) const
+			{
+				const char* pCounted{ buffer.data() };
+
+				// a pattern can occur several times on one line, but every line only gets reported once per pattern
+				std::vector<uint32_t> lastReportedLines(m_Patterns.size());
+
+				const auto onHit{ [&buffer, &lineNumber, &onMatch, &pCounted, &lastReportedLines](const size_t position, const uint32_t patternIndex)->void
+					{
+						const char* pHit{ buffer.data() + position };
+						lineNumber += CountNewlines(pCounted, pHit);
+						pCounted = pHit;
+
+						if (lastReportedLines[patternIndex] == lineNumber) return;
+
+						lastReportedLines[patternIndex] = lineNumber;
+						onMatch(size_t{ patternIndex }, lineNumber);
+					} };
+
+				Scan(buffer, onHit);
+				return pCounted;
+			}
+
+			/// <summary>
+			/// Calls onHit(position, patternIndex) for every occurrence of every pattern, position is a byte inside the match
+			/// </summary>
+			template<typename Callback>
+			void Scan(const std::string_view buffer, Callback&& onHit) const
+			{
+#ifdef RDW_SS_HAS_SSE2
+				if (m_pTeddy)
+				{
+					m_pTeddy->Scan(buffer, onHit);
+					return;
+				}
+#endif
+
+				m_pAhoCorasick->Scan(buffer, onHit);
+			}
+
+		private:
+			std::vector<std::string> m_Patterns;
+			std::unique_ptr<AhoCorasick> m_pAhoCorasick;
+#ifdef RDW_SS_HAS_SSE2
+			std::unique_ptr<Teddy> m_pTeddy;
+#endif
+		};
+
+		/// <summary>
+		/// Calls search(matcher) with the matcher for stringsToSearch, specialized for the options of the query
+		/// This is the only place a string search looks at ignoreCase and the number of strings
+		/// </summary>
+		template<typename Search>
+		void DispatchStringMatcher(const std::vector<std::string>& stringsToSearch, const bool ignoreCase, Search&& search)
+		{
+			if (stringsToSearch.size() != 1)
+			{
+				const MultiStringMatcher matcher{ stringsToSearch, ignoreCase };
+				search(matcher);
+			}
+			else if (ignoreCase)
+			{
+				const StringMatcher<true> matcher{ stringsToSearch.front() };
+				search(matcher);
+			}
+			else
+			{
+				const StringMatcher<false> matcher{ stringsToSearch.front() };
+				search(matcher);
+			}
+		}
+
+		using ByteSet = std::bitset<256>;
+
+		inline static constexpr uint32_t RegexUnbounded{ std::numeric_limits<uint32_t>::max() };
+
+		struct RegexNode final
+		{
+			enum class Type : uint8_t
+			{
+				Empty,
+				Bytes,
+				Concatenation,
+				Alternation,
+				Repetition,
+				LineStart,
+				LineEnd
+			};
+
+			Type NodeType;
+			ByteSet Bytes;
+			std::vector<RegexNode> Children;
+			uint32_t Min;
+			uint32_t Max; // RegexUnbounded for * and +
+		};
+
+		/// <summary>
+		/// Recursive descent parser for the supported regex syntax:
+		/// literals, ., [] and [^] classes with [:alpha:] style classes inside them, \d \w \s and their negations, * + ? {m} {m,} {m,n}, |, () and (?:), ^ and $
+		/// Lines are matched on their own, so ^ and $ match at the start and end of a line, and . and negated classes never match a newline
+		/// </summary>
+		class RegexParser final
+		{
+		public:
+			inline static constexpr uint32_t MaxNestingDepth{ 256 };
+			inline static constexpr uint32_t MaxRepetition{ 1000 };
+
+			RegexParser(const std::string_view pattern, const bool ignoreCase)
+				: m_Pattern{ pattern }
+				, m_Position{}
+				, m_IgnoreCase{ ignoreCase }
+				, m_Error{}
+			{}
+
+			/// <summary>
+			/// Returns false if the pattern is invalid, GetError() then says why
+			/// </summary>
+			[[nodiscard]] bool Parse(RegexNode& root)
+			{
+				if (!ParseAlternation(root, 0)) return false;
+				if (m_Position != m_Pattern.size()) return Fail("unmatched )");
+
+				return true;
+			}
+
+			[[nodiscard]] const std::string& GetError() const { return m_Error; }
+
+		private:
+			bool Fail(const std::string_view error)
+			{
+				m_Error = error;
+				m_Error += " at position ";
+				m_Error += std::to_string(m_Position);
+				return false;
+			}
+
+			[[nodiscard]] bool IsAtEnd() const { return m_Position == m_Pattern.size(); }
+			[[nodiscard]] char Peek() const { return m_Pattern[m_Position]; }
+
+			static RegexNode MakeNode(const RegexNode::Type type)
+			{
+				return RegexNode{ type, ByteSet{}, std::vector<RegexNode>{}, 1, 1 };
+			}
+
+			RegexNode MakeBytesNode(ByteSet bytes) const
+			{
+				if (m_IgnoreCase) AddOtherCase(bytes);
+
+				RegexNode node{ MakeNode(RegexNode::Type::Bytes) };
+				node.Bytes = bytes;
+				return node;
+			}
+
+			static void AddOtherCase(ByteSet& bytes)
+			{
+				for (size_t byte{ 'A' }; byte <= 'Z'; ++byte)
+				{
+					if (bytes.test(byte) || bytes.test(byte | 0x20))
+					{
+						bytes.set(byte);
+						bytes.set(byte | 0x20);
+					}
+				}
+			}
+
+			static ByteSet Negate(const ByteSet& bytes)
+			{
+				ByteSet negated{ ~bytes };
+				negated.reset('\n');
+				return negated;
+			}
+
+			bool ParseAlternation(RegexNode& node, const uint32_t depth)
+			{
+				if (depth > MaxNestingDepth) return Fail("pattern is nested too deeply");
+
+				RegexNode branch{};
+				if (!ParseConcatenation(branch, depth)) return false;
+
+				if (IsAtEnd() || Peek() != '|')
+				{
+					node = std::move(branch);
+					return true;
+				}
+
+				node = MakeNode(RegexNode::Type::Alternation);
+				node.Children.push_back(std::move(branch));
+
+				while (!IsAtEnd() && Peek() == '|')
+				{
+					++m_Position;
+
+					if (!ParseConcatenation(branch, depth)) return false;
+					node.Children.push_back(std::move(branch));
+				}
+
+				return true;
+			}
+
+			bool ParseConcatenation(RegexNode& node, const uint32_t depth)
+			{
+				std::vector<RegexNode> children{};
+
+				while (!IsAtEnd() && Peek() != '|' && Peek() != ')')
+				{
+					RegexNode child{};
+					if (!ParseRepetition(child, depth)) return false;
+
+					children.push_back(std::move(child));
+				}
+
+				if (children.size() == 1)
+				{
+					node = std::move(children.front());
+				}
+				else
+				{
+					node = MakeNode(children.empty() ? RegexNode::Type::Empty : RegexNode::Type::Concatenation);
+					node.Children = std::move(children);
+				}
+
+				return true;
+			}
+
+			bool ParseRepetition(RegexNode& node, uint32_t depth)
+			{
+				if (!ParseAtom(node, depth)) return false;
+
+				while (!IsAtEnd())
+				{
+					uint32_t min{}, max{};
+
+					switch (Peek())
+					{
+					case '*':
+						min = 0;
+						max = RegexUnbounded;
+						++m_Position;
+						break;
+					case '+':
+						min = 1;
+						max = RegexUnbounded;
+						++m_Position;
+						break;
+					case '?':
+						min = 0;
+						max = 1;
+						++m_Position;
+						break;
+					case '{':
+						// a { that does not start a valid bound is a literal, same as grep -E
+						if (!ParseBounds(min, max)) return m_Error.empty();
+						break;
+					default:
+						return true;
+					}
+
+					if (++depth > MaxNestingDepth) return Fail("pattern is nested too deeply");
+
+					// lazy and possessive quantifiers match the same lines, so the suffix is accepted and ignored
+					if (!IsAtEnd() && (Peek() == '?' || Peek() == '+')) ++m_Position;
+
+					RegexNode repetition{ MakeNode(RegexNode::Type::Repetition) };
+					repetition.Min = min;
+					repetition.Max = max;
+					repetition.Children.push_back(std::move(node));
+					node = std::move(repetition);
+				}
+
+				return true;
+			}
+
+			/// <summary>
+			/// Returns false without consuming anything if the { does not start a bound, or with an error set if the bound is invalid
+			/// </summary>
+			bool ParseBounds(uint32_t& min, uint32_t& max)
+			{
+				size_t position{ m_Position + 1 };
+
+				const auto parseNumber{ [this, &position](uint32_t& number)->bool
+					{
+						const size_t start{ position };
+						number = 0;
+
+						while (position < m_Pattern.size() && m_Pattern[position] >= '0' && m_Pattern[position] <= '9')
+						{
+							number = std::min<uint32_t>(number * 10 + static_cast<uint32_t>(m_Pattern[position] - '0'), MaxRepetition + 1);
+							++position;
+						}
+
+						return position != start;
+					} };
+
+				if (!parseNumber(min)) return false;
+
+				max = min;
+				if (position < m_Pattern.size() && m_Pattern[position] == ',')
+				{
+					++position;
+					if (!parseNumber(max)) max = RegexUnbounded;
+				}
+
+				if (position >= m_Pattern.size() || m_Pattern[position] != '}') return false;
+
+				m_Position = position + 1;
+
+				if (min > MaxRepetition || (max != RegexUnbounded && max > MaxRepetition)) return Fail("repetition count is too large");
+				if (min > max) return Fail("invalid repetition range");
+
+				return true;
+			}
+
+			bool ParseAtom(RegexNode& node, const uint32_t depth)
+			{
+				const char c{ m_Pattern[m_Position++] };
+
+				switch (c)
+				{
+				case '(':
+				{
+					if (m_Pattern.substr(m_Position, 2) == "?:") m_Position += 2;
+
+					if (!ParseAlternation(node, depth + 1)) return false;
+					if (IsAtEnd()) return Fail("missing )");
+
+					++m_Position;
+					return true;
+				}
+				case '[':
+					return ParseClass(node);
+				case '.':
+					node = MakeBytesNode(Negate(ByteSet{}));
+					return true;
+				case '^':
+					node = MakeNode(RegexNode::Type::LineStart);
+					return true;
+				case '$':
+					node = MakeNode(RegexNode::Type::LineEnd);
+					return true;
+				case '*':
+				case '+':
+				case '?':
+					--m_Position;
+					return Fail("nothing to repeat");
+				case '\\':
+				{
+					ByteSet bytes{};
+					if (!ParseEscape(bytes)) return false;
+
+					node = MakeBytesNode(bytes);
+					return true;
+				}
+				default:
+				{
+					ByteSet bytes{};
+					bytes.set(static_cast<unsigned char>(c));
+
+					node = MakeBytesNode(bytes);
+					return true;
+				}
+				}
+			}
+
+			/// <summary>
+			/// Parses the escape following a backslash, isSingleByte is set when it stands for exactly one byte
+			/// </summary>
+			bool ParseEscape(ByteSet& bytes, bool* pIsSingleByte = nullptr, unsigned char* pByte = nullptr)
+			{
+				if (IsAtEnd()) return Fail("trailing backslash");
+
+				const char c{ m_Pattern[m_Position++] };
+
+				ByteSet digits{}, wordCharacters{}, spaces{};
+				for (size_t byte{}; byte < 256; ++byte)
+				{
+					const char character{ static_cast<char>(byte) };
+					const bool isDigit{ character >= '0' && character <= '9' };
+
+					digits[byte] = isDigit;
+					wordCharacters[byte] = isDigit || IsAlpha(character) || character == '_';
+					spaces[byte] = character == ' ' || (character >= '\t' && character <= '\r');
+				}
+
+				unsigned char byte{};
+				switch (c)
+				{
+				case 'd': bytes |= digits; break;
+				case 'D': bytes |= Negate(digits); break;
+				case 'w': bytes |= wordCharacters; break;
+				case 'W': bytes |= Negate(wordCharacters); break;
+				case 's': bytes |= spaces; break;
+				case 'S': bytes |= Negate(spaces); break;
+				case 'n': byte = '\n'; break;
+				case 'r': byte = '\r'; break;
+				case 't': byte = '\t'; break;
+				case 'f': byte = '\f'; break;
+				case 'v': byte = '\v'; break;
+				case 'x':
+				{
+					const auto hexValue{ [](const char digit)->int
+						{
+							if (digit >= '0' && digit <= '9') return digit - '0';
+							if (digit >= 'a' && digit <= 'f') return digit - 'a' + 10;
+							if (digit >= 'A' && digit <= 'F') return digit - 'A' + 10;
+							return -1;
+						} };
+
+					if (m_Pattern.size() - m_Position < 2 || hexValue(m_Pattern[m_Position]) < 0 || hexValue(m_Pattern[m_Position + 1]) < 0)
+					{
+						return Fail("\\x needs two hexadecimal digits");
+					}
+
+					byte = static_cast<unsigned char>(hexValue(m_Pattern[m_Position]) * 16 + hexValue(m_Pattern[m_Position + 1]));
+					m_Position += 2;
+					break;
+				}
+				default:
+					// escaped punctuation is a literal, unknown letter or digit escapes (\b, \1, ...) are not supported
+					if (IsAlpha(c) || (c >= '0' && c <= '9'))
+					{
+						--m_Position;
+						return Fail("unsupported escape");
+					}
+
+					byte = static_cast<unsigned char>(c);
+					break;
+				}
+
+				const bool isSingleByte{ bytes.none() };
+				if (isSingleByte) bytes.set(byte);
+
+				if (pIsSingleByte) *pIsSingleByte = isSingleByte;
+				if (pByte) *pByte = byte;
+
+				return true;
+			}
+
+			bool ParseClass(RegexNode& node)
+			{
+				const bool isNegated{ !IsAtEnd() && Peek() == '^' };
+				if (isNegated) ++m_Position;
+
+				ByteSet bytes{};
+				bool isFirst{ true };
+
+				for (;;)
+				{
+					if (IsAtEnd()) return Fail("missing ]");
+					if (Peek() == ']' && !isFirst) break;
+
+					isFirst = false;
+
+					bool isSingleByte{};
+					unsigned char first{};
+					if (!ParseClassItem(bytes, isSingleByte, first)) return false;
+
+					// a - right before the ] is a literal
+					if (m_Pattern.size() - m_Position < 2 || Peek() != '-' || m_Pattern[m_Position + 1] == ']') continue;
+
+					++m_Position;
+
+					ByteSet lastBytes{};
+					bool isLastSingleByte{};
+					unsigned char last{};
+					if (!ParseClassItem(lastBytes, isLastSingleByte, last)) return false;
+
+					if (!isSingleByte || !isLastSingleByte || first > last) return Fail("invalid range in []");
+
+					for (size_t byte{ first }; byte <= last; ++byte)
+					{
+						bytes.set(byte);
+					}
+				}
+
+				++m_Position;
+
+				if (m_IgnoreCase) AddOtherCase(bytes);
+
+				node = MakeBytesNode(isNegated ? Negate(bytes) : bytes);
+				return true;
+			}
+
+			bool ParseClassItem(ByteSet& bytes, bool& isSingleByte, unsigned char& byte)
+			{
+				const char c{ m_Pattern[m_Position++] };
+
+				if (c == '\\')
+				{
+					ByteSet escaped{};
+					if (!ParseEscape(escaped, &isSingleByte, &byte)) return false;
+
+					bytes |= escaped;
+					return true;
+				}
+
+				if (c == '[' && !IsAtEnd() && (Peek() == ':' || Peek() == '=' || Peek() == '.'))
+				{
+					isSingleByte = false;
+					return ParseNamedClass(bytes);
+				}
+
+				isSingleByte = true;
+				byte = static_cast<unsigned char>(c);
+				bytes.set(byte);
+				return true;
+			}
+
+			/// <summary>
+			/// Parses a POSIX class like [:alpha:] inside [], the [ is already consumed. Classes only hold ASCII characters
+			/// Equivalence classes [=a=] and collating symbols [.a.] are not supported
+			/// </summary>
+			bool ParseNamedClass(ByteSet& bytes)
+			{
+				if (Peek() != ':') return Fail("unsupported [= or [. in []");
+
+				const size_t nameStart{ m_Position + 1 };
+				const size_t nameEnd{ m_Pattern.find(":]", nameStart) };
+				if (nameEnd == std::string_view::npos) return Fail("missing :] in []");
+
+				const std::string_view name{ m_Pattern.substr(nameStart, nameEnd - nameStart) };
+
+				bool (*pIsInClass)(char) { nullptr };
+				if (name == "alpha") pIsInClass = [](const char c) { return IsAlpha(c); };
+				else if (name == "digit") pIsInClass = [](const char c) { return c >= '0' && c <= '9'; };
+				else if (name == "alnum") pIsInClass = [](const char c) { return IsAlpha(c) || (c >= '0' && c <= '9'); };
+				else if (name == "upper") pIsInClass = [](const char c) { return c >= 'A' && c <= 'Z'; };
+				else if (name == "lower") pIsInClass = [](const char c) { return c >= 'a' && c <= 'z'; };
+				else if (name == "space") pIsInClass = [](const char c) { return c == ' ' || (c >= '\t' && c <= '\r'); };
+				else if (name == "blank") pIsInClass = [](const char c) { return c == ' ' || c == '\t'; };
+				else if (name == "punct") pIsInClass = [](const char c) { return c > ' ' && c < 0x7F && !IsAlpha(c) && (c < '0' || c > '9'); };
+				else if (name == "print") pIsInClass = [](const char c) { return c >= ' ' && c < 0x7F; };
+				else if (name == "graph") pIsInClass = [](const char c) { return c > ' ' && c < 0x7F; };
+				else if (name == "cntrl") pIsInClass = [](const char c) { return static_cast<unsigned char>(c) < ' ' || c == 0x7F; };
+				else if (name == "xdigit") pIsInClass = [](const char c) { return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F'); };
+				else
+				{
+					m_Position = nameStart;
+					return Fail("unknown class [:" + std::string{ name } + ":]");
+				}
+
+				for (size_t byte{}; byte < 256; ++byte)
+				{
+					if (pIsInClass(static_cast<char>(byte))) bytes.set(byte);
+				}
+
+				m_Position = nameEnd + 2;
+				return true;
+			}
+
+			std::string_view m_Pattern;
+			size_t m_Position;
+			bool m_IgnoreCase;
+			std::string m_Error;
+		};
+
+		/// <summary>
+		/// Literal strings pulled out of a regex, so the SIMD kernels can skip everything that cannot match
+		/// When IsExact is set the node matches exactly one of Strings. Every match contains one of Required, none are known when it is empty
+		/// With ignoreCase the strings are folded to lowercase
+		/// </summary>
+		struct RegexLiterals final
+		{
+			inline static constexpr size_t MaxNrOfStrings{ 16 };
+			inline static constexpr size_t MaxStringLength{ 64 };
+
+			bool IsExact;
+			std::vector<std::string> Strings;
+			std::vector<std::string> Required;
+
+			/// <summary>
+			/// Literals of this many bytes already skip nearly everything, beyond that fewer strings beat longer ones
+			/// </summary>
+			inline static constexpr size_t GoodEnoughLength{ 8 };
+
+			/// <summary>
+			/// Longer literals skip more, so a set is as good as its shortest string
+			/// </summary>
+			[[nodiscard]] static size_t GetScore(const std::vector<std::string>& strings)
+			{
+				if (strings.empty()) return 0;
+
+				size_t score{ std::numeric_limits<size_t>::max() };
+				for (const std::string& string : strings)
+				{
+					score = std::min(score, string.size());
+				}
+
+				return score;
+			}
+
+			static void KeepBest(std::vector<std::string>& best, const std::vector<std::string>& candidate)
+			{
+				const size_t bestScore{ GetScore(best) };
+				const size_t candidateScore{ GetScore(candidate) };
+
+				if (candidateScore == 0) return;
+
+				// a single string goes through the substring kernels, which are faster than the multi-string ones
+				const size_t candidateLength{ std::min(candidateScore, GoodEnoughLength) };
+				const size_t bestLength{ std::min(bestScore, GoodEnoughLength) };
+
+				if (candidateLength != bestLength)
+				{
+					if (candidateLength > bestLength) best = candidate;
+				}
+				else if (candidate.size() != best.size())
+				{
+					if (candidate.size() < best.size()) best = candidate;
+				}
+				else if (candidateScore > bestScore)
+				{
+					best = candidate;
+				}
+			}
+
+			/// <summary>
+			/// Every string of lhs followed by every string of rhs, returns false if the result would grow too large
+			/// </summary>
+			[[nodiscard]] static bool Concatenate(const std::vector<std::string>& lhs, const std::vector<std::string>& rhs, std::vector<std::string>& result)
+			{
+				if (lhs.size() * rhs.size() > MaxNrOfStrings) return false;
+
+				std::vector<std::string> strings{};
+				for (const std::string& left : lhs)
+				{
+					for (const std::string& right : rhs)
+					{
+						if (left.size() + right.size() > MaxStringLength) return false;
+
+						strings.push_back(left + right);
+					}
+				}
+
+				RemoveDuplicates(strings);
+				result = std::move(strings);
+				return true;
+			}
+
+			static void RemoveDuplicates(std::vector<std::string>& strings)
+			{
+				std::sort(strings.begin(), strings.end());
+				strings.erase(std::unique(strings.begin(), strings.end()), strings.end());
+			}
+
+			[[nodiscard]] static RegexLiterals Extract(const RegexNode& node, const bool ignoreCase)
+			{
+				RegexLiterals literals{ false, std::vector<std::string>{}, std::vector<std::string>{} };
+
+				switch (node.NodeType)
+				{
+				case RegexNode::Type::Empty:
+				case RegexNode::Type::LineStart:
+				case RegexNode::Type::LineEnd:
+					literals.IsExact = true;
+					literals.Strings.emplace_back();
+					break;
+
+				case RegexNode::Type::Bytes:
+				{
+					for (size_t byte{}; byte < 256; ++byte)
+					{
+						if (!node.Bytes.test(byte)) continue;
+
+						const char c{ static_cast<char>(byte) };
+						literals.Strings.emplace_back(1, ignoreCase ? ToLowercase(c) : c);
+					}
+
+					RemoveDuplicates(literals.Strings);
+
+					literals.IsExact = literals.Strings.size() <= 4;
+					if (!literals.IsExact) literals.Strings.clear();
+					break;
+				}
+
+				case RegexNode::Type::Concatenation:
+				{
+					// runs of exact children are glued together, the best run or inexact child's requirement wins
+					std::vector<std::string> run(1);
+					literals.IsExact = true;
+
+					for (const RegexNode& child : node.Children)
+					{
+						const RegexLiterals childLiterals{ Extract(child, ignoreCase) };
+
+						if (childLiterals.IsExact)
+						{
+							// the run so far might be a better literal than what it grows into, abc in abc[de]
+							KeepBest(literals.Required, run);
+
+							if (!Concatenate(run, childLiterals.Strings, run))
+							{
+								KeepBest(literals.Required, run);
+								run = childLiterals.Strings;
+								literals.IsExact = false;
+							}
+						}
+						else
+						{
+							KeepBest(literals.Required, run);
+							KeepBest(literals.Required, childLiterals.Required);
+							run.assign(1, std::string{});
+							literals.IsExact = false;
+						}
+					}
+
+					KeepBest(literals.Required, run);
+					if (literals.IsExact) literals.Strings = std::move(run);
+
+					return literals;
+				}
+
+				case RegexNode::Type::Alternation:
+				{
+					// a match of the alternation is a match of one of its branches, so it needs one of the branches' literals
+					bool hasRequired{ true };
+					literals.IsExact = true;
+
+					for (const RegexNode& child : node.Children)
+					{
+						const RegexLiterals childLiterals{ Extract(child, ignoreCase) };
+
+						if (childLiterals.IsExact)
+						{
+							literals.Strings.insert(literals.Strings.end(), childLiterals.Strings.begin(), childLiterals.Strings.end());
+						}
+						else
+						{
+							literals.IsExact = false;
+						}
+
+						hasRequired = hasRequired && GetScore(childLiterals.Required) > 0;
+						literals.Required.insert(literals.Required.end(), childLiterals.Required.begin(), childLiterals.Required.end());
+					}
+
+					RemoveDuplicates(literals.Strings);
+					RemoveDuplicates(literals.Required);
+
+					if (literals.Strings.size() > MaxNrOfStrings) literals.IsExact = false;
+					if (!literals.IsExact) literals.Strings.clear();
+					if (!hasRequired || literals.Required.size() > MaxNrOfStrings) literals.Required.clear();
+
+					return literals;
+				}
+
+				case RegexNode::Type::Repetition:
+				{
+					if (node.Max == 0)
+					{
+						literals.IsExact = true;
+						literals.Strings.emplace_back();
+						break;
+					}
+
+					// an optional node requires nothing
+					if (node.Min == 0) return literals;
+
+					const RegexLiterals childLiterals{ Extract(node.Children.front(), ignoreCase) };
+					literals.Required = childLiterals.Required;
+
+					if (!childLiterals.IsExact) return literals;
+
+					std::vector<std::string> repeated(1);
+					uint32_t nrOfRepetitions{};
+					while (nrOfRepetitions < node.Min && Concatenate(repeated, childLiterals.Strings, repeated))
+					{
+						++nrOfRepetitions;
+					}
+
+					KeepBest(literals.Required, repeated);
+
+					literals.IsExact = nrOfRepetitions == node.Min && node.Min == node.Max;
+					if (literals.IsExact) literals.Strings = std::move(repeated);
+
+					return literals;
+				}
+				}
+
+				// exact strings are required as well
+				literals.Required = literals.Strings;
+				return literals;
+			}
+		};
+
+		/// <summary>
+		/// Thompson NFA of a regex, with the bytes split into classes that no regex byte set tells apart
+		/// Immutable once compiled, so it is shared by all search threads
+		/// </summary>
+		class RegexProgram final
+		{
+		public:
+			inline static constexpr size_t MaxNrOfStates{ 1u << 16 };
+
+			struct State final
+			{
+				enum class Type : uint8_t
+				{
+					Bytes,
+					Split,
+					Match,
+					LineStart,
+					LineEnd
+				};
+
+				Type StateType;
+				uint32_t ByteSetIndex; // Bytes only
+				uint32_t Next;
+				uint32_t Alternative; // Split only
+			};
+
+			RegexProgram()
+				: m_States{}
+				, m_ByteSets{}
+				, m_ByteClasses{}
+				, m_ClassRepresentatives{}
+				, m_NrOfClasses{ 1 }
+				, m_StartState{}
+			{}
+
+			/// <summary>
+			/// Returns false if the regex needs too many states
+			/// </summary>
+			[[nodiscard]] bool Compile(const RegexNode& root)
+			{
+				m_States.push_back(State{ State::Type::Match, 0, 0, 0 });
+
+				const uint32_t startState{ Compile(root, 0) };
+				if (m_States.size() > MaxNrOfStates) return false;
+
+				m_StartState = startState;
+				ComputeByteClasses();
+
+				return true;
+			}
+
+			[[nodiscard]] const State& GetState(const uint32_t state) const { return m_States[state]; }
+			[[nodiscard]] size_t GetNrOfStates() const { return m_States.size(); }
+			[[nodiscard]] uint32_t GetStartState() const { return m_StartState; }
+
+			[[nodiscard]] uint32_t GetNrOfClasses() const { return m_NrOfClasses; }
+			[[nodiscard]] uint8_t GetByteClass(const unsigned char byte) const { return m_ByteClasses[byte]; }
+			[[nodiscard]] bool DoesClassMatch(const uint32_t state, const uint32_t byteClass) const
+			{
+				return m_ByteSets[m_States[state].ByteSetIndex].test(m_ClassRepresentatives[byteClass]);
+			}
+
+		private:
+			uint32_t AddState(const State& state)
+			{
+				m_States.push_back(state);
+				return static_cast<uint32_t>(m_States.size() - 1);
+			}
+
+			/// <summary>
+			/// Compiles node so that a match continues in state next, and returns the state the match starts in
+			/// </summary>
+			uint32_t Compile(const RegexNode& node, uint32_t next)
+			{
+				// the caller checks the size, this only stops a huge repetition from allocating all memory first
+				if (m_States.size() > MaxNrOfStates) return next;
+
+				switch (node.NodeType)
+				{
+				case RegexNode::Type::Empty:
+					return next;
+
+				case RegexNode::Type::Bytes:
+					m_ByteSets.push_back(node.Bytes);
+					return AddState(State{ State::Type::Bytes, static_cast<uint32_t>(m_ByteSets.size() - 1), next, 0 });
+
+				case RegexNode::Type::LineStart:
+					return AddState(State{ State::Type::LineStart, 0, next, 0 });
+
+				case RegexNode::Type::LineEnd:
+					return AddState(State{ State::Type::LineEnd, 0, next, 0 });
+
+				case RegexNode::Type::Concatenation:
+					for (auto it{ node.Children.rbegin() }; it != node.Children.rend(); ++it)
+					{
+						next = Compile(*it, next);
+					}
+					return next;
+
+				case RegexNode::Type::Alternation:
+				{
+					uint32_t start{ Compile(node.Children.back(), next) };
+					for (size_t i{ node.Children.size() - 1 }; i-- > 0;)
+					{
+						const uint32_t branch{ Compile(node.Children[i], next) };
+						start = AddState(State{ State::Type::Split, 0, branch, start });
+					}
+					return start;
+				}
+
+				case RegexNode::Type::Repetition:
+				{
+					const RegexNode& child{ node.Children.front() };
+					uint32_t start{ next };
+
+					if (node.Max == RegexUnbounded)
+					{
+						// the loop state is needed before the body can point back to it
+						const uint32_t loop{ AddState(State{ State::Type::Split, 0, 0, next }) };
+						const uint32_t body{ Compile(child, loop) };
+						m_States[loop].Next = body;
+						start = loop;
+					}
+					else
+					{
+						// x{2,4} is xx(x(x)?)?
+						for (uint32_t i{ node.Min }; i < node.Max; ++i)
+						{
+							const uint32_t body{ Compile(child, start) };
+							start = AddState(State{ State::Type::Split, 0, body, next });
+						}
+					}
+
+					for (uint32_t i{}; i < node.Min; ++i)
+					{
+						start = Compile(child, start);
+					}
+
+					return start;
+				}
+				}
+
+				return next;
+			}
+
+			/// <summary>
+			/// Refines the classes by every byte set in turn, bytes end up in the same class if no byte set tells them apart
+			/// </summary>
+			void ComputeByteClasses()
+			{
+				m_ByteClasses.fill(0);
+				m_NrOfClasses = 1;
+
+				for (const ByteSet& bytes : m_ByteSets)
+				{
+					std::array<int32_t, 512> newClasses{};
+					newClasses.fill(-1);
+
+					int32_t nrOfClasses{};
+					for (size_t byte{}; byte < 256; ++byte)
+					{
+						int32_t& newClass{ newClasses[m_ByteClasses[byte] * 2u + (bytes.test(byte) ? 1u : 0u)] };
+						if (newClass < 0) newClass = nrOfClasses++;
+
+						m_ByteClasses[byte] = static_cast<uint8_t>(newClass);
+					}
+
+					m_NrOfClasses = static_cast<uint32_t>(nrOfClasses);
+				}
+
+				for (size_t byte{ 256 }; byte-- > 0;)
+				{
+					m_ClassRepresentatives[m_ByteClasses[byte]] = static_cast<uint8_t>(byte);
+				}
+			}
+
+			std::vector<State> m_States;
+			std::vector<ByteSet> m_ByteSets;
+			std::array<uint8_t, 256> m_ByteClasses;
+			std::array<uint8_t, 256> m_ClassRepresentatives;
+			uint32_t m_NrOfClasses;
+			uint32_t m_StartState;
+		};
+
+		/// <summary>
+		/// DFA built from a RegexProgram on demand: a DFA state is the set of NFA states a line can be in, and a transition is only
+		/// computed the first time it is taken, so matching is linear in the input without building the full (possibly exponential) DFA
+		/// The DFA is unanchored: every state also contains the start of the regex, so a match can begin at any byte of the line
+		/// When the cache is full it is thrown away and rebuilt from the states that are needed next
+		/// </summary>
+		class LazyDfa final
+		{
+		public:
+			inline static constexpr size_t MaxCacheSize{ 4u << 20 };
+
+			explicit LazyDfa(const RegexProgram& program)
+				: m_Program{ program }
+				, m_StateSets{}
+				, m_StateIndices{}
+				, m_Transitions{}
+				, m_Flags{}
+				, m_Visited(program.GetNrOfStates())
+				, m_VisitGeneration{}
+				, m_RestartStates{}
+				, m_LineStartStates{}
+				, m_NextStates{}
+				, m_StartState{}
+				, m_MaxNrOfStates{ std::max<size_t>(MaxCacheSize / (program.GetNrOfClasses() * sizeof(int32_t)), 16) }
+			{
+				++m_VisitGeneration;
+				AddClosure(m_Program.GetStartState(), false, false, m_RestartStates);
+				std::sort(m_RestartStates.begin(), m_RestartStates.end());
+
+				++m_VisitGeneration;
+				AddClosure(m_Program.GetStartState(), true, false, m_LineStartStates);
+				std::sort(m_LineStartStates.begin(), m_LineStartStates.end());
+
+				Flush();
+			}
+
+			/// <summary>
+			/// Returns true if the regex matches anywhere in line, which must not contain a newline
+			/// </summary>
+			[[nodiscard]] bool IsLineMatch(const std::string_view line)
+			{
+				const unsigned char* const pData{ reinterpret_cast<const unsigned char*>(line.data()) };
+				const uint32_t nrOfClasses{ m_Program.GetNrOfClasses() };
+
+				uint32_t state{ m_StartState };
+				if (m_Flags[state] & IsMatchFlag) return true;
+
+				for (size_t i{}; i < line.size(); ++i)
+				{
+					const uint32_t byteClass{ m_Program.GetByteClass(pData[i]) };
+					const int32_t next{ m_Transitions[state * nrOfClasses + byteClass] };
+
+					state = next >= 0 ? static_cast<uint32_t>(next) : ComputeTransition(state, byteClass);
+					if (m_Flags[state] & IsMatchFlag) return true;
+				}
+
+				return (m_Flags[state] & IsMatchAtLineEndFlag) != 0;
+			}
+
+		private:
+			inline static constexpr uint8_t IsMatchFlag{ 1 << 0 };
+			inline static constexpr uint8_t IsMatchAtLineEndFlag{ 1 << 1 };
+
+			/// <summary>
+			/// Adds the NFA states reachable from state without consuming a byte, only the ones that consume a byte or end a match are kept
+			/// LineEnd states are kept as well, and only passed through when atLineEnd is set
+			/// </summary>
+			void AddClosure(const uint32_t state, const bool atLineStart, const bool atLineEnd, std::vector<uint32_t>& states)
+			{
+				std::vector<uint32_t> stack{ state };
+
+				while (!stack.empty())
+				{
+					const uint32_t current{ stack.back() };
+					stack.pop_back();
+
+					if (m_Visited[current] == m_VisitGeneration) continue;
+					m_Visited[current] = m_VisitGeneration;
+
+					const RegexProgram::State& nfaState{ m_Program.GetState(current) };
+					switch (nfaState.StateType)
+					{
+					case RegexProgram::State::Type::Split:
+						stack.push_back(nfaState.Alternative);
+						stack.push_back(nfaState.Next);
+						break;
+					case RegexProgram::State::Type::LineStart:
+						if (atLineStart) stack.push_back(nfaState.Next);
+						break;
+					case RegexProgram::State::Type::LineEnd:
+						if (atLineEnd) stack.push_back(nfaState.Next);
+						else states.push_back(current);
+						break;
+					case RegexProgram::State::Type::Bytes:
+					case RegexProgram::State::Type::Match:
+						states.push_back(current);
+						break;
+					}
+				}
+			}
+
+			/// <summary>
+			/// An empty line ends where it starts, so ^ still holds at the end of the start state
+			/// </summary>
+			uint8_t ComputeFlags(const std::vector<uint32_t>& states, const bool atLineStart)
+			{
+				uint8_t flags{};
+
+				++m_VisitGeneration;
+				std::vector<uint32_t> lineEndStates{};
+
+				for (const uint32_t state : states)
+				{
+					switch (m_Program.GetState(state).StateType)
+					{
+					case RegexProgram::State::Type::Match:
+						flags |= IsMatchFlag | IsMatchAtLineEndFlag;
+						break;
+					case RegexProgram::State::Type::LineEnd:
+						AddClosure(m_Program.GetState(state).Next, atLineStart, true, lineEndStates);
+						break;
+					default:
+						break;
+					}
+				}
+
+				for (const uint32_t state : lineEndStates)
+				{
+					if (m_Program.GetState(state).StateType == RegexProgram::State::Type::Match) flags |= IsMatchAtLineEndFlag;
+				}
+
+				return flags;
+			}
+
+			void Flush()
+			{
+				m_StateSets.clear();
+				m_StateIndices.clear();
+				m_Transitions.clear();
+				m_Flags.clear();
+
+				m_StartState = AddState(m_LineStartStates, true);
+			}
+
+			uint32_t AddState(const std::vector<uint32_t>& states, const bool isLineStart = false)
+			{
+				// the start state is kept apart from an equal state in the middle of a line, their flags can differ
+				std::string key(states.size() * sizeof(uint32_t) + 1, isLineStart ? '\1' : '\0');
+				if (!states.empty()) std::memcpy(key.data(), states.data(), key.size() - 1);
+
+				const auto it{ m_StateIndices.find(key) };
+				if (it != m_StateIndices.end()) return it->second;
+
+				const uint32_t index{ static_cast<uint32_t>(m_StateSets.size()) };
+
+				m_StateIndices.emplace(std::move(key), index);
+				m_StateSets.push_back(states);
+				m_Flags.push_back(ComputeFlags(states, isLineStart));
+				m_Transitions.resize(m_Transitions.size() + m_Program.GetNrOfClasses(), -1);
+
+				return index;
+			}
+
+			uint32_t ComputeTransition(const uint32_t state, const uint32_t byteClass)
+			{
+				m_NextStates.clear();
+				++m_VisitGeneration;
+
+				for (const uint32_t nfaState : m_StateSets[state])
+				{
+					if (m_Program.GetState(nfaState).StateType == RegexProgram::State::Type::Bytes && m_Program.DoesClassMatch(nfaState, byteClass))
+					{
+						AddClosure(m_Program.GetState(nfaState).Next, false, false, m_NextStates);
+					}
+				}
+
+				for (const uint32_t nfaState : m_RestartStates)
+				{
+					if (m_Visited[nfaState] == m_VisitGeneration) continue;
+
+					m_Visited[nfaState] = m_VisitGeneration;
+					m_NextStates.push_back(nfaState);
+				}
+
+				std::sort(m_NextStates.begin(), m_NextStates.end());
+
+				// the old state index is meaningless after a flush, so that transition is simply not recorded
+				if (m_StateSets.size() >= m_MaxNrOfStates)
+				{
+					Flush();
+					return AddState(m_NextStates);
+				}
+
+				const uint32_t next{ AddState(m_NextStates) };
+				m_Transitions[state * m_Program.GetNrOfClasses() + byteClass] = static_cast<int32_t>(next);
+
+				return next;
+			}
+
+			const RegexProgram& m_Program;
+
+			std::vector<std::vector<uint32_t>> m_StateSets;
+			std::unordered_map<std::string, uint32_t> m_StateIndices;
+			std::vector<int32_t> m_Transitions; // -1 until computed
+			std::vector<uint8_t> m_Flags;
+
+			std::vector<uint32_t> m_Visited;
+			uint32_t m_VisitGeneration;
+
+			std::vector<uint32_t> m_RestartStates;
+			std::vector<uint32_t> m_LineStartStates;
+			std::vector<uint32_t> m_NextStates;
+			uint32_t m_StartState;
+			size_t m_MaxNrOfStates;
+		};
+
+		/// <summary>
+		/// Matcher for regular expressions
+		/// The literals every match has to contain are searched for with the SIMD kernels first, and only the lines they occur on
+		/// are run through the lazy DFA. Regexes without usable literals run the DFA over every line
+		/// Several regexes are searched one after the other, every regex gets its own pass over the buffer
+		/// </summary>
+		class RegexMatcher final
+		{
+		public:
+			RegexMatcher(const std::vector<std::string>& regexesToSearch, const bool ignoreCase)
+				: m_Regexes{}
+				, m_Id{ GetNextId() }
+				, m_Error{}
+			{
+				m_Regexes.reserve(regexesToSearch.size());
+
+				for (const std::string& pattern : regexesToSearch)
+				{
+					RegexNode root{};
+					RegexParser parser{ pattern, ignoreCase };
+
+					if (!parser.Parse(root))
+					{
+						m_Error = "Invalid regex \"" + pattern + "\": " + parser.GetError();
+						return;
+					}
+
+					std::unique_ptr<CompiledRegex> pRegex{ std::make_unique<CompiledRegex>() };
+					if (!pRegex->Program.Compile(root))
+					{
+						m_Error = "Invalid regex \"" + pattern + "\": pattern is too large";
+						return;
+					}
+
+					pRegex->Literals = RegexLiterals::Extract(root, ignoreCase).Required;
+					if (pRegex->Literals.size() > 1)
+					{
+						pRegex->pLiterals = std::make_unique<MultiStringMatcher>(pRegex->Literals, ignoreCase);
+					}
+					else if (!pRegex->Literals.empty())
+					{
+						const size_t literalSize{ pRegex->Literals.front().size() };
+						pRegex->FindLiteral = ignoreCase ? GetFindStringFunction<true>(literalSize) : GetFindStringFunction<false>(literalSize);
+					}
+
+					m_Regexes.push_back(std::move(pRegex));
+				}
+			}
+
+			RegexMatcher(const RegexMatcher&) noexcept = delete;
+			RegexMatcher(RegexMatcher&&) noexcept = delete;
+			RegexMatcher& operator=(const RegexMatcher&) noexcept = delete;
+			RegexMatcher& operator=(RegexMatcher&&) noexcept = delete;
+
+			[[nodiscard]] bool IsValid() const { return m_Error.empty(); }
+			[[nodiscard]] const std::string& GetError() const { return m_Error; }
+
+			[[nodiscard]] size_t GetNrOfPatterns() const { return m_Regexes.size(); }
+
+			[[nodiscard]] bool GetRequiredLiterals(std::vector<std::string>& literals) const
+			{
+				for (const std::unique_ptr<CompiledRegex>& pRegex : m_Regexes)
+				{
+					if (pRegex->Literals.empty()) return false;
+
+					literals.insert(literals.end(), pRegex->Literals.begin(), pRegex->Literals.end());
+				}
+
+				return true;
+			}
+
+			template<typename Callback>
+			const char* SearchBuffer(const std::string_view buffer, uint32_t& lineNumber, Callback&& onMatch) const
+			{
+				return SearchBufferPerPattern(m_Regexes.size(), buffer, lineNumber, [this, &onMatch](const size_t regexIndex, const std::string_view pass, uint32_t& passLineNumber)->const char*
+					{
+						return SearchBufferForRegex(regexIndex, pass, passLineNumber, onMatch);
+					});
+			}
+
+		private:
+			struct CompiledRegex final
+			{
+				RegexProgram Program;
+				std::vector<std::string> Literals; // every match contains one of these, searched for with pLiterals if there are several
+				std::unique_ptr<MultiStringMatcher> pLiterals;
+				FindStringFunction FindLiteral; // kernel for a single literal
+			};
+
+			static uint64_t GetNextId()
+			{
+				static std::atomic<uint64_t> nextId{ 1 };
+				return nextId++;
+			}
+
+			/// <summary>
+			/// The DFA grows while searching, so every thread builds its own and the search threads never wait on each other
+			/// The cache is tied to the matcher through its id, which unlike its address is never reused
+			/// </summary>
+			std::vector<LazyDfa>& GetThreadDfas() const
+			{
+				struct ThreadDfas final
+				{
+					uint64_t MatcherId;
+					std::vector<LazyDfa> Dfas;
+				};
+
+				thread_local ThreadDfas threadDfas{ 0, std::vector<LazyDfa>{} };
+
+				if (threadDfas.MatcherId != m_Id)
+				{
+					threadDfas.MatcherId = m_Id;
+					threadDfas.Dfas.clear();
+					threadDfas.Dfas.reserve(m_Regexes.size());
+
+					for (const std::unique_ptr<CompiledRegex>& pRegex : m_Regexes)
+					{
+						threadDfas.Dfas.emplace_back(pRegex->Program);
+					}
+				}
+
+				return threadDfas.Dfas;
+			}
+
+			template<typename Callback>
+			const char* SearchBufferForRegex(const size_t regexIndex, const std::string_view buffer, uint32_t& lineNumber, Callback& onMatch) const
+			{
+				const CompiledRegex& regex{ *m_Regexes[regexIndex] };
+				LazyDfa& dfa{ GetThreadDfas()[regexIndex] };
+
+				const char* pCounted{ buffer.data() };
+				const char* const pEnd{ buffer.data() + buffer.size() };
+
+				// every line before this one has been checked already
+				const char* pNextLine{ buffer.data() };
+
+				const auto checkLine{ [&](const char* pLine)->void
+					{
+						const void* pNewline{ std::memchr(pLine, '\n', static_cast<size_t>(pEnd - pLine)) };
+						const char* pLineEnd{ pNewline ? static_cast<const char*>(pNewline) : pEnd };
+
+						if (dfa.IsLineMatch(std::string_view{ pLine, static_cast<size_t>(pLineEnd - pLine) }))
+						{
+							lineNumber += CountNewlines(pCounted, pLine);
+							pCounted = pLine;
+
+							onMatch(regexIndex, lineNumber);
+						}
+
+						pNextLine = pNewline ? pLineEnd + 1 : pEnd;
+					} };
+
+				const auto findLineStart{ [&pNextLine](const char* pHit)->const char*
+					{
+						while (pHit != pNextLine && pHit[-1] != '\n') --pHit;
+						return pHit;
+					} };
+
+				if (regex.pLiterals)
+				{
+					regex.pLiterals->Scan(buffer, [&](const size_t position, const uint32_t)->void
+						{
+							const char* pHit{ buffer.data() + position };
+							if (pHit >= pNextLine) checkLine(findLineStart(pHit));
+						});
+				}
+				else if (!regex.Literals.empty())
+				{
+					while (pNextLine < pEnd)
+					{
+						const size_t hit{ regex.FindLiteral(std::string_view{ pNextLine, static_cast<size_t>(pEnd - pNextLine) }, regex.Literals.front()) };
+						if (hit == std::string_view::npos) break;
+
+						checkLine(findLineStart(pNextLine + hit));
+					}
+				}
+				else
+				{
+					while (pNextLine < pEnd)
+					{
+						checkLine(pNextLine);
+					}
+				}
+
+				return pCounted;
+			}
+
+			std::vector<std::unique_ptr<CompiledRegex>> m_Regexes;
+			uint64_t m_Id;
+			std::string m_Error;
+		};
+
+		/// <summary>
+		/// Matcher for strings that may occur with up to maxNrOfErrors characters inserted, deleted or substituted
+		/// Myers' bit-parallel algorithm keeps a column of the edit distance matrix in bit vectors, so every byte costs a few word operations
+		/// per 64 characters of the string. A match never spans lines, the column starts over at the start of every line
+		/// A match contains one of maxNrOfErrors + 1 pieces of the string without errors, so only the lines holding a piece go through the bit vectors
+		/// Several strings are searched one after the other, every string gets its own pass over the buffer
+		/// </summary>
+		class FuzzyMatcher final
+		{
+		public:
+			FuzzyMatcher(const std::vector<std::string>& stringsToSearch, const uint32_t maxNrOfErrors, const bool ignoreCase)
+				: m_Strings{}
+				, m_MaxNrOfErrors{ maxNrOfErrors }
+			{
+				m_Strings.reserve(stringsToSearch.size());
+
+				for (const std::string& stringToSearch : stringsToSearch)
+				{
+					std::unique_ptr<FuzzyString> pString{ std::make_unique<FuzzyString>() };
+					pString->Size = stringToSearch.size();
+					pString->NrOfBlocks = std::max<size_t>((stringToSearch.size() + 63) / 64, 1);
+					pString->Masks.assign(256 * pString->NrOfBlocks, 0);
+
+					for (size_t i{}; i < stringToSearch.size(); ++i)
+					{
+						const char c{ stringToSearch[i] };
+						const uint64_t bit{ uint64_t{ 1 } << (i % 64) };
+
+						pString->Masks[static_cast<unsigned char>(c) * pString->NrOfBlocks + i / 64] |= bit;
+						if (ignoreCase && IsAlpha(c)) pString->Masks[static_cast<unsigned char>(c ^ 0x20) * pString->NrOfBlocks + i / 64] |= bit;
+					}
+
+					// a piece holding a '\n' is never on a line, but then the match has its error there and one of the other pieces is on the line
+					const size_t pieceSize{ stringToSearch.size() / (size_t{ maxNrOfErrors } + 1) };
+					if (pieceSize >= MinPieceSize)
+					{
+						for (size_t piece{}; piece <= maxNrOfErrors; ++piece)
+						{
+							// the last piece takes what is left over
+							const size_t size{ piece == maxNrOfErrors ? stringToSearch.size() - piece * pieceSize : pieceSize };
+							pString->Pieces.push_back(stringToSearch.substr(piece * pieceSize, size));
+
+							if (ignoreCase) TransformStringToLowercase(pString->Pieces.back());
+						}
+
+						pString->pPieces = std::make_unique<MultiStringMatcher>(pString->Pieces, ignoreCase);
+					}
+
+					m_Strings.push_back(std::move(pString));
+				}
+			}
+
+			FuzzyMatcher(const FuzzyMatcher&) noexcept = delete;
+			FuzzyMatcher(FuzzyMatcher&&) noexcept = delete;
+			FuzzyMatcher& operator=(const FuzzyMatcher&) noexcept = delete;
+			FuzzyMatcher& operator=(FuzzyMatcher&&) noexcept = delete;
+
+			[[nodiscard]] size_t GetNrOfPatterns() const { return m_Strings.size(); }
+
+			[[nodiscard]] bool GetRequiredLiterals(std::vector<std::string>& literals) const
+			{
+				for (const std::unique_ptr<FuzzyString>& pString : m_Strings)
+				{
+					if (pString->Pieces.empty()) return false;
+
+					literals.insert(literals.end(), pString->Pieces.begin(), pString->Pieces.end());
+				}
+
+				return true;
+			}
+
+			template<typename Callback>
+			const char* SearchBuffer(const std::string_view buffer, uint32_t& lineNumber, Callback&& onMatch) const
+			{
+				return SearchBufferPerPattern(m_Strings.size(), buffer, lineNumber, [this, &onMatch](const size_t stringIndex, const std::string_view pass, uint32_t& passLineNumber)->const char*
+					{
+						return SearchBufferForString(stringIndex, pass, passLineNumber, onMatch);
+					});
+			}
+
+		private:
+			/// <summary>
+			/// Pieces shorter than this are on too many lines to be worth looking for first, and are too short for an index
+			/// </summary>
+			inline static constexpr size_t MinPieceSize{ 3 };
+
+			struct FuzzyString final
+			{
+				std::vector<uint64_t> Masks; // NrOfBlocks words per byte: bit i of word b is set when the byte is character 64 * b + i of the string
+				size_t Size;
+				size_t NrOfBlocks;
+				std::vector<std::string> Pieces; // every match contains one of these, empty when they would be shorter than MinPieceSize
+				std::unique_ptr<MultiStringMatcher> pPieces;
+			};
+
+			/// <summary>
+			/// Whether the edit distance of the string to some part of the line is at most m_MaxNrOfErrors
+			/// The vertical deltas of the column are kept as bits that are set where it goes up (positive) or down (negative) by one,
+			/// the score is the distance of the whole string to the best part ending at the current byte
+			/// </summary>
+			[[nodiscard]] bool IsLineMatch(const FuzzyString& string, const std::string_view line) const
+			{
+				// deleting every character of the string is few enough errors
+				if (string.Size <= m_MaxNrOfErrors) return true;
+
+				size_t score{ string.Size };
+
+				if (string.NrOfBlocks == 1)
+				{
+					const uint64_t lastBit{ uint64_t{ 1 } << (string.Size - 1) };
+					uint64_t positive{ ~uint64_t{} }, negative{};
+
+					for (const char c : line)
+					{
+						const uint64_t equal{ string.Masks[static_cast<unsigned char>(c)] };
+						const uint64_t vertical{ equal | negative };
+						const uint64_t horizontal{ (((equal & positive) + positive) ^ positive) | equal };
+
+						uint64_t horizontalPositive{ negative | ~(horizontal | positive) };
+						uint64_t horizontalNegative{ positive & horizontal };
+
+						if ((horizontalPositive & lastBit) != 0) ++score;
+						else if ((horizontalNegative & lastBit) != 0 && --score <= m_MaxNrOfErrors) return true;
+
+						// a match can start anywhere, so the top row stays 0 and shifts in no change
+						horizontalPositive <<= 1;
+						horizontalNegative <<= 1;
+
+						positive = horizontalNegative | ~(vertical | horizontalPositive);
+						negative = horizontalPositive & vertical;
+					}
+
+					return false;
+				}
+
+				// every block passes the change of its last row on to the next block
+				thread_local std::vector<uint64_t> blocks{};
+				blocks.assign(2 * string.NrOfBlocks, 0);
+
+				for (size_t block{}; block < string.NrOfBlocks; ++block)
+				{
+					blocks[2 * block] = ~uint64_t{};
+				}
+
+				const uint64_t lastBit{ uint64_t{ 1 } << ((string.Size - 1) % 64) };
+
+				for (const char c : line)
+				{
+					const uint64_t* const pEqual{ string.Masks.data() + static_cast<unsigned char>(c) * string.NrOfBlocks };
+					int carry{};
+
+					for (size_t block{}; block < string.NrOfBlocks; ++block)
+					{
+						uint64_t& positive{ blocks[2 * block] };
+						uint64_t& negative{ blocks[2 * block + 1] };
+						const uint64_t blockLastBit{ block == string.NrOfBlocks - 1 ? lastBit : uint64_t{ 1 } << 63 };
+
+						uint64_t equal{ pEqual[block] };
+						const uint64_t vertical{ equal | negative };
+						if (carry < 0) equal |= 1;
+
+						const uint64_t horizontal{ (((equal & positive) + positive) ^ positive) | equal };
+
+						uint64_t horizontalPositive{ negative | ~(horizontal | positive) };
+						uint64_t horizontalNegative{ positive & horizontal };
+
+						const int carryOut{ (horizontalPositive & blockLastBit) != 0 ? 1 : (horizontalNegative & blockLastBit) != 0 ? -1 : 0 };
+
+						horizontalPositive <<= 1;
+						horizontalNegative <<= 1;
+						if (carry < 0) horizontalNegative |= 1;
+						else if (carry > 0) horizontalPositive |= 1;
+
+						positive = horizontalNegative | ~(vertical | horizontalPositive);
+						negative = horizontalPositive & vertical;
+						carry = carryOut;
+					}
+
+					if (carry > 0) ++score;
+					else if (carry < 0 && --score <= m_MaxNrOfErrors) return true;
+				}
+
+				return false;
+			}
+
+			template<typename Callback>
+			const char* SearchBufferForString(const size_t stringIndex, const std::string_view buffer, uint32_t& lineNumber, Callback& onMatch) const
+			{
+				const FuzzyString& string{ *m_Strings[stringIndex] };
+
+				const char* pCounted{ buffer.data() };
+				const char* const pEnd{ buffer.data() + buffer.size() };
+
+				// every line before this one has been checked already
+				const char* pNextLine{ buffer.data() };
+
+				const auto checkLine{ [&](const char* pLine)->void
+					{
+						const void* pNewline{ std::memchr(pLine, '\n', static_cast<size_t>(pEnd - pLine)) };
+						const char* pLineEnd{ pNewline ? static_cast<const char*>(pNewline) : pEnd };
+
+						if (IsLineMatch(string, std::string_view{ pLine, static_cast<size_t>(pLineEnd - pLine) }))
+						{
+							lineNumber += CountNewlines(pCounted, pLine);
+							pCounted = pLine;
+
+							onMatch(stringIndex, lineNumber);
+						}
+
+						pNextLine = pNewline ? pLineEnd + 1 : pEnd;
+					} };
+
+				if (string.pPieces)
+				{
+					string.pPieces->Scan(buffer, [&](const size_t position, const uint32_t)->void
+						{
+							const char* pHit{ buffer.data() + position };
+							if (pHit < pNextLine) return;
+
+							while (pHit != pNextLine && pHit[-1] != '\n') --pHit;
+							checkLine(pHit);
+						});
+				}
+				else
+				{
+					while (pNextLine < pEnd)
+					{
+						checkLine(pNextLine);
+					}
+				}
+
+				return pCounted;
+			}
+
+			std::vector<std::unique_ptr<FuzzyString>> m_Strings;
+			uint32_t m_MaxNrOfErrors;
+		};
+
+		/// <summary>
+		/// Counters of one thread, padded to a cache line so threads counting at the same time never share one
+		/// Times are in nanoseconds
+		/// </summary>
+		struct alignas(64) SearchCounters final
+		{
+			bool IsMeasuringPhases; // times and lines are only counted when set
+
+			uint64_t NrOfBytesRead;
+			uint64_t NrOfLinesScanned;
+			uint64_t NrOfMatches;
+			uint64_t NrOfOpenFailures;
+			uint64_t NrOfBinaryFilesSkipped;
+			uint64_t EnumerationTime;
+			uint64_t OpenTime;
+			uint64_t ReadTime;
+			uint64_t MatchTime;
+			uint64_t WaitTime;
+			uint64_t OutputTime;
+
+			void Add(const SearchCounters& other)
+			{
+				NrOfBytesRead += other.NrOfBytesRead;
+				NrOfLinesScanned += other.NrOfLinesScanned;
+				NrOfMatches += other.NrOfMatches;
+				NrOfOpenFailures += other.NrOfOpenFailures;
+				NrOfBinaryFilesSkipped += other.NrOfBinaryFilesSkipped;
+				EnumerationTime += other.EnumerationTime;
+				OpenTime += other.OpenTime;
+				ReadTime += other.ReadTime;
+				MatchTime += other.MatchTime;
+				WaitTime += other.WaitTime;
+				OutputTime += other.OutputTime;
+			}
+		};
+
+		/// <summary>
+		/// Counters for a thread of a search that counts into pCounters, they have to be added to pCounters once the thread is done
+		/// </summary>
+		inline SearchCounters MakeThreadCounters(const SearchCounters* pCounters)
+		{
+			SearchCounters counters{};
+			counters.IsMeasuringPhases = pCounters && pCounters->IsMeasuringPhases;
+
+			return counters;
+		}
+
+		inline bool IsMeasuringPhases(const SearchCounters* pCounters)
+		{
+			return pCounters && pCounters->IsMeasuringPhases;
+		}
+
+		inline uint64_t GetNanoseconds()
+		{
+			return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+		}
+
+		/// <summary>
+		/// Adds the time until it goes out of scope to one of the counters, and does nothing unless the counters measure phases
+		/// </summary>
+		class ScopedTimer final
+		{
+		public:
+			ScopedTimer(SearchCounters* pCounters, uint64_t SearchCounters::* pTime)
+				: m_pTime{ IsMeasuringPhases(pCounters) ? &(pCounters->*pTime) : nullptr }
+				, m_Start{ m_pTime ? GetNanoseconds() : 0 }
+			{}
+
+			~ScopedTimer()
+			{
+				if (m_pTime) *m_pTime += GetNanoseconds() - m_Start;
+			}
+
+			ScopedTimer(const ScopedTimer&) noexcept = delete;
+			ScopedTimer(ScopedTimer&&) noexcept = delete;
+			ScopedTimer& operator=(const ScopedTimer&) noexcept = delete;
+			ScopedTimer& operator=(ScopedTimer&&) noexcept = delete;
+
+		private:
+			uint64_t* m_pTime;
+			uint64_t m_Start;
+		};
+
+		/// <summary>
+		/// Number of lines in a buffer of which the first lineNumber - 1 lines up to pCounted have been counted already
+		/// Only used for the statistics, the matchers stop counting after the last match
+		/// </summary>
+		inline uint64_t GetNrOfLines(const std::string_view buffer, const uint32_t lineNumber, const char* pCounted)
+		{
+			if (buffer.empty()) return lineNumber - 1;
+
+			return lineNumber - 1 + CountNewlines(pCounted, buffer.data() + buffer.size()) + (buffer.back() != '\n' ? 1 : 0);
+		}
+
+		/// <summary>
+		/// Number of bytes at the start of a file that are looked at to tell binary files from text
+		/// </summary>
+		inline static constexpr size_t BinarySniffSize{ 8 * 1024 };
+
+		/// <summary>
+		/// Data counts as binary if it contains a NUL byte, or if more than 1 in 8 bytes is a control character or not valid UTF-8
+		/// Latin-1 text and the occasional stray byte stay well below that, compressed data and executables are far above it
+		/// </summary>
+		inline bool IsBinaryData(std::string_view data)
+		{
+			data = data.substr(0, BinarySniffSize);
+
+			if (data.find('\0') != std::string_view::npos) return true;
+
+			size_t nrOfSuspiciousBytes{};
+			for (size_t i{}; i < data.size();)
+			{
+				const unsigned char c{ static_cast<unsigned char>(data[i]) };
+
+				if (c < 0x80)
+				{
+					// tabs, newlines, form feeds and escape sequences are all common in text
+					if (c < 0x20 && c != '\t' && c != '\n' && c != '\r' && c != '\f' && c != '\v' && c != 0x1B) ++nrOfSuspiciousBytes;
+					if (c == 0x7F) ++nrOfSuspiciousBytes;
+
+					++i;
+					continue;
+				}
+
+				const size_t nrOfContinuationBytes{ c >= 0xC2 && c <= 0xDF ? 1u : c >= 0xE0 && c <= 0xEF ? 2u : c >= 0xF0 && c <= 0xF4 ? 3u : 0u };
+
+				size_t length{ 1 };
+				while (length <= nrOfContinuationBytes && i + length < data.size() && (static_cast<unsigned char>(data[i + length]) & 0xC0) == 0x80)
+				{
+					++length;
+				}
+
+				// a sequence cut off by the end of the sniffed data is not held against the file
+				const bool isCutOff{ i + length == data.size() && length <= nrOfContinuationBytes };
+				if (nrOfContinuationBytes == 0 || (length <= nrOfContinuationBytes && !isCutOff))
+				{
+					nrOfSuspiciousBytes += length;
+				}
+
+				i += length;
+			}
+
+			return nrOfSuspiciousBytes * 8 > data.size();
+		}
+
+		/// <summary>
+		/// Searches a memory-mapped file in blocks of whole lines, stops as soon as shouldContinue() returns false
+		/// Returns the number of bytes searched
+		/// </summary>
+		template<typename Matcher, typename Callback, typename ContinuePredicate>
+		size_t SearchBufferInBlocks(std::string_view buffer, const Matcher& matcher, Callback&& onMatch, ContinuePredicate&& shouldContinue)
+		{
+			const size_t bufferSize{ buffer.size() };
+
+			// Notepad++ starts counting at 1, so let's do the same
+			uint32_t lineNumber{ 1 };
+
+			while (!buffer.empty() && shouldContinue())
+			{
+				const size_t lineEnd{ buffer.find('\n', std::min(ReadBlockSize, buffer.size()) - 1) };
+				const std::string_view wholeLines{ buffer.substr(0, lineEnd == std::string_view::npos ? buffer.size() : lineEnd + 1) };
+
+				const char* pCounted{ matcher.SearchBuffer(wholeLines, lineNumber, onMatch) };
+				lineNumber += CountNewlines(pCounted, wholeLines.data() + wholeLines.size());
+
+				buffer.remove_prefix(wholeLines.size());
+			}
+
+			return bufferSize - buffer.size();
+		}
+
+		inline size_t GetNrOfSearchThreads()
+		{
+			return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+		}
+
+		/// <summary>
+		/// Mapped files of at least two chunks are searched by several threads at the same time, see SearchBufferInChunks()
+		/// </summary>
+		inline static constexpr size_t ParallelChunkSize{ 32 * 1024 * 1024 };
+
+		/// <summary>
+		/// The search threads of one search, lent to each other once they run out of files
+		/// A thread searching a huge file shares its chunks through Share(), and every thread that is out of files calls HelpUntilDone()
+		/// to take chunks until all threads are out of files. No threads are started for this, so a search never runs more threads than it was given
+		/// </summary>
+		class SearchHelpers final
+		{
+		public:
+			explicit SearchHelpers(const size_t nrOfThreads)
+				: m_Mutex{}
+				, m_HasChanged{}
+				, m_SharedWork{}
+				, m_NrOfBusyThreads{ nrOfThreads }
+			{}
+
+			SearchHelpers(const SearchHelpers&) noexcept = delete;
+			SearchHelpers(SearchHelpers&&) noexcept = delete;
+			SearchHelpers& operator=(const SearchHelpers&) noexcept = delete;
+			SearchHelpers& operator=(SearchHelpers&&) noexcept = delete;
+
+			/// <summary>
+			/// Runs work on the calling thread and on every thread that comes to help, and returns once all of them are done
+			/// work is called on several threads at once, and has to return once nothing is left to do
+			/// </summary>
+			void Share(const std::function<void()>& work, SearchCounters* pCounters)
+			{
+				SharedWork sharedWork{ &work, 0 };
+
+				{
+					const std::scoped_lock<std::mutex> lock{ m_Mutex };
+					m_SharedWork.push_back(&sharedWork);
+				}
+
+				m_HasChanged.notify_all();
+
+				work();
+
+				const ScopedTimer timer{ pCounters, &SearchCounters::WaitTime };
+
+				std::unique_lock<std::mutex> lock{ m_Mutex };
+				std::erase(m_SharedWork, &sharedWork);
+				m_HasChanged.wait(lock, [&sharedWork]() { return sharedWork.NrOfHelpers == 0; });
+			}
+
+			/// <summary>
+			/// Has to be called once by every search thread when it runs out of files
+			/// </summary>
+			void HelpUntilDone()
+			{
+				std::unique_lock<std::mutex> lock{ m_Mutex };
+				if (--m_NrOfBusyThreads == 0) m_HasChanged.notify_all();
+
+				for (;;)
+				{
+					m_HasChanged.wait(lock, [this]() { return !m_SharedWork.empty() || m_NrOfBusyThreads == 0; });
+					if (m_SharedWork.empty()) return;
+
+					SharedWork& sharedWork{ *m_SharedWork.back() };
+					++sharedWork.NrOfHelpers;
+					lock.unlock();
+
+					(*sharedWork.pWork)();
+
+					// once work returns nothing is left of it, so nobody else has to come and look
+					lock.lock();
+					std::erase(m_SharedWork, &sharedWork);
+					--sharedWork.NrOfHelpers;
+					m_HasChanged.notify_all();
+				}
+			}
+
+		private:
+			struct SharedWork final
+			{
+				const std::function<void()>* pWork;
+				size_t NrOfHelpers;
+			};
+
+			std::mutex m_Mutex;
+			std::condition_variable m_HasChanged;
+			std::vector<SharedWork*> m_SharedWork;
+			size_t m_NrOfBusyThreads;
+		};
+
+		/// <summary>
+		/// Splits the buffer into chunks of whole lines and searches them on several threads at the same time
+		/// Within a multi-threaded search the chunks are shared with the search threads that ran out of files, see SearchHelpers.
+		/// Without helpers the calling thread is the only search thread, so the chunks get threads of their own
+		/// A line never spans two chunks, so neither does a match. The line numbers of every chunk are offset by the newlines of the chunks
+		/// before it, after which onMatch gets the matches in the same order as a search on one thread would give them
+		/// </summary>
+		template<typename Matcher, typename Callback>
+		void SearchBufferInChunks(const std::string_view buffer, const Matcher& matcher, Callback&& onMatch, SearchHelpers* pHelpers, SearchCounters* pCounters)
+		{
+			struct Chunk final
+			{
+				SearchCounters Counters; // first, so every chunk starts on its own cache line
+				std::string_view Lines;
+				std::vector<std::pair<uint32_t, uint32_t>> Matches; // pattern index and line number within the chunk
+				uint32_t NrOfNewlines;
+			};
+
+			const size_t nrOfChunks{ std::max<size_t>(buffer.size() / ParallelChunkSize, 1) };
+
+			std::vector<Chunk> chunks{};
+			chunks.reserve(nrOfChunks);
+
+			for (size_t i{ 1 }, chunkStart{}; i <= nrOfChunks && chunkStart < buffer.size(); ++i)
+			{
+				// every chunk but the last one ends right after a newline
+				const size_t lineEnd{ i == nrOfChunks ? std::string_view::npos : buffer.find('\n', std::max(buffer.size() / nrOfChunks * i, chunkStart)) };
+				const size_t chunkEnd{ lineEnd == std::string_view::npos ? buffer.size() : lineEnd + 1 };
+
+				chunks.push_back(Chunk{ MakeThreadCounters(pCounters), buffer.substr(chunkStart, chunkEnd - chunkStart), {}, 0 });
+				chunkStart = chunkEnd;
+			}
+
+			const auto searchChunk{ [&matcher](Chunk& chunk)->void
+				{
+					const ScopedTimer timer{ &chunk.Counters, &SearchCounters::MatchTime };
+
+					uint32_t lineNumber{ 1 };
+					const char* pCounted{ matcher.SearchBuffer(chunk.Lines, lineNumber, [&chunk](const size_t patternIndex, const uint32_t lineNumber)->void
+						{
+							chunk.Matches.emplace_back(static_cast<uint32_t>(patternIndex), lineNumber);
+						}) };
+
+					chunk.NrOfNewlines = lineNumber - 1 + CountNewlines(pCounted, chunk.Lines.data() + chunk.Lines.size());
+
+					if (chunk.Counters.IsMeasuringPhases)
+					{
+						chunk.Counters.NrOfLinesScanned += GetNrOfLines(chunk.Lines, lineNumber, pCounted);
+					}
+				} };
+
+			// every thread takes the next chunk until none are left
+			std::atomic<size_t> nextChunk{};
+			const std::function<void()> searchChunks{ [&searchChunk, &chunks, &nextChunk]()->void
+				{
+					for (size_t i{ nextChunk++ }; i < chunks.size(); i = nextChunk++)
+					{
+						searchChunk(chunks[i]);
+					}
+				} };
+
+			if (pHelpers)
+			{
+				pHelpers->Share(searchChunks, pCounters);
+			}
+			else
+			{
+				const size_t nrOfThreads{ std::min(GetNrOfSearchThreads(), chunks.size()) };
+
+				std::vector<std::jthread> threads{};
+				threads.reserve(nrOfThreads - 1);
+
+				for (size_t i{ 1 }; i < nrOfThreads; ++i)
+				{
+					threads.emplace_back(searchChunks);
+				}
+
+				// the calling thread searches chunks itself, and only waits for the others once none are left
+				searchChunks();
+
+				const ScopedTimer timer{ pCounters, &SearchCounters::WaitTime };
+				threads.clear();
+			}
+
+			uint32_t nrOfPreviousLines{};
+			for (const Chunk& chunk : chunks)
+			{
+				for (const auto& [patternIndex, lineNumber] : chunk.Matches)
+				{
+					onMatch(size_t{ patternIndex }, nrOfPreviousLines + lineNumber);
+				}
+
+				nrOfPreviousLines += chunk.NrOfNewlines;
+
+				if (pCounters) pCounters->Add(chunk.Counters);
+			}
+		}
+
+		/// <summary>
+		/// shouldContinue(data) is called with the data read so far after every read, the search stops as soon as it returns false
+		/// Returns false if the search was stopped
+		/// The buffer is kept per thread, as most files that end up here are small or empty and allocating it would cost more than reading them
+		/// </summary>
+		template<typename File, typename Matcher, typename Callback, typename ContinuePredicate>
+		bool SearchFileInBlocks(File& file, const Matcher& matcher, Callback&& onMatch, ContinuePredicate&& shouldContinue, SearchCounters* pCounters)
+		{
+			thread_local std::vector<char> buffer(ReadBlockSize);
+
+			// a buffer that grew for a very long line is not kept around
+			if (buffer.size() != ReadBlockSize)
+			{
+				buffer.resize(ReadBlockSize);
+				buffer.shrink_to_fit();
+			}
+
+			size_t nrOfCarriedBytes{};
+
+			// Notepad++ starts counting at 1, so let's do the same
+			uint32_t lineNumber{ 1 };
+
+			for (;;)
+			{
+				// a single line does not fit in the buffer, so grow it
+				if (nrOfCarriedBytes == buffer.size()) buffer.resize(buffer.size() * 2);
+
+				size_t bytesRead{};
+				{
+					const ScopedTimer timer{ pCounters, &SearchCounters::ReadTime };
+					bytesRead = file.Read(buffer.data() + nrOfCarriedBytes, buffer.size() - nrOfCarriedBytes);
+				}
+
+				const std::string_view block{ buffer.data(), nrOfCarriedBytes + bytesRead };
+
+				if (pCounters) pCounters->NrOfBytesRead += bytesRead;
+
+				if (!shouldContinue(block)) return false;
+
+				if (bytesRead == 0)
+				{
+					const ScopedTimer timer{ pCounters, &SearchCounters::MatchTime };
+					const char* pCounted{ matcher.SearchBuffer(block, lineNumber, onMatch) };
+
+					if (IsMeasuringPhases(pCounters))
+					{
+						pCounters->NrOfLinesScanned += GetNrOfLines(block, lineNumber, pCounted);
+					}
+
+					return true;
+				}
+
+				// only search whole lines, the unfinished last line gets carried over to the next block
+				const size_t lastNewline{ block.rfind('\n') };
+				if (lastNewline == std::string_view::npos)
+				{
+					nrOfCarriedBytes = block.size();
+					continue;
+				}
+
+				const std::string_view wholeLines{ block.substr(0, lastNewline + 1) };
+				{
+					const ScopedTimer timer{ pCounters, &SearchCounters::MatchTime };
+					const char* pCounted{ matcher.SearchBuffer(wholeLines, lineNumber, onMatch) };
+					lineNumber += CountNewlines(pCounted, wholeLines.data() + wholeLines.size());
+				}
+
+				nrOfCarriedBytes = block.size() - wholeLines.size();
+				std::memmove(buffer.data(), buffer.data() + wholeLines.size(), nrOfCarriedBytes);
+			}
+		}
+
+		/// <summary>
+		/// Decides how much of every file one search reads, shared by all of its threads
+		/// </summary>
+		struct SearchControl final
+		{
+			BinaryFileMode BinaryMode;
+			SearchLimits Limits;
+			std::atomic<bool> IsStopped; // set by the first match with Limits.StopAtFirstMatch, the walkers and search threads stop once they see it
+			SearchHelpers* pHelpers; // set while several search threads are running, null for a search on a single thread
+
+			[[nodiscard]] uint32_t GetMaxMatchesPerFile() const { return Limits.StopAtFirstMatch ? 1 : Limits.MaxMatchesPerFile; }
+			[[nodiscard]] bool IsSearchStopped() const { return IsStopped.load(std::memory_order_relaxed); }
+		};
+
+		/// <summary>
+		/// Appends one result per pattern found in the file, results belongs to the calling thread so no locking is needed
+		/// file is a MappedFile, a ReadBuffer holding the whole file or a DecompressedFile
+		/// Whether a file is binary is decided on its first block, see IsBinaryData()
+		/// </summary>
+		template<typename File, typename Matcher>
+		void SearchFileContents(
+			const std::string& filename,
+			File& file,
+			const Matcher& matcher,
+			std::vector<FileSearchResult>& results,
+			SearchControl& control,
+			SearchCounters* pCounters)
+		{
+			std::vector<std::vector<uint32_t>> lineNumbers(matcher.GetNrOfPatterns());
+			size_t nrOfPatternsFound{};
+
+			// matches past the limit can still come in until the end of the block, they are dropped
+			const uint32_t maxNrOfMatches{ control.GetMaxMatchesPerFile() };
+			uint32_t nrOfMatches{};
+
+			const auto onMatch{ [&lineNumbers, &nrOfPatternsFound, &nrOfMatches, &control, maxNrOfMatches](const size_t patternIndex, const uint32_t lineNumber)->void
+				{
+					if (maxNrOfMatches != 0 && nrOfMatches == maxNrOfMatches) return;
+
+					if (lineNumbers[patternIndex].empty()) ++nrOfPatternsFound;
+
+					lineNumbers[patternIndex].push_back(lineNumber);
+					++nrOfMatches;
+
+					if (control.Limits.StopAtFirstMatch) control.IsStopped.store(true, std::memory_order_relaxed);
+				} };
+
+			bool isFirstBlock{ true }, isBinary{};
+
+			// a binary file is either skipped after its first block, or only searched until every pattern has been found
+			// any file stops once it reached its limit, or once the search was stopped
+			const auto shouldContinue{ [&](const std::string_view data)->bool
+				{
+					if (std::exchange(isFirstBlock, false) && control.BinaryMode != BinaryFileMode::SearchAsText)
+					{
+						isBinary = IsBinaryData(data);
+					}
+
+					if (control.IsSearchStopped() || (maxNrOfMatches != 0 && nrOfMatches == maxNrOfMatches)) return false;
+
+					if (!isBinary) return true;
+					if (control.BinaryMode == BinaryFileMode::Skip) return false;
+
+					return nrOfPatternsFound < lineNumbers.size();
+				} };
+
+			if (file.IsMapped())
+			{
+				const std::string_view view{ file.GetView() };
+				const bool isSearched{ shouldContinue(view) };
+
+				// a limited search goes block by block, so it can stop at the block of its last match
+				const bool isSearchedAtOnce{ isSearched && !isBinary && maxNrOfMatches == 0 };
+				size_t nrOfBytesRead{ isBinary && control.BinaryMode == BinaryFileMode::Skip ? std::min(view.size(), BinarySniffSize) : 0 };
+
+				if (isSearchedAtOnce && view.size() >= 2 * ParallelChunkSize)
+				{
+					// every chunk times its own search
+					SearchBufferInChunks(view, matcher, onMatch, control.pHelpers, pCounters);
+					nrOfBytesRead = view.size();
+				}
+				else
+				{
+					// a mapped file is read by page faults while it is searched, so that time counts as matching
+					const ScopedTimer timer{ pCounters, &SearchCounters::MatchTime };
+
+					if (isSearchedAtOnce)
+					{
+						// Notepad++ starts counting at 1, so let's do the same
+						uint32_t lineNumber{ 1 };
+						const char* pCounted{ matcher.SearchBuffer(view, lineNumber, onMatch) };
+
+						if (IsMeasuringPhases(pCounters))
+						{
+							pCounters->NrOfLinesScanned += GetNrOfLines(view, lineNumber, pCounted);
+						}
+
+						nrOfBytesRead = view.size();
+					}
+					else if (isSearched)
+					{
+						nrOfBytesRead = SearchBufferInBlocks(view, matcher, onMatch, [&shouldContinue, view]() { return shouldContinue(view); });
+					}
+				}
+
+				if (pCounters) pCounters->NrOfBytesRead += nrOfBytesRead;
+			}
+			else
+			{
+				SearchFileInBlocks(file, matcher, onMatch, shouldContinue, pCounters);
+			}
+
+			if (isBinary && control.BinaryMode == BinaryFileMode::Skip)
+			{
+				if (pCounters) ++pCounters->NrOfBinaryFilesSkipped;
+				return;
+			}
+
+			for (size_t i{}; i < lineNumbers.size(); ++i)
+			{
+				if (lineNumbers[i].empty()) continue;
+
+				// only which patterns a binary file contains is reported, its lines mean nothing
+				if (isBinary) lineNumbers[i].clear();
+
+				if (pCounters) pCounters->NrOfMatches += lineNumbers[i].size();
+
+				results.push_back(FileSearchResult{ filename, static_cast<uint32_t>(i), std::move(lineNumbers[i]), isBinary });
+			}
+		}
+
+#if defined(RDW_SS_HAS_ZLIB) || defined(RDW_SS_HAS_ZSTD)
+		template<typename Decoder, typename Matcher>
+		void SearchDecompressedFile(
+			const std::string& filename,
+			const std::string_view compressed,
+			const Matcher& matcher,
+			std::vector<FileSearchResult>& results,
+			SearchControl& control,
+			SearchCounters* pCounters)
+		{
+			DecompressedFile<Decoder> file{ compressed };
+			SearchFileContents(filename, file, matcher, results, control, pCounters);
+
+			if (file.HasFailed())
+			{
+				PrintMessage("Could not decompress file: ", filename);
+			}
+		}
+#endif
+
+		/// <summary>
+		/// Searches the decompressed contents of files that start with the magic bytes of a compression format that is compiled in,
+		/// line numbers refer to the decompressed contents
+		/// Only mapped files are recognised, as the magic bytes have to be known before the first block is searched
+		/// </summary>
+		template<typename File, typename Matcher>
+		void SearchOpenedFile(
+			const std::string& filename,
+			File& file,
+			const Matcher& matcher,
+			std::vector<FileSearchResult>& results,
+			SearchControl& control,
+			SearchCounters* pCounters)
+		{
+#ifdef RDW_SS_HAS_ZLIB
+			if (file.IsMapped() && file.GetView().starts_with("\x1F\x8B"))
+			{
+				SearchDecompressedFile<GzipDecoder>(filename, file.GetView(), matcher, results, control, pCounters);
+				return;
+			}
+#endif
+
+#ifdef RDW_SS_HAS_ZSTD
+			if (file.IsMapped() && file.GetView().starts_with("\x28\xB5\x2F\xFD"))
+			{
+				SearchDecompressedFile<ZstdDecoder>(filename, file.GetView(), matcher, results, control, pCounters);
+				return;
+			}
+#endif
+
+			SearchFileContents(filename, file, matcher, results, control, pCounters);
+		}
+
+		/// <summary>
+		/// Opens a single file and searches it, files that can not be opened are reported and skipped
+		/// Returns whether the file could be opened
+		/// </summary>
+		template<typename Matcher>
+		bool SearchFileForString(
+			const std::string& filename,
+			const Matcher& matcher,
+			std::vector<FileSearchResult>& results,
+			SearchControl& control,
+			SearchCounters* pCounters = nullptr)
+		{
+			const uint64_t openStart{ IsMeasuringPhases(pCounters) ? GetNanoseconds() : 0 };
+			MappedFile file{ filename };
+			if (IsMeasuringPhases(pCounters)) pCounters->OpenTime += GetNanoseconds() - openStart;
+
+			if (!file.IsOpen())
+			{
+				if (pCounters) ++pCounters->NrOfOpenFailures;
+
+				PrintMessage("Could not open file: ", filename);
+				return false;
+			}
+
+			SearchOpenedFile(filename, file, matcher, results, control, pCounters);
+			return true;
+		}
+
+		/// <summary>
+		/// Searches the given files one after another on the calling thread
+		/// </summary>
+		template<typename Matcher>
+		void SearchFilesForString(
+			const std::vector<std::string>& filesToLookThrough,
+			const Matcher& matcher,
+			std::vector<FileSearchResult>& results,
+			SearchControl& control)
+		{
+			for (const std::string& filename : filesToLookThrough)
+			{
+				SearchFileForString(filename, matcher, results, control);
+			}
+		}
+
+#ifdef _WIN32
+		inline static constexpr char PathSeparator{ '\\' };
+#else
+		inline static constexpr char PathSeparator{ '/' };
+#endif
+
+		/// <summary>
+		/// A directory or file name stored in a PathArena, the full path is the chain of names up to the root, whose name is the root directory itself
+		/// </summary>
+		struct PathNode final
+		{
+			const PathNode* pParent;
+			std::string_view Name; // followed by a '\0' in the arena, so it can be passed to the OS as it is
+		};
+
+		/// <summary>
+		/// Builds the full path into path, reusing its memory
+		/// </summary>
+		inline void BuildPath(const PathNode* pNode, std::string& path)
+		{
+			if (!pNode->pParent)
+			{
+				path.assign(pNode->Name);
+				return;
+			}
+
+			BuildPath(pNode->pParent, path);
+			path += PathSeparator;
+			path += pNode->Name;
+		}
+
+		/// <summary>
+		/// Append-only storage for the names found while walking a directory tree, so a found file costs no allocation of its own
+		/// Nothing is freed before the arena itself. Every walker stores through a Writer of its own, only taking a new block takes the lock
+		/// </summary>
+		class PathArena final
+		{
+		public:
+			class Writer final
+			{
+			public:
+				explicit Writer(PathArena& arena)
+					: m_Arena{ arena }
+					, m_pCurrent{}
+					, m_pEnd{}
+				{}
+
+				Writer(const Writer&) noexcept = delete;
+				Writer(Writer&&) noexcept = delete;
+				Writer& operator=(const Writer&) noexcept = delete;
+				Writer& operator=(Writer&&) noexcept = delete;
+
+				[[nodiscard]] std::string_view StoreName(const std::string_view name)
+				{
+					char* pName{ Allocate(name.size() + 1, 1) };
+					std::memcpy(pName, name.data(), name.size());
+					pName[name.size()] = '\0';
+
+					return std::string_view{ pName, name.size() };
+				}
+
+				[[nodiscard]] const PathNode* StoreNode(const PathNode* pParent, const std::string_view name)
+				{
+					PathNode* pNode{ reinterpret_cast<PathNode*>(Allocate(sizeof(PathNode), alignof(PathNode))) };
+					return new (pNode) PathNode{ pParent, StoreName(name) };
+				}
+
+			private:
+				char* Allocate(const size_t size, const size_t alignment)
+				{
+					const size_t padding{ (alignment - reinterpret_cast<uintptr_t>(m_pCurrent) % alignment) % alignment };
+
+					if (static_cast<size_t>(m_pEnd - m_pCurrent) < padding + size)
+					{
+						// a name longer than a block gets a block of its own
+						const size_t blockSize{ std::max(BlockSize, size + alignment) };
+						m_pCurrent = m_Arena.AllocateBlock(blockSize);
+						m_pEnd = m_pCurrent + blockSize;
+
+						return Allocate(size, alignment);
+					}
+
+					char* pMemory{ m_pCurrent + padding };
+					m_pCurrent = pMemory + size;
+
+					return pMemory;
+				}
+
+				PathArena& m_Arena;
+				char* m_pCurrent;
+				char* m_pEnd;
+			};
+
+			PathArena()
+				: m_Mutex{}
+				, m_Blocks{}
+			{}
+
+			PathArena(const PathArena&) noexcept = delete;
+			PathArena(PathArena&&) noexcept = delete;
+			PathArena& operator=(const PathArena&) noexcept = delete;
+			PathArena& operator=(PathArena&&) noexcept = delete;
+
+		private:
+			inline static constexpr size_t BlockSize{ 64 * 1024 };
+
+			char* AllocateBlock(const size_t size)
+			{
+				const std::scoped_lock<std::mutex> lock{ m_Mutex };
+
+				m_Blocks.push_back(std::make_unique_for_overwrite<char[]>(size));
+				return m_Blocks.back().get();
+			}
+
+			std::mutex m_Mutex;
+			std::vector<std::unique_ptr<char[]>> m_Blocks;
+		};
+
+		/// <summary>
+		/// A file found by the directory walkers, its name lives in the walkers' PathArena
+		/// </summary>
+		struct FileEntry final
+		{
+			const PathNode* pDirectory;
+			std::string_view Name;
+			uint64_t Size; // 0 if it could not be read
+			ReadBuffer Contents; // only open when the file was read ahead, see FileReader
+		};
+
+		inline void BuildPath(const FileEntry& file, std::string& path)
+		{
+			BuildPath(file.pDirectory, path);
+			path += PathSeparator;
+			path += file.Name;
+		}
+
+		/// <summary>
+		/// Multi-producer multi-consumer FIFO with a fixed capacity
+		/// Push() blocks while the queue is full, Pop() blocks until an item arrives or the queue is closed and drained
+		/// </summary>
+		template<typename T>
+		class BoundedQueue final
+		{
+		public:
+			explicit BoundedQueue(const size_t capacity)
+				: m_Mutex{}
+				, m_NotEmpty{}
+				, m_NotFull{}
+				, m_Items{}
+				, m_Capacity{ capacity }
+				, m_IsClosed{}
+			{}
+
+			BoundedQueue(const BoundedQueue&) noexcept = delete;
+			BoundedQueue(BoundedQueue&&) noexcept = delete;
+			BoundedQueue& operator=(const BoundedQueue&) noexcept = delete;
+			BoundedQueue& operator=(BoundedQueue&&) noexcept = delete;
+
+			/// <summary>
+			/// Returns false if the queue was closed, in which case the item is discarded
+			/// With isFirst the item is popped before everything that is already waiting
+			/// </summary>
+			bool Push(T item, const bool isFirst = false)
+			{
+				std::unique_lock<std::mutex> lock{ m_Mutex };
+				m_NotFull.wait(lock, [this]() { return m_Items.size() < m_Capacity || m_IsClosed; });
+
+				if (m_IsClosed) return false;
+
+				if (isFirst) m_Items.push_front(std::move(item));
+				else m_Items.push_back(std::move(item));
+				lock.unlock();
+
+				m_NotEmpty.notify_one();
+				return true;
+			}
+
+			/// <summary>
+			/// Returns false once the queue is closed and every item has been popped
+			/// </summary>
+			bool Pop(T& item)
+			{
+				std::unique_lock<std::mutex> lock{ m_Mutex };
+				m_NotEmpty.wait(lock, [this]() { return !m_Items.empty() || m_IsClosed; });
+
+				if (m_Items.empty()) return false;
+
+				item = std::move(m_Items.front());
+				m_Items.pop_front();
+				lock.unlock();
+
+				m_NotFull.notify_one();
+				return true;
+			}
+
+			/// <summary>
+			/// Returns false instead of blocking while the queue is empty
+			/// </summary>
+			bool TryPop(T& item)
+			{
+				std::unique_lock<std::mutex> lock{ m_Mutex };
+				if (m_Items.empty()) return false;
+
+				item = std::move(m_Items.front());
+				m_Items.pop_front();
+				lock.unlock();
+
+				m_NotFull.notify_one();
+				return true;
+			}
+
+			void Close()
+			{
+				{
+					const std::scoped_lock<std::mutex> lock{ m_Mutex };
+					m_IsClosed = true;
+				}
+
+				m_NotEmpty.notify_all();
+				m_NotFull.notify_all();
+			}
+
+		private:
+			std::mutex m_Mutex;
+			std::condition_variable m_NotEmpty;
+			std::condition_variable m_NotFull;
+			std::deque<T> m_Items;
+			const size_t m_Capacity;
+			bool m_IsClosed;
+		};
+
+		/// <summary>
+		/// Number of files the directory walkers may run ahead of the search threads
+		/// </summary>
+		inline static constexpr size_t FileQueueCapacity{ 4096 };
+
+		using FileQueue = BoundedQueue<FileEntry>;
+
+		/// <summary>
+		/// Pop() and Push() that count the time spent blocked on the queue, or waiting for its lock, as waiting time
+		/// </summary>
+		template<typename T>
+		bool TimedPop(BoundedQueue<T>& queue, T& item, SearchCounters* pCounters)
+		{
+			const ScopedTimer timer{ pCounters, &SearchCounters::WaitTime };
+			return queue.Pop(item);
+		}
+
+		template<typename T>
+		bool TimedPush(BoundedQueue<T>& queue, T item, SearchCounters* pCounters, const bool isFirst = false)
+		{
+			const ScopedTimer timer{ pCounters, &SearchCounters::WaitTime };
+			return queue.Push(std::move(item), isFirst);
+		}
+
+		/// <summary>
+		/// Files of at least this size skip ahead of the files waiting in the file queue, so a big file that is found late still gets started
+		/// early and the small files fill up the gaps at the end. Smaller files are searched in the order they were found in
+		/// </summary>
+		inline static constexpr uint64_t LargeFileSize{ 4 * 1024 * 1024 };
+
+		inline bool IsLargeFile(const FileEntry& file)
+		{
+			return file.Size >= LargeFileSize;
+		}
+
+		/// <summary>
+		/// Searches a file popped from a file queue, a file that was read ahead gives its buffer back as soon as it has been searched
+		/// The path is built into path, so a thread searching many files keeps reusing the same memory for it
+		/// Once the search was stopped the files still in the queue are only drained, so the walkers never block on a full queue
+		/// </summary>
+		template<typename Matcher>
+		void SearchQueuedFile(
+			FileEntry& file,
+			std::string& path,
+			const Matcher& matcher,
+			std::vector<FileSearchResult>& results,
+			SearchControl& control,
+			SearchCounters* pCounters)
+		{
+			if (control.IsSearchStopped())
+			{
+				file.Contents = ReadBuffer{};
+				return;
+			}
+
+			BuildPath(file, path);
+
+			if (!file.Contents.IsOpen())
+			{
+				SearchFileForString(path, matcher, results, control, pCounters);
+				return;
+			}
+
+			SearchOpenedFile(path, file.Contents, matcher, results, control, pCounters);
+			file.Contents = ReadBuffer{};
+		}
+
+		template<typename Matcher>
+		void SearchQueuedFilesForString(
+			FileQueue& queue,
+			const Matcher& matcher,
+			std::vector<FileSearchResult>& results,
+			SearchControl& control,
+			SearchCounters* pCounters)
+		{
+			FileEntry file{};
+			std::string path{};
+			while (TimedPop(queue, file, pCounters))
+			{
+				SearchQueuedFile(file, path, matcher, results, control, pCounters);
+			}
+		}
+
+		/// <summary>
+		/// All results of one file, numbered in the order the files were picked up by the search threads
+		/// </summary>
+		struct FileResults final
+		{
+			uint64_t SequenceNumber;
+			std::vector<FileSearchResult> Results;
+		};
+
+		/// <summary>
+		/// Number of searched files that may wait for the writer, the search threads block once it is reached
+		/// </summary>
+		inline static constexpr size_t ResultQueueCapacity{ 1024 };
+
+		using ResultQueue = BoundedQueue<FileResults>;
+
+		/// <summary>
+		/// Hands every finished file's results to the callback, from a single thread so the callback needs no locking
+		/// With a reorder window, results are passed on in the order the files were picked up. A file that is still being
+		/// searched holds back at most reorderWindow files that finished after it, then it is skipped over so memory stays bounded
+		/// </summary>
+		class ResultWriter final
+		{
+		public:
+			ResultWriter(ResultQueue& queue, const ResultCallback& onResult, const size_t reorderWindow, SearchCounters* pCounters)
+				: m_Queue{ queue }
+				, m_OnResult{ onResult }
+				, m_ReorderWindow{ reorderWindow }
+				, m_PendingResults{}
+				, m_NextSequenceNumber{}
+				, m_pCounters{ pCounters }
+			{}
+
+			ResultWriter(const ResultWriter&) noexcept = delete;
+			ResultWriter(ResultWriter&&) noexcept = delete;
+			ResultWriter& operator=(const ResultWriter&) noexcept = delete;
+			ResultWriter& operator=(ResultWriter&&) noexcept = delete;
+
+			[[nodiscard]] bool IsOrdered() const { return m_ReorderWindow > 0; }
+
+			void Run()
+			{
+				FileResults fileResults{};
+				while (m_Queue.Pop(fileResults))
+				{
+					if (!IsOrdered())
+					{
+						Write(fileResults.Results);
+						continue;
+					}
+
+					m_PendingResults.emplace(fileResults.SequenceNumber, std::move(fileResults.Results));
+					WritePendingResults(m_ReorderWindow);
+				}
+
+				WritePendingResults(0);
+			}
+
+		private:
+			void Write(std::vector<FileSearchResult>& results)
+			{
+				const ScopedTimer timer{ m_pCounters, &SearchCounters::OutputTime };
+
+				for (FileSearchResult& result : results)
+				{
+					m_OnResult(std::move(result));
+				}
+			}
+
+			/// <summary>
+			/// Writes every result that is next in line, and skips ahead while more than maxNrOfPendingFiles are waiting
+			/// A file that was skipped over is written as soon as it arrives, it no longer holds anything back
+			/// </summary>
+			void WritePendingResults(const size_t maxNrOfPendingFiles)
+			{
+				while (!m_PendingResults.empty())
+				{
+					const auto it{ m_PendingResults.begin() };
+					if (it->first > m_NextSequenceNumber && m_PendingResults.size() <= maxNrOfPendingFiles) return;
+
+					Write(it->second);
+
+					m_NextSequenceNumber = std::max(m_NextSequenceNumber, it->first + 1);
+					m_PendingResults.erase(it);
+				}
+			}
+
+			ResultQueue& m_Queue;
+			const ResultCallback& m_OnResult;
+			const size_t m_ReorderWindow;
+			std::map<uint64_t, std::vector<FileSearchResult>> m_PendingResults;
+			uint64_t m_NextSequenceNumber;
+			SearchCounters* m_pCounters;
+		};
+
+		/// <summary>
+		/// Sends the results of every file to the writer. Files without results are only sent when the writer keeps them in order,
+		/// it needs every sequence number to know which file is next
+		/// </summary>
+		template<typename Matcher>
+		void StreamQueuedFilesForString(
+			FileQueue& queue,
+			const Matcher& matcher,
+			ResultQueue& resultQueue,
+			std::atomic<uint64_t>& nextSequenceNumber,
+			const bool sendEmptyResults,
+			SearchControl& control,
+			SearchCounters* pCounters)
+		{
+			FileEntry file{};
+			std::string path{};
+			while (TimedPop(queue, file, pCounters))
+			{
+				const uint64_t sequenceNumber{ nextSequenceNumber++ };
+
+				std::vector<FileSearchResult> results{};
+				SearchQueuedFile(file, path, matcher, results, control, pCounters);
+
+				if (!results.empty() || sendEmptyResults)
+				{
+					TimedPush(resultQueue, FileResults{ sequenceNumber, std::move(results) }, pCounters);
+				}
+			}
+		}
+
+		/// <summary>
+		/// A glob compiled once into tokens, so matching a name does not parse it again
+		/// * and ? match anything but a '/', ** matches across directories, and a "**/" also matches no directory at all
+		/// [abc], [a-z] and [!abc] match one character, an unterminated '[' is taken literally. A '\' takes the next character literally
+		/// </summary>
+		class Glob final
+		{
+		public:
+			explicit Glob(const std::string_view glob)
+				: m_Tokens{}
+				, m_Classes{}
+				, m_Kind{}
+				, m_HasSeparator{ glob.find('/') != std::string_view::npos }
+			{
+				for (size_t i{}; i < glob.size(); ++i)
+				{
+					const char c{ glob[i] };
+
+					if (c == '*')
+					{
+						const size_t start{ i };
+						while (i + 1 < glob.size() && glob[i + 1] == '*') ++i;
+
+						// ** only crosses directories when it is a whole path component, otherwise it is a *
+						const bool isWholeComponent{ (start == 0 || glob[start - 1] == '/') && (i + 1 == glob.size() || glob[i + 1] == '/') };
+
+						if (i == start || !isWholeComponent)
+						{
+							if (m_Tokens.empty() || m_Tokens.back().Type != TokenType::Star) m_Tokens.push_back(Token{ TokenType::Star, {}, {} });
+						}
+						else if (i + 1 == glob.size())
+						{
+							m_Tokens.push_back(Token{ TokenType::AnyPath, {}, {} });
+						}
+						else
+						{
+							m_Tokens.push_back(Token{ TokenType::AnyDirectories, {}, {} });
+							++i;
+						}
+					}
+					else if (c == '?')
+					{
+						m_Tokens.push_back(Token{ TokenType::AnyCharacter, {}, {} });
+					}
+					else if (c == '[' && ParseClass(glob, i))
+					{
+						m_Tokens.push_back(Token{ TokenType::CharacterClass, {}, m_Classes.size() - 1 });
+					}
+					else
+					{
+						if (c == '\\' && i + 1 < glob.size()) ++i;
+
+						if (m_Tokens.empty() || m_Tokens.back().Type != TokenType::Literal) m_Tokens.push_back(Token{ TokenType::Literal, {}, {} });
+						m_Tokens.back().Literal += glob[i];
+					}
+				}
+
+				m_Kind = GetKind();
+			}
+
+			[[nodiscard]] bool IsMatch(const std::string_view text) const
+			{
+				switch (m_Kind)
+				{
+				case Kind::Everything:
+					return true;
+				case Kind::Exact:
+					return text == m_Tokens.front().Literal;
+				case Kind::Prefix:
+					return text.starts_with(m_Tokens.front().Literal);
+				case Kind::Suffix:
+					return text.ends_with(m_Tokens.back().Literal);
+				default:
+					return Match(0, text) == MatchResult::Match;
+				}
+			}
+
+			/// <summary>
+			/// A glob with a '/' is matched against a path, one without against a name
+			/// </summary>
+			[[nodiscard]] bool HasSeparator() const { return m_HasSeparator; }
+
+		private:
+			enum class TokenType : uint8_t
+			{
+				Literal,
+				AnyCharacter,
+				CharacterClass,
+				Star,
+				AnyDirectories, // "**/"
+				AnyPath, // a trailing "**"
+			};
+
+			struct Token final
+			{
+				TokenType Type;
+				std::string Literal;
+				size_t ClassIndex;
+			};
+
+			/// <summary>
+			/// Most globs are a literal with at most one *, they are matched without walking the tokens
+			/// </summary>
+			enum class Kind : uint8_t
+			{
+				Everything,
+				Exact,
+				Prefix,
+				Suffix,
+				General,
+			};
+
+			/// <summary>
+			/// Abort stops the whole match once the text ran out, no other split of an earlier * can do better
+			/// AbortToAnyPath stops at the closest **, since a * would have to cross the same '/'
+			/// </summary>
+			enum class MatchResult : uint8_t
+			{
+				Match,
+				NoMatch,
+				AbortToAnyPath,
+				Abort,
+			};
+
+			bool ParseClass(const std::string_view glob, size_t& i)
+			{
+				std::bitset<256> characters{};
+
+				size_t j{ i + 1 };
+				const bool isNegated{ j < glob.size() && (glob[j] == '!' || glob[j] == '^') };
+				if (isNegated) ++j;
+
+				// a ']' right after the '[' is part of the class
+				for (const size_t first{ j }; j < glob.size() && (glob[j] != ']' || j == first); ++j)
+				{
+					if (glob[j] == '\\' && j + 1 < glob.size()) ++j;
+
+					unsigned char from{ static_cast<unsigned char>(glob[j]) }, to{ from };
+					if (j + 2 < glob.size() && glob[j + 1] == '-' && glob[j + 2] != ']')
+					{
+						to = static_cast<unsigned char>(glob[j + 2]);
+						j += 2;
+					}
+
+					for (unsigned int character{ from }; character <= to; ++character)
+					{
+						characters.set(character);
+					}
+				}
+
+				if (j >= glob.size()) return false;
+
+				if (isNegated) characters.flip();
+				characters.reset('/');
+
+				m_Classes.push_back(characters);
+				i = j;
+
+				return true;
+			}
+
+			Kind GetKind() const
+			{
+				const auto isType{ [this](const size_t index, const TokenType type)->bool { return m_Tokens[index].Type == type; } };
+
+				if (m_Tokens.size() == 1 && isType(0, TokenType::AnyPath)) return Kind::Everything;
+				if (m_Tokens.size() == 1 && isType(0, TokenType::Literal)) return Kind::Exact;
+
+				// a name has no '/' for the * to stop at
+				if (m_HasSeparator) return Kind::General;
+
+				if (m_Tokens.size() == 1 && isType(0, TokenType::Star)) return Kind::Everything;
+				if (m_Tokens.size() == 2 && isType(0, TokenType::Literal) && isType(1, TokenType::Star)) return Kind::Prefix;
+				if (m_Tokens.size() == 2 && isType(0, TokenType::Star) && isType(1, TokenType::Literal)) return Kind::Suffix;
+
+				return Kind::General;
+			}
+
+			MatchResult Match(size_t tokenIndex, std::string_view text) const
+			{
+				for (; tokenIndex < m_Tokens.size(); ++tokenIndex)
+				{
+					const Token& token{ m_Tokens[tokenIndex] };
+
+					switch (token.Type)
+					{
+					case TokenType::Literal:
+						if (!text.starts_with(token.Literal)) return MatchResult::NoMatch;
+
+						text.remove_prefix(token.Literal.size());
+						break;
+					case TokenType::AnyCharacter:
+						if (text.empty() || text.front() == '/') return MatchResult::NoMatch;
+
+						text.remove_prefix(1);
+						break;
+					case TokenType::CharacterClass:
+						if (text.empty() || !m_Classes[token.ClassIndex].test(static_cast<unsigned char>(text.front()))) return MatchResult::NoMatch;
+
+						text.remove_prefix(1);
+						break;
+					default:
+						return MatchStar(tokenIndex, text);
+					}
+				}
+
+				return text.empty() ? MatchResult::Match : MatchResult::NoMatch;
+			}
+
+			MatchResult MatchStar(const size_t tokenIndex, const std::string_view text) const
+			{
+				const TokenType type{ m_Tokens[tokenIndex].Type };
+				const bool isStar{ type == TokenType::Star };
+
+				if (tokenIndex + 1 == m_Tokens.size())
+				{
+					if (type == TokenType::AnyDirectories) return text.empty() || text.ends_with('/') ? MatchResult::Match : MatchResult::NoMatch;
+					if (!isStar || text.find('/') == std::string_view::npos) return MatchResult::Match;
+
+					return MatchResult::AbortToAnyPath;
+				}
+
+				const Token& next{ m_Tokens[tokenIndex + 1] };
+
+				for (size_t i{}; ; ++i)
+				{
+					// skip straight to where the next literal could match
+					if (next.Type == TokenType::Literal && type != TokenType::AnyDirectories)
+					{
+						const size_t nextLiteral{ text.find(next.Literal, i) };
+						if (nextLiteral == std::string_view::npos) return MatchResult::Abort;
+
+						if (isStar && text.substr(i, nextLiteral - i).find('/') != std::string_view::npos) return MatchResult::AbortToAnyPath;
+						i = nextLiteral;
+					}
+
+					// "**/" only ends right after a '/'
+					if (type != TokenType::AnyDirectories || i == 0 || text[i - 1] == '/')
+					{
+						const MatchResult result{ Match(tokenIndex + 1, text.substr(i)) };
+
+						if (result == MatchResult::Match || result == MatchResult::Abort) return result;
+						if (result == MatchResult::AbortToAnyPath && isStar) return result;
+					}
+
+					if (i == text.size()) return MatchResult::Abort;
+					if (isStar && text[i] == '/') return MatchResult::AbortToAnyPath;
+				}
+			}
+
+			std::vector<Token> m_Tokens;
+			std::vector<std::bitset<256>> m_Classes;
+			Kind m_Kind;
+			bool m_HasSeparator;
+		};
+
+		/// <summary>
+		/// Builds the path of pNode relative to pAncestor into path, separated by '/' on every platform, so globs can match it
+		/// A null pAncestor is the root of the walk
+		/// </summary>
+		inline void BuildRelativePath(const PathNode* pNode, const PathNode* pAncestor, std::string& path)
+		{
+			if (pNode == pAncestor || !pNode->pParent)
+			{
+				path.clear();
+				return;
+			}
+
+			BuildRelativePath(pNode->pParent, pAncestor, path);
+			if (!path.empty()) path += '/';
+			path += pNode->Name;
+		}
+
+		inline static constexpr std::array<std::string_view, 2> IgnoreFileNames{ ".gitignore", ".ignore" };
+
+		inline bool IsIgnoreFileName(const std::string_view name)
+		{
+			return std::find(IgnoreFileNames.cbegin(), IgnoreFileNames.cend(), name) != IgnoreFileNames.cend();
+		}
+
+		/// <summary>
+		/// The rules of the .gitignore and .ignore files of one directory, they apply to the directory and everything below it
+		/// The files of a directory are checked before those of its parents, and within them the last rule that matches decides, like git does
+		/// </summary>
+		class IgnoreFile final
+		{
+		public:
+			IgnoreFile(std::shared_ptr<const IgnoreFile> pParent, const PathNode* pDirectory)
+				: m_pParent{ std::move(pParent) }
+				, m_pDirectory{ pDirectory }
+				, m_Rules{}
+			{}
+
+			IgnoreFile(const IgnoreFile&) noexcept = delete;
+			IgnoreFile(IgnoreFile&&) noexcept = delete;
+			IgnoreFile& operator=(const IgnoreFile&) noexcept = delete;
+			IgnoreFile& operator=(IgnoreFile&&) noexcept = delete;
+
+			void AddRules(const std::string_view contents)
+			{
+				size_t lineStart{};
+
+				while (lineStart < contents.size())
+				{
+					size_t lineEnd{ contents.find('\n', lineStart) };
+					if (lineEnd == std::string_view::npos) lineEnd = contents.size();
+
+					AddRule(contents.substr(lineStart, lineEnd - lineStart));
+					lineStart = lineEnd + 1;
+				}
+			}
+
+			/// <summary>
+			/// name is an entry of pDirectory, which is this file's directory or one below it. path is only scratch memory
+			/// </summary>
+			[[nodiscard]] bool IsIgnored(const PathNode* pDirectory, const std::string_view name, const bool isDirectory, std::string& path) const
+			{
+				for (const IgnoreFile* pFile{ this }; pFile; pFile = pFile->m_pParent.get())
+				{
+					bool isPathBuilt{};
+
+					for (auto it{ pFile->m_Rules.crbegin() }; it != pFile->m_Rules.crend(); ++it)
+					{
+						if (it->IsDirectoryOnly && !isDirectory) continue;
+
+						if (it->IsAnchored && !std::exchange(isPathBuilt, true))
+						{
+							BuildRelativePath(pDirectory, pFile->m_pDirectory, path);
+							if (!path.empty()) path += '/';
+							path += name;
+						}
+
+						if (it->Pattern.IsMatch(it->IsAnchored ? std::string_view{ path } : name)) return !it->IsNegated;
+					}
+				}
+
+				return false;
+			}
+
+		private:
+			struct Rule final
+			{
+				Glob Pattern;
+				bool IsNegated;
+				bool IsDirectoryOnly;
+				bool IsAnchored; // matched against the path relative to the ignore file, instead of against the name
+			};
+
+			void AddRule(std::string_view line)
+			{
+				if (line.ends_with('\r')) line.remove_suffix(1);
+				while (line.ends_with(' ') && !line.ends_with("\\ ")) line.remove_suffix(1);
+
+				if (line.empty() || line.front() == '#') return;
+
+				const bool isNegated{ line.front() == '!' };
+				if (isNegated) line.remove_prefix(1);
+
+				const bool isDirectoryOnly{ line.ends_with('/') };
+				if (isDirectoryOnly) line.remove_suffix(1);
+
+				// a '/' anywhere but at the end ties the rule to this directory
+				const bool isAnchored{ line.find('/') != std::string_view::npos };
+				if (line.starts_with('/')) line.remove_prefix(1);
+
+				if (line.empty()) return;
+
+				m_Rules.push_back(Rule{ Glob{ line }, isNegated, isDirectoryOnly, isAnchored });
+			}
+
+			const std::shared_ptr<const IgnoreFile> m_pParent;
+			const PathNode* const m_pDirectory;
+			std::vector<Rule> m_Rules;
+		};
+	}
+
+	/// <summary>
+	/// Decides which files a recursive search looks at, its globs are compiled once when it is constructed
+	/// The mask holds globs separated by ';', a glob starting with '!' excludes what it matches, e.g. "*.cpp;*.h;!*_test.cpp"
+	/// A glob without a '/' is matched against names, one with a '/' against the path relative to the searched directory
+	/// Excluded directories are never listed, neither are the directories ignored by the .gitignore and .ignore files found while walking
+	/// The ignore files above the searched directory are not read, and .git directories are skipped along with them
+	/// </summary>
+	class FileMask final
+	{
+	public:
+		// not explicit, so every search function can still be given its mask as a string
+		FileMask(const std::string& mask, const bool useIgnoreFiles = true)
+			: m_Includes{}
+			, m_Excludes{}
+			, m_UsesIgnoreFiles{ useIgnoreFiles }
+			, m_IsPathNeeded{}
+		{
+			std::string_view globs{ mask };
+
+			while (!globs.empty())
+			{
+				const size_t end{ std::min(globs.find(';'), globs.size()) };
+				std::string_view glob{ globs.substr(0, end) };
+				globs.remove_prefix(std::min(end + 1, globs.size()));
+
+				const bool isExcluded{ glob.starts_with('!') };
+				if (isExcluded) glob.remove_prefix(1);
+				if (glob.starts_with('/')) glob.remove_prefix(1);
+
+				if (glob.empty()) continue;
+
+				(isExcluded ? m_Excludes : m_Includes).emplace_back(glob);
+				m_IsPathNeeded |= (isExcluded ? m_Excludes : m_Includes).back().HasSeparator();
+			}
+		}
+
+		FileMask(const char* pMask)
+			: FileMask{ std::string{ pMask } }
+		{}
+
+		/// <summary>
+		/// relativePath is only looked at when IsPathNeeded()
+		/// </summary>
+		[[nodiscard]] bool IsFileIncluded(const std::string_view name, const std::string_view relativePath) const
+		{
+			if (!m_Includes.empty() && !IsAnyMatch(m_Includes, name, relativePath)) return false;
+
+			return !IsAnyMatch(m_Excludes, name, relativePath);
+		}
+
+		[[nodiscard]] bool IsDirectoryExcluded(const std::string_view name, const std::string_view relativePath) const
+		{
+			return IsAnyMatch(m_Excludes, name, relativePath);
+		}
+
+		/// <summary>
+		/// Checks every directory on relativePath as well as the file itself, for files that were not found by walking
+		/// </summary>
+		[[nodiscard]] bool IsPathIncluded(const std::string_view relativePath) const
+		{
+			if (!m_Excludes.empty())
+			{
+				for (size_t separator{ relativePath.find('/') }; separator != std::string_view::npos; separator = relativePath.find('/', separator + 1))
+				{
+					const std::string_view directory{ relativePath.substr(0, separator) };
+					const size_t nameStart{ directory.rfind('/') };
+
+					if (IsDirectoryExcluded(nameStart == std::string_view::npos ? directory : directory.substr(nameStart + 1), directory)) return false;
+				}
+			}
+
+			const size_t nameStart{ relativePath.rfind('/') };
+			return IsFileIncluded(nameStart == std::string_view::npos ? relativePath : relativePath.substr(nameStart + 1), relativePath);
+		}
+
+		[[nodiscard]] bool HasGlobs() const { return !m_Includes.empty() || !m_Excludes.empty(); }
+		[[nodiscard]] bool UsesIgnoreFiles() const { return m_UsesIgnoreFiles; }
+		[[nodiscard]] bool IsPathNeeded() const { return m_IsPathNeeded; }
+
+	private:
+		static bool IsAnyMatch(const std::vector<Detail::Glob>& globs, const std::string_view name, const std::string_view relativePath)
+		{
+			return std::any_of(globs.cbegin(), globs.cend(), [name, relativePath](const Detail::Glob& glob)->bool
+				{
+					return glob.IsMatch(glob.HasSeparator() ? relativePath : name);
+				});
+		}
+
+		std::vector<Detail::Glob> m_Includes;
+		std::vector<Detail::Glob> m_Excludes;
+		bool m_UsesIgnoreFiles;
+		bool m_IsPathNeeded;
+	};
+
+	namespace Detail
+	{
+
+#ifndef _WIN32
+
+		/// <summary>
+		/// Owning wrapper around an open directory descriptor
+		/// Subdirectories keep their parent's descriptor alive, so they can be opened relative to it with openat()
+		/// </summary>
+		class DirectoryDescriptor final
+		{
+		public:
+			explicit DirectoryDescriptor(const int fileDescriptor)
+				: m_FileDescriptor{ fileDescriptor }
+			{}
+
+			~DirectoryDescriptor()
+			{
+				close(m_FileDescriptor);
+			}
+
+			DirectoryDescriptor(const DirectoryDescriptor&) noexcept = delete;
+			DirectoryDescriptor(DirectoryDescriptor&&) noexcept = delete;
+			DirectoryDescriptor& operator=(const DirectoryDescriptor&) noexcept = delete;
+			DirectoryDescriptor& operator=(DirectoryDescriptor&&) noexcept = delete;
+
+			[[nodiscard]] int Get() const { return m_FileDescriptor; }
+
+		private:
+			const int m_FileDescriptor;
+		};
+#endif
+
+		/// <summary>
+		/// A directory that still has to be listed
+		/// </summary>
+		struct DirectoryEntry final
+		{
+			const PathNode* pNode; // only set once the directory is going to be listed
+			uint32_t Depth;
+#ifndef _WIN32
+			std::shared_ptr<const DirectoryDescriptor> pParent;
+#endif
+			std::shared_ptr<const IgnoreFile> pIgnoreFile; // the rules of the ignore files above it, null if there are none
+		};
+
+		inline DirectoryEntry MakeRootDirectoryEntry(PathArena::Writer& paths, const std::string& rootDir)
+		{
+#ifdef _WIN32
+			return DirectoryEntry{ paths.StoreNode(nullptr, rootDir), 0, {} };
+#else
+			return DirectoryEntry{ paths.StoreNode(nullptr, rootDir), 0, nullptr, {} };
+#endif
+		}
+
+		inline bool ShouldDirectoryBeConsidered(const uint32_t depth, const uint32_t recursiveDepth)
+		{
+			if (recursiveDepth == 0) return true;
+
+			return depth <= recursiveDepth;
+		}
+
+#ifdef _WIN32
+		/// <summary>
+		/// Calls callback(name, fileSize) for every file and callback(name, subdirectory) for every directory in directory, except for "." and ".."
+		/// The listing holds the file sizes, so they are reported whether or not AreFileSizesNeeded
+		/// Returns false if the directory could not be opened
+		/// </summary>
+		template<bool AreFileSizesNeeded, typename Callback>
+		bool ListDirectory(const DirectoryEntry& directory, Callback&& callback)
+		{
+			WIN32_FIND_DATAA findFileData;
+
+			std::string rootWildcard{};
+			BuildPath(directory.pNode, rootWildcard);
+			rootWildcard += "\\*";
+			HANDLE fileHandle{ FindFirstFileA(rootWildcard.c_str(), &findFileData) };
+			if (fileHandle == INVALID_HANDLE_VALUE) return false;
+
+			do
+			{
+				if (strcmp(findFileData.cFileName, ".") == 0 ||
+					strcmp(findFileData.cFileName, "..") == 0)
+				{
+					continue;
+				}
+
+				const bool isDirectory{ (findFileData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0 };
+				const uint64_t fileSize{ (static_cast<uint64_t>(findFileData.nFileSizeHigh) << 32) | findFileData.nFileSizeLow };
+
+				if (isDirectory)
+				{
+					callback(std::string_view{ findFileData.cFileName }, DirectoryEntry{ nullptr, directory.Depth + 1, {} });
+				}
+				else
+				{
+					callback(std::string_view{ findFileData.cFileName }, fileSize);
+				}
+			} while (FindNextFileA(fileHandle, &findFileData) != 0);
+
+			FindClose(fileHandle);
+
+			return true;
+		}
+#else
+		inline int OpenDirectory(const DirectoryEntry& directory)
+		{
+			constexpr int flags{ O_RDONLY | O_DIRECTORY | O_CLOEXEC | O_NOFOLLOW };
+
+			if (directory.pParent)
+			{
+				const int fileDescriptor{ openat(directory.pParent->Get(), directory.pNode->Name.data(), flags) };
+
+				// out of descriptors, so fall back to the full path
+				if (fileDescriptor != -1 || (errno != EMFILE && errno != ENFILE)) return fileDescriptor;
+			}
+
+			std::string path{};
+			BuildPath(directory.pNode, path);
+
+			return open(path.c_str(), flags);
+		}
+
+		/// <summary>
+		/// Resolves entries for which the file system did not report a type, and symbolic links
+		/// Symbolic links to files are searched, symbolic links to directories are not followed to avoid cycles
+		/// </summary>
+		inline unsigned char GetEntryType(const int directoryDescriptor, const char* pName, const unsigned char type)
+		{
+			if (type != DT_UNKNOWN && type != DT_LNK) return type;
+
+			struct stat fileStat {};
+			if (fstatat(directoryDescriptor, pName, &fileStat, type == DT_LNK ? 0 : AT_SYMLINK_NOFOLLOW) != 0) return DT_UNKNOWN;
+
+			if (S_ISREG(fileStat.st_mode)) return DT_REG;
+			if (S_ISDIR(fileStat.st_mode)) return type == DT_LNK ? DT_LNK : DT_DIR;
+
+			return DT_UNKNOWN;
+		}
+
+		/// <summary>
+		/// Returns the size of a file in an open directory, following symbolic links, 0 if it can not be read
+		/// </summary>
+		inline uint64_t GetFileSize(const int directoryDescriptor, const char* pName)
+		{
+			struct stat fileStat {};
+			if (fstatat(directoryDescriptor, pName, &fileStat, 0) != 0) return 0;
+
+			return static_cast<uint64_t>(fileStat.st_size);
+		}
+
+		/// <summary>
+		/// Calls callback(name, fileSize) for every regular file and callback(name, subdirectory) for every directory in directory
+		/// The entry type comes from d_type, so no stat() is needed per entry. Only with AreFileSizesNeeded do files get one on the open directory
+		/// for their size, so big files are searched first and the FileReader can leave them to the search threads; otherwise the size is 0
+		/// Returns false if the directory could not be opened, or could not be read to its end, in which case only part of it was reported
+		/// </summary>
+		template<bool AreFileSizesNeeded, typename Callback>
+		bool ListDirectory(const DirectoryEntry& directory, Callback&& callback)
+		{
+			const int fileDescriptor{ OpenDirectory(directory) };
+			if (fileDescriptor == -1) return false;
+
+			const std::shared_ptr<const DirectoryDescriptor> pDescriptor{ std::make_shared<const DirectoryDescriptor>(fileDescriptor) };
+
+			const auto onEntry{ [&directory, &callback, &pDescriptor](const char* pName, const unsigned char type)->void
+				{
+					if (pName[0] == '.' && (pName[1] == '\0' || (pName[1] == '.' && pName[2] == '\0'))) return;
+
+					const unsigned char entryType{ GetEntryType(pDescriptor->Get(), pName, type) };
+					if (entryType == DT_DIR)
+					{
+						callback(std::string_view{ pName }, DirectoryEntry{ nullptr, directory.Depth + 1, pDescriptor, {} });
+					}
+					else if (entryType == DT_REG)
+					{
+						callback(std::string_view{ pName }, AreFileSizesNeeded ? GetFileSize(pDescriptor->Get(), pName) : uint64_t{});
+					}
+				} };
+
+#ifdef __linux__
+			struct LinuxDirent64
+			{
+				uint64_t d_ino;
+				int64_t d_off;
+				unsigned short d_reclen;
+				unsigned char d_type;
+				char d_name[1];
+			};
+
+			alignas(LinuxDirent64) char buffer[1u << 15];
+
+			for (;;)
+			{
+				const long bytesRead{ syscall(SYS_getdents64, fileDescriptor, buffer, sizeof(buffer)) };
+				if (bytesRead == 0) break;
+
+				// an error (e.g. EIO, or ENOENT for a directory removed while it is listed) is not the end of the directory
+				if (bytesRead < 0)
+				{
+					if (errno == EINTR) continue;
+					return false;
+				}
+
+				for (long offset{}; offset < bytesRead;)
+				{
+					const LinuxDirent64* pEntry{ reinterpret_cast<const LinuxDirent64*>(buffer + offset) };
+					onEntry(pEntry->d_name, pEntry->d_type);
+					offset += pEntry->d_reclen;
+				}
+			}
+
+			return true;
+#else
+			// fdopendir() takes ownership of the descriptor, so give it a copy
+			DIR* pDirectory{ fdopendir(dup(fileDescriptor)) };
+			if (!pDirectory) return false;
+
+			// readdir() returns null at the end and on an error, only an error sets errno
+			bool isRead{};
+			for (;;)
+			{
+				errno = 0;
+				const dirent* pEntry{ readdir(pDirectory) };
+				if (!pEntry)
+				{
+					isRead = errno == 0;
+					break;
+				}
+
+				onEntry(pEntry->d_name, pEntry->d_type);
+			}
+
+			closedir(pDirectory);
+
+			return isRead;
+#endif
+		}
+#endif
+
+		/// <summary>
+		/// Scratch memory of one thread listing directories with ListMaskedDirectory
+		/// </summary>
+		struct DirectoryListing final
+		{
+			std::vector<std::pair<std::string_view, uint64_t>> Files;
+			std::vector<DirectoryEntry> Subdirectories;
+			std::string DirectoryPath; // relative to the root of the walk
+			std::string Path;
+			std::string IgnorePath;
+			std::shared_ptr<const IgnoreFile> pIgnoreFile; // the ignore rules that applied to the entries of the last directory listed
+		};
+
+		/// <summary>
+		/// Adds the rules of the ignore files in directory on top of those of its parents
+		/// </summary>
+		inline std::shared_ptr<const IgnoreFile> ReadIgnoreFiles(const DirectoryEntry& directory, std::string& path)
+		{
+			const std::shared_ptr<IgnoreFile> pIgnoreFile{ std::make_shared<IgnoreFile>(directory.pIgnoreFile, directory.pNode) };
+
+			for (const std::string_view name : IgnoreFileNames)
+			{
+				BuildPath(directory.pNode, path);
+				path += PathSeparator;
+				path += name;
+
+				std::ifstream stream{ path, std::ios::binary };
+				if (!stream) continue;
+
+				pIgnoreFile->AddRules(std::string{ std::istreambuf_iterator<char>{ stream }, std::istreambuf_iterator<char>{} });
+			}
+
+			return pIgnoreFile;
+		}
+
+		/// <summary>
+		/// Lists a directory of a recursive walk, only reporting what passes the mask and the ignore files
+		/// onSubdirectory(DirectoryEntry&&) is called for every subdirectory to walk into, onFile(name, fileSize) for every file to search, with the name stored in paths
+		/// The file sizes can cost a stat() per file, so they are only looked up with AreFileSizesNeeded, see ListDirectory
+		/// An ignore file can come after the entries it ignores, so with ignore files nothing is reported before the whole directory is listed
+		/// Returns false if the directory could not be opened
+		/// </summary>
+		template<bool AreFileSizesNeeded, typename DirectoryCallback, typename FileCallback>
+		bool ListMaskedDirectory(
+			const DirectoryEntry& directory,
+			const FileMask& mask,
+			const uint32_t recursiveDepth,
+			PathArena::Writer& paths,
+			DirectoryListing& listing,
+			DirectoryCallback&& onSubdirectory,
+			FileCallback&& onFile)
+		{
+			if (mask.IsPathNeeded()) BuildRelativePath(directory.pNode, nullptr, listing.DirectoryPath);
+
+			const auto getPath{ [&mask, &listing](const std::string_view name)->std::string_view
+				{
+					if (!mask.IsPathNeeded()) return name;
+
+					listing.Path.assign(listing.DirectoryPath);
+					if (!listing.Path.empty()) listing.Path += '/';
+					listing.Path += name;
+
+					return listing.Path;
+				} };
+
+			if (!mask.UsesIgnoreFiles())
+			{
+				return ListDirectory<AreFileSizesNeeded>(directory, Overloaded{
+					[&](const std::string_view name, DirectoryEntry&& subdirectory)->void
+					{
+						if (!ShouldDirectoryBeConsidered(subdirectory.Depth, recursiveDepth) || mask.IsDirectoryExcluded(name, getPath(name))) return;
+
+						subdirectory.pNode = paths.StoreNode(directory.pNode, name);
+						onSubdirectory(std::move(subdirectory));
+					},
+					[&](const std::string_view name, const uint64_t fileSize)->void
+					{
+						if (mask.IsFileIncluded(name, getPath(name))) onFile(paths.StoreName(name), fileSize);
+					} });
+			}
+
+			listing.Files.clear();
+			listing.Subdirectories.clear();
+			bool hasIgnoreFile{};
+
+			const bool isListed{ ListDirectory<AreFileSizesNeeded>(directory, Overloaded{
+				[&](const std::string_view name, DirectoryEntry&& subdirectory)->void
+				{
+					if (!ShouldDirectoryBeConsidered(subdirectory.Depth, recursiveDepth) || (mask.UsesIgnoreFiles() && name == ".git")) return;
+
+					subdirectory.pNode = paths.StoreNode(directory.pNode, name);
+					listing.Subdirectories.push_back(std::move(subdirectory));
+				},
+				[&](const std::string_view name, const uint64_t fileSize)->void
+				{
+					hasIgnoreFile |= IsIgnoreFileName(name);
+					listing.Files.emplace_back(paths.StoreName(name), fileSize);
+				} }) };
+
+			listing.pIgnoreFile = hasIgnoreFile ? ReadIgnoreFiles(directory, listing.IgnorePath) : directory.pIgnoreFile;
+			const std::shared_ptr<const IgnoreFile>& pIgnoreFile{ listing.pIgnoreFile };
+
+			const auto isIgnored{ [&directory, &listing, &pIgnoreFile](const std::string_view name, const bool isDirectory)->bool
+				{
+					return pIgnoreFile && pIgnoreFile->IsIgnored(directory.pNode, name, isDirectory, listing.IgnorePath);
+				} };
+
+			for (DirectoryEntry& subdirectory : listing.Subdirectories)
+			{
+				const std::string_view name{ subdirectory.pNode->Name };
+				if (mask.IsDirectoryExcluded(name, getPath(name)) || isIgnored(name, true)) continue;
+
+				subdirectory.pIgnoreFile = pIgnoreFile;
+				onSubdirectory(std::move(subdirectory));
+			}
+
+			for (const auto& [name, fileSize] : listing.Files)
+			{
+				if (mask.IsFileIncluded(name, getPath(name)) && !isIgnored(name, false)) onFile(name, fileSize);
+			}
+
+			return isListed;
+		}
+
+		/// <summary>
+		/// Producer stage of a recursive search
+		/// Several walker threads share one stack of directories still to be listed, every file that passes the mask and the ignore files
+		/// is pushed into the file queue as soon as its directory allows it. The last walker to run out of work closes the queue
+		/// Once isStopped is set the walkers find no more files and stop after the directory they are listing
+		/// </summary>
+		class DirectoryWalker final
+		{
+		public:
+			DirectoryWalker(const std::string& rootDir, const FileMask& mask, const uint32_t recursiveDepth, FileQueue& fileQueue, const std::atomic<bool>& isStopped, const size_t nrOfWalkers)
+				: m_Mask{ mask }
+				, m_RecursiveDepth{ recursiveDepth }
+				, m_FileQueue{ fileQueue }
+				, m_IsStopped{ isStopped }
+				, m_Mutex{}
+				, m_HasWork{}
+				, m_Directories{}
+				, m_NrOfBusyWalkers{}
+				, m_NrOfRunningWalkers{ nrOfWalkers }
+				, m_NrOfFilesFound{}
+				, m_Paths{}
+			{
+				PathArena::Writer paths{ m_Paths };
+				m_Directories.push_back(MakeRootDirectoryEntry(paths, rootDir));
+			}
+
+			DirectoryWalker(const DirectoryWalker&) noexcept = delete;
+			DirectoryWalker(DirectoryWalker&&) noexcept = delete;
+			DirectoryWalker& operator=(const DirectoryWalker&) noexcept = delete;
+			DirectoryWalker& operator=(DirectoryWalker&&) noexcept = delete;
+
+			/// <summary>
+			/// Thread entry point, has to be called by exactly as many threads as nrOfWalkers
+			/// Time spent waiting for a full file queue or for other walkers to find directories is counted as waiting, not enumeration
+			/// </summary>
+			void Run(SearchCounters* pCounters)
+			{
+				PathArena::Writer paths{ m_Paths };
+				DirectoryListing listing{};
+				DirectoryEntry directory{};
+				std::vector<DirectoryEntry> subdirectories{};
+
+				while (!IsStopped())
+				{
+					{
+						const ScopedTimer timer{ pCounters, &SearchCounters::WaitTime };
+						if (!PopDirectory(directory)) break;
+					}
+
+					const uint64_t listStart{ IsMeasuringPhases(pCounters) ? GetNanoseconds() : 0 };
+					const uint64_t waitTime{ pCounters ? pCounters->WaitTime : 0 };
+
+					const bool isListed{ ListMaskedDirectory<true>(directory, m_Mask, m_RecursiveDepth, paths, listing,
+						[&subdirectories](DirectoryEntry&& subdirectory)->void
+						{
+							subdirectories.push_back(std::move(subdirectory));
+						},
+						[this, &directory, pCounters](const std::string_view name, const uint64_t fileSize)->void
+						{
+							if (IsStopped()) return;
+
+							m_NrOfFilesFound.fetch_add(1, std::memory_order_relaxed);
+
+							FileEntry file{ directory.pNode, name, fileSize, {} };
+							const bool isLargeFile{ IsLargeFile(file) };
+							TimedPush(m_FileQueue, std::move(file), pCounters, isLargeFile);
+						}) };
+
+					if (IsMeasuringPhases(pCounters))
+					{
+						pCounters->EnumerationTime += GetNanoseconds() - listStart - (pCounters->WaitTime - waitTime);
+					}
+
+					if (!isListed)
+					{
+						std::string path{};
+						BuildPath(directory.pNode, path);
+
+						PrintMessage("Could not open directory: ", path);
+					}
+
+					// drop the reference to the parent's descriptor as soon as possible
+					directory = DirectoryEntry{};
+
+					FinishDirectory(subdirectories);
+				}
+
+				if (m_NrOfRunningWalkers.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				{
+					m_FileQueue.Close();
+				}
+			}
+
+			[[nodiscard]] size_t GetNrOfFilesFound() const { return m_NrOfFilesFound.load(std::memory_order_relaxed); }
+
+		private:
+			bool IsStopped() const { return m_IsStopped.load(std::memory_order_relaxed); }
+
+			bool PopDirectory(DirectoryEntry& directory)
+			{
+				std::unique_lock<std::mutex> lock{ m_Mutex };
+
+				// when no walker is busy anymore, nobody can push new directories, so the walk is over
+				m_HasWork.wait(lock, [this]() { return !m_Directories.empty() || m_NrOfBusyWalkers == 0; });
+
+				if (m_Directories.empty()) return false;
+
+				directory = std::move(m_Directories.back());
+				m_Directories.pop_back();
+				++m_NrOfBusyWalkers;
+
+				return true;
+			}
+
+			void FinishDirectory(std::vector<DirectoryEntry>& subdirectories)
+			{
+				bool shouldWakeWalkers{};
+
+				{
+					const std::scoped_lock<std::mutex> lock{ m_Mutex };
+
+					for (DirectoryEntry& subdirectory : subdirectories)
+					{
+						m_Directories.push_back(std::move(subdirectory));
+					}
+
+					--m_NrOfBusyWalkers;
+					shouldWakeWalkers = !subdirectories.empty() || m_NrOfBusyWalkers == 0;
+				}
+
+				if (shouldWakeWalkers) m_HasWork.notify_all();
+
+				subdirectories.clear();
+			}
+
+			const FileMask& m_Mask;
+			const uint32_t m_RecursiveDepth;
+			FileQueue& m_FileQueue;
+			const std::atomic<bool>& m_IsStopped;
+
+			std::mutex m_Mutex;
+			std::condition_variable m_HasWork;
+			std::vector<DirectoryEntry> m_Directories;
+			size_t m_NrOfBusyWalkers;
+			std::atomic<size_t> m_NrOfRunningWalkers;
+			std::atomic<size_t> m_NrOfFilesFound;
+
+			// the file entries point into it, so it lives as long as the walker
+			PathArena m_Paths;
+		};
+
+		/// <summary>
+		/// Full paths of every file in rootDir and its subdirectories that passes the mask and the ignore files
+		/// </summary>
+		inline std::vector<std::string> GetAllFilesInDirectory(const std::string& rootDir, const FileMask& mask, const uint32_t recursiveDepth)
+		{
+			std::vector<std::string> files{};
+
+			PathArena arena{};
+			PathArena::Writer paths{ arena };
+
+			std::stack<DirectoryEntry> fileStack{};
+			fileStack.push(MakeRootDirectoryEntry(paths, rootDir));
+
+			DirectoryListing listing{};
+			std::string path{};
+
+			while (!fileStack.empty())
+			{
+				const DirectoryEntry child{ std::move(fileStack.top()) };
+				fileStack.pop();
+
+				BuildPath(child.pNode, path);
+
+				const bool isListed{ ListMaskedDirectory<false>(child, mask, recursiveDepth, paths, listing,
+					[&fileStack](DirectoryEntry&& subdirectory)->void
+					{
+						fileStack.push(std::move(subdirectory));
+					},
+					[&files, &path](const std::string_view name, const uint64_t)->void
+					{
+						std::string filename{};
+						filename.reserve(path.size() + 1 + name.size());
+						filename += path;
+						filename += PathSeparator;
+						filename += name;
+
+						files.push_back(std::move(filename));
+					}) };
+
+				if (!isListed)
+				{
+					PrintMessage("Could not open directory: ", path);
+				}
+			}
+
+			return files;
+		}
+	}
+
+	/// <summary>
+	/// Returns the position of the first occurrence of needle in haystack, or std::string_view::npos
+	/// Same result as std::string_view::find, but uses the fastest SIMD kernel the CPU supports
+	/// With ignoreCase, ASCII letters are compared case-insensitively without modifying the haystack
+	/// </summary>
+	inline size_t FindString(const std::string_view haystack, const std::string_view needle, const bool ignoreCase = false)
+	{
+		if (!ignoreCase) return Detail::GetFindStringFunction<false>(needle.size())(haystack, needle);
+
+		std::string lowercaseNeedle{ needle };
+		Detail::TransformStringToLowercase(lowercaseNeedle);
+
+		return Detail::GetFindStringFunction<true>(needle.size())(haystack, lowercaseNeedle);
+	}
+
+	/// <summary>
+	/// String literal that can be passed as a template argument, see FixedPattern
+	/// </summary>
+	template<size_t N>
+	struct FixedString final
+	{
+		constexpr FixedString(const char(&string)[N])
+			: Data{}
+		{
+			std::copy_n(string, N, Data);
+		}
+
+		[[nodiscard]] constexpr std::string_view GetView() const { return std::string_view{ Data, N - 1 }; }
+
+		char Data[N];
+	};
+
+	/// <summary>
+	/// A string to search for that is known at compile time, e.g. FixedPattern<"ERROR_42"> or FixedPattern<"timeout", true> to ignore case
+	/// The folded needle is built by the compiler, and the search kernels are compiled for the needle's size
+	/// </summary>
+	template<FixedString Needle, bool IgnoreCase = false>
+	class FixedPattern final
+	{
+	public:
+		inline static constexpr size_t Size{ Needle.GetView().size() };
+
+		static_assert(Size > 0, "A FixedPattern cannot be empty");
+		static_assert(Needle.GetView().find('\n') == std::string_view::npos, "Lines are split on '\\n', so a FixedPattern spanning lines can never match");
+
+		[[nodiscard]] static constexpr std::string_view GetString() { return std::string_view{ String.data(), Size }; }
+
+		/// <summary>
+		/// Same as FindString(haystack, Needle, IgnoreCase)
+		/// </summary>
+		[[nodiscard]] static size_t Find(const std::string_view haystack)
+		{
+			return Detail::GetFindStringFunction<IgnoreCase, Size>()(haystack, GetString());
+		}
+
+	private:
+		static constexpr std::array<char, Size> FoldString()
+		{
+			std::array<char, Size> string{};
+			std::transform(Needle.Data, Needle.Data + Size, string.begin(), [](const char c)->char { return IgnoreCase ? Detail::ToLowercase(c) : c; });
+
+			return string;
+		}
+
+		inline static constexpr std::array<char, Size> String{ FoldString() };
+	};
+
+	struct StringSearchStatistics final
+	{
+		int32_t NumberOfFilesSearched;
+		int32_t NumberOfBinaryFilesSkipped;
+		int32_t NumberOfOpenFailures;
+		uint64_t NumberOfBytesRead;
+		uint64_t NumberOfMatches; // matching lines, a line matching several patterns counts once per pattern
+
+		// Everything below is only measured when MeasurePhases is set before searching, as it costs a few clock reads per file
+		// and a second pass over the lines after the last match of every file
+		bool MeasurePhases;
+
+		uint64_t NumberOfLinesScanned;
+
+		// In nanoseconds. Every phase is summed over all threads, so the phases add up to more than TotalTime on a multi-threaded search
+		// Memory-mapped files are read while they are searched, so their reads count as MatchTime
+		uint64_t TotalTime;
+		uint64_t EnumerationTime; // listing directories
+		uint64_t OpenTime; // opening and mapping files
+		uint64_t ReadTime; // reading files that could not be mapped
+		uint64_t MatchTime;
+		uint64_t WaitTime; // blocked on a full or empty queue, or on a lock
+		uint64_t OutputTime; // merging and sorting results, or handing them to the callback
+	};
+
+	/// <summary>
+	/// Which files a search looks at and how it searches them, given to every search function
+	/// Only what differs from the defaults has to be named, e.g. SearchOptions{ .Mask{ "*.log" }, .IgnoreCase = true, .RecursivelySearch = true }
+	/// </summary>
+	struct SearchOptions final
+	{
+		FileMask Mask{ "" }; // only applied to a recursive search
+		bool IgnoreCase{};
+		bool RecursivelySearch{};
+		uint32_t RecursiveDepth{}; // 0 for no limit
+		BinaryFileMode BinaryMode{ BinaryFileMode::Skip };
+		SearchLimits Limits{};
+		StringSearchStatistics* pStatistics{}; // filled in when the search is done, if set
+	};
+
+	namespace Detail
+	{
+		/// <summary>
+		/// Matcher for a FixedPattern, same as StringMatcher but with everything about the string known at compile time
+		/// </summary>
+		template<typename Pattern>
+		class FixedPatternMatcher final
+		{
+		public:
+			[[nodiscard]] size_t GetNrOfPatterns() const { return 1; }
+
+			[[nodiscard]] bool GetRequiredLiterals(std::vector<std::string>& literals) const
+			{
+				literals.emplace_back(Pattern::GetString());
+				return true;
+			}
+
+			template<typename Callback>
+			const char* SearchBuffer(const std::string_view buffer, uint32_t& lineNumber, Callback&& onMatch) const
+			{
+				return SearchBufferForString(buffer, lineNumber, &Pattern::Find, onMatch);
+			}
+		};
+
+		/// <summary>
+		/// Results of one search thread, padded to a cache line so threads appending to their own results never share one
+		/// </summary>
+		struct alignas(64) ThreadResults final
+		{
+			std::vector<FileSearchResult> Results;
+			SearchCounters Counters;
+		};
+
+		/// <summary>
+		/// Returns the counters a search should fill in, or nullptr when the caller did not ask for statistics
+		/// </summary>
+		inline SearchCounters* GetCountersToFill(const StringSearchStatistics* pStatistics, SearchCounters& counters)
+		{
+			if (!pStatistics) return nullptr;
+
+			counters.IsMeasuringPhases = pStatistics->MeasurePhases;
+			return &counters;
+		}
+
+		inline void SetStatistics(StringSearchStatistics* pStatistics, const SearchCounters& counters, const uint64_t startTime)
+		{
+			if (!pStatistics) return;
+
+			pStatistics->NumberOfBinaryFilesSkipped = static_cast<int32_t>(counters.NrOfBinaryFilesSkipped);
+			pStatistics->NumberOfOpenFailures = static_cast<int32_t>(counters.NrOfOpenFailures);
+			pStatistics->NumberOfBytesRead = counters.NrOfBytesRead;
+			pStatistics->NumberOfMatches = counters.NrOfMatches;
+
+			if (!pStatistics->MeasurePhases) return;
+
+			pStatistics->NumberOfLinesScanned = counters.NrOfLinesScanned;
+			pStatistics->TotalTime = GetNanoseconds() - startTime;
+			pStatistics->EnumerationTime = counters.EnumerationTime;
+			pStatistics->OpenTime = counters.OpenTime;
+			pStatistics->ReadTime = counters.ReadTime;
+			pStatistics->MatchTime = counters.MatchTime;
+			pStatistics->WaitTime = counters.WaitTime;
+			pStatistics->OutputTime = counters.OutputTime;
+		}
+
+		/// <summary>
+		/// Sorts by path and then by pattern, so the results of two searches can be compared
+		/// </summary>
+		inline void SortResults(std::vector<FileSearchResult>& results)
+		{
+			std::sort(results.begin(), results.end(), [](const FileSearchResult& lhs, const FileSearchResult& rhs)->bool
+				{
+					if (lhs.Path != rhs.Path) return lhs.Path < rhs.Path;
+					return lhs.PatternIndex < rhs.PatternIndex;
+				});
+		}
+
+		/// <summary>
+		/// pFoundStrings points to one map per pattern
+		/// </summary>
+		inline void AddResultsToMaps(std::vector<FileSearchResult>& results, std::unordered_map<std::string, std::vector<uint32_t>>* pFoundStrings)
+		{
+			for (FileSearchResult& result : results)
+			{
+				std::vector<uint32_t>& lineNumbers{ pFoundStrings[result.PatternIndex][std::move(result.Path)] };
+				lineNumbers.insert(lineNumbers.end(), result.LineNumbers.begin(), result.LineNumbers.end());
+			}
+		}
+
+#ifdef RDW_SS_HAS_IO_URING
+		/// <summary>
+		/// Minimal io_uring set up through the system calls themselves, so no library is needed
+		/// Only the thread that owns it submits and reaps, the kernel is the other side of both rings
+		/// </summary>
+		class IoRing final
+		{
+		public:
+			explicit IoRing(const uint32_t nrOfEntries)
+				: m_RingDescriptor{ -1 }
+				, m_pSubmissionRing{ MAP_FAILED }
+				, m_SubmissionRingSize{}
+				, m_pCompletionRing{ MAP_FAILED }
+				, m_CompletionRingSize{}
+				, m_pEntries{ static_cast<io_uring_sqe*>(MAP_FAILED) }
+				, m_EntriesSize{}
+				, m_pSubmissionHead{}
+				, m_pSubmissionTail{}
+				, m_pSubmissionArray{}
+				, m_SubmissionMask{}
+				, m_pCompletionHead{}
+				, m_pCompletionTail{}
+				, m_pCompletions{}
+				, m_CompletionMask{}
+				, m_NrOfEntries{}
+				, m_SubmissionTail{}
+				, m_NrOfUnsubmitted{}
+			{
+				io_uring_params params{};
+				const long ringDescriptor{ syscall(__NR_io_uring_setup, nrOfEntries, &params) };
+				if (ringDescriptor < 0) return;
+
+				m_RingDescriptor = static_cast<int>(ringDescriptor);
+
+				m_SubmissionRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+				m_CompletionRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+				m_EntriesSize = params.sq_entries * sizeof(io_uring_sqe);
+
+				m_pSubmissionRing = mmap(nullptr, m_SubmissionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_RingDescriptor, IORING_OFF_SQ_RING);
+				m_pCompletionRing = mmap(nullptr, m_CompletionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_RingDescriptor, IORING_OFF_CQ_RING);
+				m_pEntries = static_cast<io_uring_sqe*>(mmap(nullptr, m_EntriesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_RingDescriptor, IORING_OFF_SQES));
+				if (m_pSubmissionRing == MAP_FAILED || m_pCompletionRing == MAP_FAILED || m_pEntries == MAP_FAILED) return;
+
+				char* const pSubmissionRing{ static_cast<char*>(m_pSubmissionRing) };
+				m_pSubmissionHead = reinterpret_cast<uint32_t*>(pSubmissionRing + params.sq_off.head);
+				m_pSubmissionTail = reinterpret_cast<uint32_t*>(pSubmissionRing + params.sq_off.tail);
+				m_pSubmissionArray = reinterpret_cast<uint32_t*>(pSubmissionRing + params.sq_off.array);
+				m_SubmissionMask = *reinterpret_cast<uint32_t*>(pSubmissionRing + params.sq_off.ring_mask);
+
+				char* const pCompletionRing{ static_cast<char*>(m_pCompletionRing) };
+				m_pCompletionHead = reinterpret_cast<uint32_t*>(pCompletionRing + params.cq_off.head);
+				m_pCompletionTail = reinterpret_cast<uint32_t*>(pCompletionRing + params.cq_off.tail);
+				m_pCompletions = reinterpret_cast<io_uring_cqe*>(pCompletionRing + params.cq_off.cqes);
+				m_CompletionMask = *reinterpret_cast<uint32_t*>(pCompletionRing + params.cq_off.ring_mask);
+
+				m_NrOfEntries = params.sq_entries;
+				m_SubmissionTail = *m_pSubmissionTail;
+			}
+
+			~IoRing()
+			{
+				if (m_pEntries != MAP_FAILED) munmap(m_pEntries, m_EntriesSize);
+				if (m_pCompletionRing != MAP_FAILED) munmap(m_pCompletionRing, m_CompletionRingSize);
+				if (m_pSubmissionRing != MAP_FAILED) munmap(m_pSubmissionRing, m_SubmissionRingSize);
+				if (m_RingDescriptor != -1) close(m_RingDescriptor);
+			}
+
+			IoRing(const IoRing&) noexcept = delete;
+			IoRing(IoRing&&) noexcept = delete;
+			IoRing& operator=(const IoRing&) noexcept = delete;
+			IoRing& operator=(IoRing&&) noexcept = delete;
+
+			[[nodiscard]] bool IsValid() const { return m_NrOfEntries != 0; }
+
+			/// <summary>
+			/// Containers and older kernels can have io_uring without the operations that were added later, or with some of them filtered out
+			/// </summary>
+			[[nodiscard]] bool SupportsOperations(const std::initializer_list<uint8_t> operations) const
+			{
+				constexpr uint32_t maxNrOfOperations{ 256 };
+				std::vector<char> probeMemory(sizeof(io_uring_probe) + maxNrOfOperations * sizeof(io_uring_probe_op));
+				io_uring_probe* const pProbe{ reinterpret_cast<io_uring_probe*>(probeMemory.data()) };
+
+				if (syscall(__NR_io_uring_register, m_RingDescriptor, IORING_REGISTER_PROBE, pProbe, maxNrOfOperations) < 0) return false;
+
+				return std::all_of(operations.begin(), operations.end(), [pProbe](const uint8_t operation)
+					{
+						return operation <= pProbe->last_op && (pProbe->ops[operation].flags & IO_URING_OP_SUPPORTED);
+					});
+			}
+
+			/// <summary>
+			/// Registered buffers are pinned once instead of on every read, fails when they exceed the locked memory limit
+			/// </summary>
+			bool RegisterBuffers(const std::vector<iovec>& buffers)
+			{
+				return syscall(__NR_io_uring_register, m_RingDescriptor, IORING_REGISTER_BUFFERS, buffers.data(), static_cast<uint32_t>(buffers.size())) == 0;
+			}
+
+			/// <summary>
+			/// Returns a cleared submission queue entry that is submitted by the next Submit(), the ring has to be big enough for everything in flight
+			/// </summary>
+			[[nodiscard]] io_uring_sqe& GetEntry()
+			{
+				RDW_SS_ASSERT(m_SubmissionTail - std::atomic_ref<uint32_t>{ *m_pSubmissionHead }.load(std::memory_order_acquire) < m_NrOfEntries);
+
+				const uint32_t index{ m_SubmissionTail++ & m_SubmissionMask };
+				m_pSubmissionArray[index] = index;
+				++m_NrOfUnsubmitted;
+
+				io_uring_sqe& entry{ m_pEntries[index] };
+				entry = io_uring_sqe{};
+				return entry;
+			}
+
+			/// <summary>
+			/// Submits every new entry and blocks until at least minNrOfCompletions have completed
+			/// </summary>
+			void Submit(const uint32_t minNrOfCompletions)
+			{
+				std::atomic_ref<uint32_t>{ *m_pSubmissionTail }.store(m_SubmissionTail, std::memory_order_release);
+
+				for (;;)
+				{
+					const long nrOfSubmitted{ syscall(__NR_io_uring_enter, m_RingDescriptor, m_NrOfUnsubmitted, minNrOfCompletions, minNrOfCompletions > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0) };
+					if (nrOfSubmitted >= 0)
+					{
+						m_NrOfUnsubmitted -= static_cast<uint32_t>(nrOfSubmitted);
+						return;
+					}
+
+					if (errno != EINTR) return;
+				}
+			}
+
+			/// <summary>
+			/// Calls onCompletion(userData, result) for every completed entry, result is negative errno on failure
+			/// </summary>
+			template<typename Callback>
+			void ReapCompletions(Callback&& onCompletion)
+			{
+				uint32_t head{ *m_pCompletionHead };
+				const uint32_t tail{ std::atomic_ref<uint32_t>{ *m_pCompletionTail }.load(std::memory_order_acquire) };
+
+				for (; head != tail; ++head)
+				{
+					const io_uring_cqe& completion{ m_pCompletions[head & m_CompletionMask] };
+					onCompletion(completion.user_data, completion.res);
+				}
+
+				std::atomic_ref<uint32_t>{ *m_pCompletionHead }.store(head, std::memory_order_release);
+			}
+
+		private:
+			int m_RingDescriptor;
+			void* m_pSubmissionRing;
+			size_t m_SubmissionRingSize;
+			void* m_pCompletionRing;
+			size_t m_CompletionRingSize;
+			io_uring_sqe* m_pEntries;
+			size_t m_EntriesSize;
+			uint32_t* m_pSubmissionHead;
+			uint32_t* m_pSubmissionTail;
+			uint32_t* m_pSubmissionArray;
+			uint32_t m_SubmissionMask;
+			uint32_t* m_pCompletionHead;
+			uint32_t* m_pCompletionTail;
+			io_uring_cqe* m_pCompletions;
+			uint32_t m_CompletionMask;
+			uint32_t m_NrOfEntries;
+			uint32_t m_SubmissionTail;
+			uint32_t m_NrOfUnsubmitted;
+		};
+
+		/// <summary>
+		/// Number of files the FileReader keeps in flight, and the biggest file it reads ahead
+		/// Bigger files are left to the search threads, which map them
+		/// </summary>
+		inline static constexpr uint32_t NrOfReadBuffers{ 64 };
+		inline static constexpr size_t ReadBufferSize{ 64 * 1024 };
+
+		/// <summary>
+		/// Stage between the directory walkers and the search threads for trees of many small files
+		/// One thread keeps the opens, reads and closes of up to NrOfReadBuffers files in flight with io_uring, reading every file
+		/// into a registered buffer of its own. Files that fit are passed on to the search threads already read, bigger files and files
+		/// that could not be read are passed on as they are, so the search thread opens them and reports any error like without a reader
+		/// </summary>
+		class FileReader final
+		{
+		public:
+			FileReader(FileQueue& fileQueue, FileQueue& readQueue)
+				: m_Ring{ NrOfReadBuffers * 2 }
+				, m_Buffers{ NrOfReadBuffers, ReadBufferSize }
+				, m_Files(NrOfReadBuffers)
+				, m_Paths(NrOfReadBuffers)
+				, m_FileDescriptors(NrOfReadBuffers)
+				, m_FileQueue{ fileQueue }
+				, m_ReadQueue{ readQueue }
+				, m_IsAvailable{}
+				, m_AreBuffersRegistered{}
+			{
+				if (!m_Ring.IsValid()) return;
+
+				m_AreBuffersRegistered = m_Ring.RegisterBuffers(GetBuffers());
+				m_IsAvailable = m_Ring.SupportsOperations({ IORING_OP_OPENAT, m_AreBuffersRegistered ? uint8_t{ IORING_OP_READ_FIXED } : uint8_t{ IORING_OP_READ }, IORING_OP_CLOSE });
+			}
+
+			FileReader(const FileReader&) noexcept = delete;
+			FileReader(FileReader&&) noexcept = delete;
+			FileReader& operator=(const FileReader&) noexcept = delete;
+			FileReader& operator=(FileReader&&) noexcept = delete;
+
+			/// <summary>
+			/// If io_uring is not available the search threads read the walkers' queue themselves
+			/// </summary>
+			[[nodiscard]] bool IsAvailable() const { return m_IsAvailable; }
+
+			/// <summary>
+			/// Thread entry point, closes the read queue once every file of the file queue has been passed on
+			/// Time spent waiting for the kernel counts as reading
+			/// </summary>
+			void Run(SearchCounters* pCounters)
+			{
+				size_t nrOfOperationsInFlight{};
+				bool isFileQueueDrained{};
+
+				for (;;)
+				{
+					// start a file for every free buffer, but only block for a buffer or a file when nothing is in flight
+					while (!isFileQueueDrained)
+					{
+						uint32_t index{};
+						if (!m_Buffers.TryAcquire(index))
+						{
+							if (nrOfOperationsInFlight > 0) break;
+
+							const ScopedTimer timer{ pCounters, &SearchCounters::WaitTime };
+							m_Buffers.Acquire(index);
+						}
+
+						FileEntry& file{ m_Files[index] };
+						if (!(nrOfOperationsInFlight > 0 ? m_FileQueue.TryPop(file) : TimedPop(m_FileQueue, file, pCounters)))
+						{
+							m_Buffers.Release(index);
+							isFileQueueDrained = nrOfOperationsInFlight == 0;
+							break;
+						}
+
+						if (file.Size > m_Buffers.GetBufferSize())
+						{
+							m_Buffers.Release(index);
+
+							const bool isLargeFile{ IsLargeFile(file) };
+							TimedPush(m_ReadQueue, std::move(file), pCounters, isLargeFile);
+							continue;
+						}
+
+						// the path has to stay alive until the open completes, so every slot builds it into a buffer of its own
+						std::string& path{ m_Paths[index] };
+						BuildPath(file, path);
+
+						io_uring_sqe& entry{ m_Ring.GetEntry() };
+						entry.opcode = IORING_OP_OPENAT;
+						entry.fd = AT_FDCWD;
+						entry.addr = reinterpret_cast<uint64_t>(path.c_str());
+						entry.open_flags = O_RDONLY | O_CLOEXEC;
+						entry.user_data = MakeUserData(index, Operation::Open);
+						++nrOfOperationsInFlight;
+					}
+
+					// with nothing in flight the loop above only stops once the file queue is drained
+					if (nrOfOperationsInFlight == 0) break;
+
+					{
+						const ScopedTimer timer{ pCounters, &SearchCounters::ReadTime };
+						m_Ring.Submit(1);
+					}
+
+					m_Ring.ReapCompletions([this, &nrOfOperationsInFlight, pCounters](const uint64_t userData, const int32_t result)->void
+						{
+							--nrOfOperationsInFlight;
+							nrOfOperationsInFlight += OnCompletion(static_cast<uint32_t>(userData >> 2), static_cast<Operation>(userData & 3), result, pCounters);
+						});
+				}
+
+				m_ReadQueue.Close();
+			}
+
+		private:
+			enum class Operation : uint8_t
+			{
+				Open,
+				Read,
+				Close
+			};
+
+			static uint64_t MakeUserData(const uint32_t index, const Operation operation)
+			{
+				return (uint64_t{ index } << 2) | static_cast<uint64_t>(operation);
+			}
+
+			std::vector<iovec> GetBuffers()
+			{
+				std::vector<iovec> buffers(m_Buffers.GetNrOfBuffers());
+				for (uint32_t i{}; i < m_Buffers.GetNrOfBuffers(); ++i)
+				{
+					buffers[i] = iovec{ m_Buffers.GetBuffer(i), m_Buffers.GetBufferSize() };
+				}
+
+				return buffers;
+			}
+
+			/// <summary>
+			/// Queues the next operation of the file, returns the number of operations that were queued
+			/// </summary>
+			size_t OnCompletion(const uint32_t index, const Operation operation, const int32_t result, SearchCounters* pCounters)
+			{
+				FileEntry& file{ m_Files[index] };
+
+				switch (operation)
+				{
+				case Operation::Open:
+				{
+					if (result < 0)
+					{
+						m_Buffers.Release(index);
+						TimedPush(m_ReadQueue, std::move(file), pCounters);
+						return 0;
+					}
+
+					io_uring_sqe& entry{ m_Ring.GetEntry() };
+					entry.opcode = m_AreBuffersRegistered ? IORING_OP_READ_FIXED : IORING_OP_READ;
+					entry.fd = result;
+					entry.addr = reinterpret_cast<uint64_t>(m_Buffers.GetBuffer(index));
+					entry.len = static_cast<uint32_t>(m_Buffers.GetBufferSize());
+					entry.buf_index = static_cast<uint16_t>(m_AreBuffersRegistered ? index : 0);
+					entry.user_data = MakeUserData(index, Operation::Read);
+
+					m_FileDescriptors[index] = result;
+					return 1;
+				}
+				case Operation::Read:
+				{
+					// a full buffer can mean the file is bigger than the buffer, so it is left to the search thread like a big file
+					if (result < 0 || static_cast<size_t>(result) == m_Buffers.GetBufferSize())
+					{
+						m_Buffers.Release(index);
+					}
+					else
+					{
+						file.Contents = ReadBuffer{ m_Buffers, index, static_cast<size_t>(result) };
+					}
+
+					TimedPush(m_ReadQueue, std::move(file), pCounters);
+
+					io_uring_sqe& entry{ m_Ring.GetEntry() };
+					entry.opcode = IORING_OP_CLOSE;
+					entry.fd = m_FileDescriptors[index];
+					entry.user_data = MakeUserData(index, Operation::Close);
+					return 1;
+				}
+				case Operation::Close:
+					return 0;
+				}
+
+				return 0;
+			}
+
+			IoRing m_Ring;
+			ReadBufferPool m_Buffers;
+			std::vector<FileEntry> m_Files; // the file being read into every buffer
+			std::vector<std::string> m_Paths; // the full path of every file being opened
+			std::vector<int> m_FileDescriptors;
+			FileQueue& m_FileQueue;
+			FileQueue& m_ReadQueue;
+			bool m_IsAvailable;
+			bool m_AreBuffersRegistered;
+		};
+#endif
+
+		/// <summary>
+		/// Walks the directory tree on a few threads while nrOfThreads threads run searchThread(fileQueue, threadIndex)
+		/// Where io_uring is available a FileReader thread sits in between, otherwise the search threads open and read every file themselves
+		/// Returns once every thread is done, with the number of files found. The counters of the walkers and the reader are added to pCounters
+		/// The walkers stop listing directories once the search is stopped. A search thread that is out of files helps the others with their huge files
+		/// </summary>
+		template<typename SearchThread>
+		size_t RunSearchPipeline(
+			const std::string& currentDir,
+			const FileMask& mask,
+			const uint32_t recursiveDepth,
+			const size_t nrOfThreads,
+			SearchControl& control,
+			SearchCounters* pCounters,
+			const SearchThread& searchThread)
+		{
+			const size_t nrOfWalkers{ std::max<size_t>(nrOfThreads / 4, 1) };
+
+			// everything the threads reference has to outlive them, the threads join when they go out of scope
+			FileQueue fileQueue{ FileQueueCapacity };
+			DirectoryWalker walker{ currentDir, mask, recursiveDepth, fileQueue, control.IsStopped, nrOfWalkers };
+			SearchHelpers helpers{ nrOfThreads };
+			std::vector<SearchCounters> walkerCounters(nrOfWalkers, MakeThreadCounters(pCounters));
+
+#ifdef RDW_SS_HAS_IO_URING
+			// the search threads take their files from the reader when there is one
+			FileQueue readQueue{ FileQueueCapacity };
+			FileReader reader{ fileQueue, readQueue };
+			SearchCounters readerCounters{ MakeThreadCounters(pCounters) };
+			FileQueue& searchQueue{ reader.IsAvailable() ? readQueue : fileQueue };
+#else
+			FileQueue& searchQueue{ fileQueue };
+#endif
+
+			{
+				std::vector<std::jthread> threads{};
+				threads.reserve(nrOfWalkers + nrOfThreads + 1);
+
+				for (size_t i{}; i < nrOfWalkers; ++i)
+				{
+					threads.emplace_back(&DirectoryWalker::Run, &walker, pCounters ? &walkerCounters[i] : nullptr);
+				}
+
+#ifdef RDW_SS_HAS_IO_URING
+				if (reader.IsAvailable())
+				{
+					threads.emplace_back(&FileReader::Run, &reader, pCounters ? &readerCounters : nullptr);
+				}
+#endif
+
+				control.pHelpers = &helpers;
+
+				for (size_t i{}; i < nrOfThreads; ++i)
+				{
+					threads.emplace_back([&searchThread, &searchQueue, &helpers, i]()->void
+						{
+							searchThread(searchQueue, i);
+							helpers.HelpUntilDone();
+						});
+				}
+			}
+
+			control.pHelpers = nullptr;
+
+			if (pCounters)
+			{
+				for (const SearchCounters& counters : walkerCounters)
+				{
+					pCounters->Add(counters);
+				}
+
+#ifdef RDW_SS_HAS_IO_URING
+				pCounters->Add(readerCounters);
+#endif
+			}
+
+			return walker.GetNrOfFilesFound();
+		}
+
+		/// <summary>
+		/// Also adds the counters of every thread to pCounters
+		/// </summary>
+		inline void MoveThreadResults(std::vector<ThreadResults>& threadResults, std::vector<FileSearchResult>& results, SearchCounters* pCounters)
+		{
+			size_t nrOfResults{ results.size() };
+			for (const ThreadResults& thread : threadResults)
+			{
+				nrOfResults += thread.Results.size();
+			}
+
+			results.reserve(nrOfResults);
+			for (ThreadResults& thread : threadResults)
+			{
+				std::move(thread.Results.begin(), thread.Results.end(), std::back_inserter(results));
+
+				if (pCounters) pCounters->Add(thread.Counters);
+			}
+		}
+
+		/// <summary>
+		/// Threads that are started once and then run one task at a time on all of them, so a long running process does not start threads for every search
+		/// </summary>
+		class ThreadPool final
+		{
+		public:
+			explicit ThreadPool(const size_t nrOfThreads)
+				: m_Mutex{}
+				, m_HasTask{}
+				, m_IsDone{}
+				, m_pTask{}
+				, m_TaskNumber{}
+				, m_NrOfBusyThreads{}
+				, m_Threads{}
+			{
+				m_Threads.reserve(nrOfThreads);
+
+				for (size_t i{}; i < nrOfThreads; ++i)
+				{
+					m_Threads.emplace_back([this, i](const std::stop_token stopToken)->void { Work(stopToken, i); });
+				}
+			}
+
+			ThreadPool(const ThreadPool&) noexcept = delete;
+			ThreadPool(ThreadPool&&) noexcept = delete;
+			ThreadPool& operator=(const ThreadPool&) noexcept = delete;
+			ThreadPool& operator=(ThreadPool&&) noexcept = delete;
+
+			/// <summary>
+			/// Calls task(threadIndex) on every thread, and returns once all of them are done
+			/// </summary>
+			void Run(const std::function<void(size_t)>& task)
+			{
+				std::unique_lock<std::mutex> lock{ m_Mutex };
+
+				m_pTask = &task;
+				m_NrOfBusyThreads = m_Threads.size();
+				++m_TaskNumber;
+				m_HasTask.notify_all();
+
+				m_IsDone.wait(lock, [this]() { return m_NrOfBusyThreads == 0; });
+				m_pTask = nullptr;
+			}
+
+			[[nodiscard]] size_t GetNrOfThreads() const { return m_Threads.size(); }
+
+		private:
+			void Work(const std::stop_token stopToken, const size_t threadIndex)
+			{
+				uint64_t lastTaskNumber{};
+
+				for (;;)
+				{
+					std::unique_lock<std::mutex> lock{ m_Mutex };
+					if (!m_HasTask.wait(lock, stopToken, [this, lastTaskNumber]() { return m_TaskNumber != lastTaskNumber; })) return;
+
+					lastTaskNumber = m_TaskNumber;
+					const std::function<void(size_t)>& task{ *m_pTask };
+					lock.unlock();
+
+					task(threadIndex);
+
+					lock.lock();
+					if (--m_NrOfBusyThreads == 0) m_IsDone.notify_one();
+				}
+			}
+
+			std::mutex m_Mutex;
+			std::condition_variable_any m_HasTask;
+			std::condition_variable m_IsDone;
+			const std::function<void(size_t)>* m_pTask;
+			uint64_t m_TaskNumber;
+			size_t m_NrOfBusyThreads;
+
+			// last, so the threads are stopped before anything they use is destroyed
+			std::vector<std::jthread> m_Threads;
+		};
+
+		/// <summary>
+		/// Searches a list of files that is known up front, the threads take the next file from a shared counter
+		/// Without a thread pool, threads are started for this search only
+		/// results is sorted by path and then by pattern
+		/// </summary>
+		template<typename Matcher>
+		void SearchListedFiles(
+			const std::vector<std::string>& filesToLookThrough,
+			const Matcher& matcher,
+			std::vector<FileSearchResult>& results,
+			SearchControl& control,
+			SearchCounters* pCounters,
+			ThreadPool* pThreadPool = nullptr)
+		{
+			const size_t nrOfThreads{ pThreadPool ? pThreadPool->GetNrOfThreads() : std::max<size_t>(std::min(GetNrOfSearchThreads(), filesToLookThrough.size()), 1) };
+			std::vector<ThreadResults> threadResults(nrOfThreads, ThreadResults{ {}, MakeThreadCounters(pCounters) });
+			std::atomic<size_t> nextFile{};
+			SearchHelpers helpers{ nrOfThreads };
+
+			const std::function<void(size_t)> search{ [&filesToLookThrough, &matcher, &nextFile, &threadResults, &control, &helpers, pCounters](const size_t threadIndex)->void
+				{
+					ThreadResults& thread{ threadResults[threadIndex] };
+
+					for (size_t file{ nextFile++ }; file < filesToLookThrough.size() && !control.IsSearchStopped(); file = nextFile++)
+					{
+						SearchFileForString(filesToLookThrough[file], matcher, thread.Results, control, pCounters ? &thread.Counters : nullptr);
+					}
+
+					helpers.HelpUntilDone();
+				} };
+
+			control.pHelpers = nrOfThreads > 1 ? &helpers : nullptr;
+
+			if (pThreadPool)
+			{
+				pThreadPool->Run(search);
+			}
+			else
+			{
+				std::vector<std::jthread> threads{};
+				threads.reserve(nrOfThreads);
+
+				for (size_t i{}; i < nrOfThreads; ++i)
+				{
+					threads.emplace_back(search, i);
+				}
+			}
+
+			control.pHelpers = nullptr;
+
+			const ScopedTimer timer{ pCounters, &SearchCounters::OutputTime };
+
+			MoveThreadResults(threadResults, results, pCounters);
+			SortResults(results);
+		}
+
+		template<typename Matcher>
+		void SearchFiles(
+			const std::string& currentDir,
+			const std::string& fileToSearch,
+			const Matcher& matcher,
+			const SearchOptions& options,
+			std::vector<FileSearchResult>& results)
+		{
+			const uint64_t startTime{ GetNanoseconds() };
+			SearchCounters counters{};
+			SearchCounters* const pCounters{ GetCountersToFill(options.pStatistics, counters) };
+			SearchControl control{ options.BinaryMode, options.Limits, {}, nullptr };
+
+			if (options.RecursivelySearch)
+			{
+				const size_t nrOfThreads{ GetNrOfSearchThreads() };
+				std::vector<ThreadResults> threadResults(nrOfThreads, ThreadResults{ {}, MakeThreadCounters(pCounters) });
+
+				const size_t nrOfFilesFound{ RunSearchPipeline(currentDir, options.Mask, options.RecursiveDepth, nrOfThreads, control, pCounters,
+					[&matcher, &threadResults, &control, pCounters](FileQueue& fileQueue, const size_t threadIndex)->void
+					{
+						ThreadResults& thread{ threadResults[threadIndex] };
+						SearchQueuedFilesForString(fileQueue, matcher, thread.Results, control, pCounters ? &thread.Counters : nullptr);
+					}) };
+
+				const ScopedTimer timer{ pCounters, &SearchCounters::OutputTime };
+				MoveThreadResults(threadResults, results, pCounters);
+
+				if (options.pStatistics)
+				{
+					options.pStatistics->NumberOfFilesSearched = static_cast<int32_t>(nrOfFilesFound);
+				}
+			}
+			else
+			{
+				const bool isSearched{ SearchFileForString(fileToSearch, matcher, results, control, pCounters) };
+
+				if (options.pStatistics)
+				{
+					options.pStatistics->NumberOfFilesSearched = isSearched ? 1 : 0;
+				}
+			}
+
+			{
+				const ScopedTimer timer{ pCounters, &SearchCounters::OutputTime };
+				SortResults(results);
+			}
+
+			SetStatistics(options.pStatistics, counters, startTime);
+		}
+
+		template<typename Matcher>
+		void StreamFiles(
+			const std::string& currentDir,
+			const std::string& fileToSearch,
+			const Matcher& matcher,
+			const SearchOptions& options,
+			const ResultCallback& onResult,
+			const size_t reorderWindow)
+		{
+			const uint64_t startTime{ GetNanoseconds() };
+			SearchCounters counters{};
+			SearchCounters* const pCounters{ GetCountersToFill(options.pStatistics, counters) };
+			SearchControl control{ options.BinaryMode, options.Limits, {}, nullptr };
+
+			if (!options.RecursivelySearch)
+			{
+				std::vector<FileSearchResult> results{};
+				const bool isSearched{ SearchFileForString(fileToSearch, matcher, results, control, pCounters) };
+
+				if (options.pStatistics)
+				{
+					options.pStatistics->NumberOfFilesSearched = isSearched ? 1 : 0;
+				}
+
+				{
+					const ScopedTimer timer{ pCounters, &SearchCounters::OutputTime };
+
+					for (FileSearchResult& result : results)
+					{
+						onResult(std::move(result));
+					}
+				}
+
+				SetStatistics(options.pStatistics, counters, startTime);
+				return;
+			}
+
+			const size_t nrOfThreads{ GetNrOfSearchThreads() };
+			std::vector<SearchCounters> threadCounters(nrOfThreads, MakeThreadCounters(pCounters));
+			SearchCounters writerCounters{ MakeThreadCounters(pCounters) };
+
+			ResultQueue resultQueue{ ResultQueueCapacity };
+			ResultWriter writer{ resultQueue, onResult, reorderWindow, pCounters ? &writerCounters : nullptr };
+			std::atomic<uint64_t> nextSequenceNumber{};
+
+			size_t nrOfFilesFound{};
+			{
+				const std::jthread writerThread{ &ResultWriter::Run, &writer };
+
+				nrOfFilesFound = RunSearchPipeline(currentDir, options.Mask, options.RecursiveDepth, nrOfThreads, control, pCounters,
+					[&matcher, &resultQueue, &nextSequenceNumber, &writer, &threadCounters, &control, pCounters](FileQueue& fileQueue, const size_t threadIndex)->void
+					{
+						StreamQueuedFilesForString(fileQueue, matcher, resultQueue, nextSequenceNumber, writer.IsOrdered(), control, pCounters ? &threadCounters[threadIndex] : nullptr);
+					});
+
+				// every search thread is done, so the writer can finish once it has drained the queue
+				resultQueue.Close();
+			}
+
+			if (options.pStatistics)
+			{
+				options.pStatistics->NumberOfFilesSearched = static_cast<int32_t>(nrOfFilesFound);
+			}
+
+			if (pCounters)
+			{
+				for (const SearchCounters& thread : threadCounters)
+				{
+					pCounters->Add(thread);
+				}
+
+				pCounters->Add(writerCounters);
+			}
+
+			SetStatistics(options.pStatistics, counters, startTime);
+		}
+
+		/// <summary>
+		/// Size and last write time of a file, a file counts as unchanged as long as both are the same
+		/// </summary>
+		struct FileInfo final
+		{
+			uint64_t Size;
+			int64_t ModificationTime;
+
+			bool operator==(const FileInfo&) const = default;
+		};
+
+		inline bool GetFileInfo(const std::string& path, FileInfo& info)
+		{
+#ifdef _WIN32
+			WIN32_FILE_ATTRIBUTE_DATA data{};
+			if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &data)) return false;
+
+			info.Size = (static_cast<uint64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+			info.ModificationTime = static_cast<int64_t>((static_cast<uint64_t>(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime);
+#else
+			struct stat fileStat {};
+			if (stat(path.c_str(), &fileStat) != 0) return false;
+
+			info.Size = static_cast<uint64_t>(fileStat.st_size);
+#ifdef __APPLE__
+			info.ModificationTime = static_cast<int64_t>(fileStat.st_mtimespec.tv_sec) * 1'000'000'000 + fileStat.st_mtimespec.tv_nsec;
+#else
+			info.ModificationTime = static_cast<int64_t>(fileStat.st_mtim.tv_sec) * 1'000'000'000 + fileStat.st_mtim.tv_nsec;
+#endif
+#endif
+
+			return true;
+		}
+
+		/// <summary>
+		/// Trigrams are folded to lowercase, so one index serves both case-sensitive and case-insensitive searches
+		/// </summary>
+		inline static constexpr uint32_t NrOfTrigrams{ 1u << 24 };
+
+		inline constexpr uint32_t AddToTrigram(const uint32_t trigram, const char c)
+		{
+			return ((trigram << 8) | static_cast<unsigned char>(ToLowercase(c))) & (NrOfTrigrams - 1);
+		}
+
+		/// <summary>
+		/// Collects the distinct trigrams of a file, with one bit per possible trigram (2 MiB) that is reused for every file
+		/// Trigrams spanning a newline are left out, a match never does
+		/// </summary>
+		class TrigramCollector final
+		{
+		public:
+			TrigramCollector()
+				: m_IsSeen(NrOfTrigrams / 64)
+				, m_Trigram{}
+				, m_NrOfBytesInTrigram{}
+			{}
+
+			/// <summary>
+			/// Returns false if the file could not be opened, trigrams is sorted
+			/// </summary>
+			bool Collect(const std::string& path, std::vector<uint32_t>& trigrams)
+			{
+				trigrams.clear();
+
+				MappedFile file{ path };
+				if (!file.IsOpen()) return false;
+
+				m_Trigram = 0;
+				m_NrOfBytesInTrigram = 0;
+
+				if (file.IsMapped())
+				{
+					Add(file.GetView(), trigrams);
+				}
+				else
+				{
+					// the last bytes of a block are kept in m_Trigram, so no trigram spanning two blocks is lost
+					std::vector<char> buffer(ReadBlockSize);
+					while (const size_t bytesRead{ file.Read(buffer.data(), buffer.size()) })
+					{
+						Add(std::string_view{ buffer.data(), bytesRead }, trigrams);
+					}
+				}
+
+				for (const uint32_t trigram : trigrams)
+				{
+					m_IsSeen[trigram / 64] = 0;
+				}
+
+				std::sort(trigrams.begin(), trigrams.end());
+				return true;
+			}
+
+		private:
+			void Add(const std::string_view data, std::vector<uint32_t>& trigrams)
+			{
+				uint32_t trigram{ m_Trigram };
+				uint32_t nrOfBytesInTrigram{ m_NrOfBytesInTrigram };
+
+				for (const char c : data)
+				{
+					if (c == '\n')
+					{
+						nrOfBytesInTrigram = 0;
+						continue;
+					}
+
+					trigram = AddToTrigram(trigram, c);
+					if (++nrOfBytesInTrigram < 3) continue;
+
+					uint64_t& bits{ m_IsSeen[trigram / 64] };
+					const uint64_t bit{ uint64_t{ 1 } << (trigram % 64) };
+					if (bits & bit) continue;
+
+					bits |= bit;
+					trigrams.push_back(trigram);
+				}
+
+				m_Trigram = trigram;
+				m_NrOfBytesInTrigram = nrOfBytesInTrigram;
+			}
+
+			std::vector<uint64_t> m_IsSeen;
+			uint32_t m_Trigram;
+			uint32_t m_NrOfBytesInTrigram;
+		};
+
+		/// <summary>
+		/// On-disk layout of an index, written in the byte order of the machine that built it:
+		/// header, file records, trigram records sorted by trigram, posting lists, paths
+		/// A posting list holds the ids of the files containing a trigram, ascending and stored as LEB128 encoded differences
+		/// The paths section starts with the root directory, file paths are relative to it
+		/// </summary>
+		inline static constexpr char IndexMagic[8]{ 'R', 'D', 'W', 'S', 'S', 'I', 'D', 'X' };
+		inline static constexpr uint32_t IndexVersion{ 1 };
+
+		struct IndexHeader final
+		{
+			char Magic[8];
+			uint32_t Version;
+			uint32_t NrOfFiles;
+			uint64_t NrOfTrigrams;
+			uint64_t FilesOffset;
+			uint64_t TrigramsOffset;
+			uint64_t PostingsOffset;
+			uint64_t PathsOffset;
+			uint64_t PathsSize;
+			uint64_t RootDirSize;
+		};
+
+		struct IndexFileRecord final
+		{
+			uint64_t PathOffset; // from the start of the paths section
+			uint64_t PathSize;
+			FileInfo Info;
+		};
+
+		struct IndexTrigramRecord final
+		{
+			uint32_t Trigram;
+			uint32_t NrOfFiles;
+			uint64_t PostingsOffset; // from the start of the postings section
+			uint64_t PostingsSize;
+		};
+
+		/// <summary>
+		/// Read-only view of an index file, which is memory-mapped so only the posting lists a query needs are read from disk
+		/// </summary>
+		class TrigramIndex final
+		{
+		public:
+			inline static constexpr uint32_t NoFile{ std::numeric_limits<uint32_t>::max() };
+
+			explicit TrigramIndex(const std::string& indexFile)
+				: m_File{ indexFile }
+				, m_Header{}
+				, m_IsValid{}
+			{
+				if (!m_File.IsMapped()) return;
+
+				const std::string_view view{ m_File.GetView() };
+				if (view.size() < sizeof(IndexHeader)) return;
+
+				std::memcpy(&m_Header, view.data(), sizeof(IndexHeader));
+				if (std::memcmp(m_Header.Magic, IndexMagic, sizeof(IndexMagic)) != 0 || m_Header.Version != IndexVersion) return;
+
+				const auto isSectionValid{ [&view](const uint64_t offset, const uint64_t size)->bool
+					{
+						return offset <= view.size() && size <= view.size() - offset;
+					} };
+
+				m_IsValid = isSectionValid(m_Header.FilesOffset, uint64_t{ m_Header.NrOfFiles } * sizeof(IndexFileRecord))
+					&& m_Header.NrOfTrigrams <= NrOfTrigrams
+					&& isSectionValid(m_Header.TrigramsOffset, m_Header.NrOfTrigrams * sizeof(IndexTrigramRecord))
+					&& isSectionValid(m_Header.PostingsOffset, 0)
+					&& isSectionValid(m_Header.PathsOffset, m_Header.PathsSize)
+					&& m_Header.RootDirSize <= m_Header.PathsSize;
+			}
+
+			TrigramIndex(const TrigramIndex&) noexcept = delete;
+			TrigramIndex(TrigramIndex&&) noexcept = delete;
+			TrigramIndex& operator=(const TrigramIndex&) noexcept = delete;
+			TrigramIndex& operator=(TrigramIndex&&) noexcept = delete;
+
+			[[nodiscard]] bool IsValid() const { return m_IsValid; }
+
+			[[nodiscard]] std::string_view GetRootDir() const
+			{
+				return m_File.GetView().substr(m_Header.PathsOffset, m_Header.RootDirSize);
+			}
+
+			[[nodiscard]] uint32_t GetNrOfFiles() const { return m_Header.NrOfFiles; }
+
+			/// <summary>
+			/// Relative to the root directory
+			/// </summary>
+			[[nodiscard]] std::string_view GetPath(const uint32_t fileId) const
+			{
+				const IndexFileRecord record{ GetFileRecord(fileId) };
+				if (record.PathOffset > m_Header.PathsSize || record.PathSize > m_Header.PathsSize - record.PathOffset) return {};
+
+				return m_File.GetView().substr(m_Header.PathsOffset + record.PathOffset, record.PathSize);
+			}
+
+			[[nodiscard]] FileInfo GetFileInfo(const uint32_t fileId) const { return GetFileRecord(fileId).Info; }
+
+			/// <summary>
+			/// Returns the number of files containing trigram, without decoding them
+			/// </summary>
+			[[nodiscard]] uint32_t GetNrOfFilesWithTrigram(const uint32_t trigram) const
+			{
+				IndexTrigramRecord record{};
+				return FindTrigram(trigram, record) ? record.NrOfFiles : 0;
+			}
+
+			/// <summary>
+			/// fileIds gets the ids of the files containing trigram, ascending
+			/// </summary>
+			void GetFilesWithTrigram(const uint32_t trigram, std::vector<uint32_t>& fileIds) const
+			{
+				fileIds.clear();
+
+				IndexTrigramRecord record{};
+				if (!FindTrigram(trigram, record)) return;
+
+				DecodePostings(record, [&fileIds](const uint32_t fileId)->void { fileIds.push_back(fileId); });
+			}
+
+			/// <summary>
+			/// Calls onPosting(trigram, fileId) for every file of every trigram
+			/// </summary>
+			template<typename Callback>
+			void ForEachPosting(Callback&& onPosting) const
+			{
+				for (uint64_t i{}; i < m_Header.NrOfTrigrams; ++i)
+				{
+					const IndexTrigramRecord record{ GetTrigramRecord(i) };
+					DecodePostings(record, [&onPosting, &record](const uint32_t fileId)->void { onPosting(record.Trigram, fileId); });
+				}
+			}
+
+		private:
+			template<typename T>
+			[[nodiscard]] T ReadRecord(const uint64_t offset) const
+			{
+				// the view is only guaranteed to be byte aligned
+				T record{};
+				std::memcpy(&record, m_File.GetView().data() + offset, sizeof(T));
+				return record;
+			}
+
+			[[nodiscard]] IndexFileRecord GetFileRecord(const uint32_t fileId) const
+			{
+				return ReadRecord<IndexFileRecord>(m_Header.FilesOffset + uint64_t{ fileId } * sizeof(IndexFileRecord));
+			}
+
+			[[nodiscard]] IndexTrigramRecord GetTrigramRecord(const uint64_t index) const
+			{
+				return ReadRecord<IndexTrigramRecord>(m_Header.TrigramsOffset + index * sizeof(IndexTrigramRecord));
+			}
+
+			bool FindTrigram(const uint32_t trigram, IndexTrigramRecord& record) const
+			{
+				uint64_t low{}, high{ m_Header.NrOfTrigrams };
+				while (low < high)
+				{
+					const uint64_t middle{ low + (high - low) / 2 };
+					record = GetTrigramRecord(middle);
+
+					if (record.Trigram == trigram) return true;
+
+					if (record.Trigram < trigram) low = middle + 1;
+					else high = middle;
+				}
+
+				return false;
+			}
+
+			template<typename Callback>
+			void DecodePostings(const IndexTrigramRecord& record, Callback&& onFile) const
+			{
+				const std::string_view view{ m_File.GetView() };
+				const uint64_t postingsSize{ view.size() - m_Header.PostingsOffset };
+				if (record.PostingsOffset > postingsSize || record.PostingsSize > postingsSize - record.PostingsOffset) return;
+
+				const unsigned char* pData{ reinterpret_cast<const unsigned char*>(view.data() + m_Header.PostingsOffset + record.PostingsOffset) };
+				const unsigned char* const pEnd{ pData + record.PostingsSize };
+
+				uint32_t fileId{};
+				for (uint32_t i{}; i < record.NrOfFiles && pData != pEnd; ++i)
+				{
+					uint32_t delta{};
+					for (uint32_t shift{}; pData != pEnd && shift < 32; shift += 7)
+					{
+						const unsigned char byte{ *pData++ };
+						delta |= static_cast<uint32_t>(byte & 0x7F) << shift;
+
+						if ((byte & 0x80) == 0) break;
+					}
+
+					fileId += delta;
+					if (fileId >= m_Header.NrOfFiles) return;
+
+					onFile(fileId);
+				}
+			}
+
+			MappedFile m_File;
+			IndexHeader m_Header;
+			bool m_IsValid;
+		};
+
+		inline void AppendLEB128(std::string& data, uint32_t value)
+		{
+			while (value >= 0x80)
+			{
+				data += static_cast<char>((value & 0x7F) | 0x80);
+				value >>= 7;
+			}
+
+			data += static_cast<char>(value);
+		}
+
+		/// <summary>
+		/// Writes the index to a temporary file first and then replaces indexFile, so a failed build never leaves a broken index behind
+		/// postings holds (trigram << 32 | fileId) pairs, sorted
+		/// </summary>
+		inline bool WriteTrigramIndex(
+			const std::string& indexFile,
+			const std::string& rootDir,
+			const std::vector<std::string>& paths,
+			const std::vector<FileInfo>& fileInfos,
+			const std::vector<uint64_t>& postings)
+		{
+			std::string pathData{ rootDir };
+			std::vector<IndexFileRecord> fileRecords{};
+			fileRecords.reserve(paths.size());
+
+			for (size_t i{}; i < paths.size(); ++i)
+			{
+				fileRecords.push_back(IndexFileRecord{ pathData.size(), paths[i].size(), fileInfos[i] });
+				pathData += paths[i];
+			}
+
+			std::vector<IndexTrigramRecord> trigramRecords{};
+			std::string postingData{};
+
+			for (size_t i{}; i < postings.size();)
+			{
+				const uint32_t trigram{ static_cast<uint32_t>(postings[i] >> 32) };
+				const size_t postingsOffset{ postingData.size() };
+
+				uint32_t previousFileId{}, nrOfFiles{};
+				for (; i < postings.size() && static_cast<uint32_t>(postings[i] >> 32) == trigram; ++i)
+				{
+					const uint32_t fileId{ static_cast<uint32_t>(postings[i]) };
+					AppendLEB128(postingData, fileId - previousFileId);
+
+					previousFileId = fileId;
+					++nrOfFiles;
+				}
+
+				trigramRecords.push_back(IndexTrigramRecord{ trigram, nrOfFiles, postingsOffset, postingData.size() - postingsOffset });
+			}
+
+			IndexHeader header{};
+			std::memcpy(header.Magic, IndexMagic, sizeof(IndexMagic));
+			header.Version = IndexVersion;
+			header.NrOfFiles = static_cast<uint32_t>(fileRecords.size());
+			header.NrOfTrigrams = trigramRecords.size();
+			header.FilesOffset = sizeof(IndexHeader);
+			header.TrigramsOffset = header.FilesOffset + fileRecords.size() * sizeof(IndexFileRecord);
+			header.PostingsOffset = header.TrigramsOffset + trigramRecords.size() * sizeof(IndexTrigramRecord);
+			header.PathsOffset = header.PostingsOffset + postingData.size();
+			header.PathsSize = pathData.size();
+			header.RootDirSize = rootDir.size();
+
+			const std::string temporaryFile{ indexFile + ".tmp" };
+			{
+				std::ofstream stream{ temporaryFile, std::ios::binary | std::ios::trunc };
+				if (!stream.is_open()) return false;
+
+				stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+				stream.write(reinterpret_cast<const char*>(fileRecords.data()), static_cast<std::streamsize>(fileRecords.size() * sizeof(IndexFileRecord)));
+				stream.write(reinterpret_cast<const char*>(trigramRecords.data()), static_cast<std::streamsize>(trigramRecords.size() * sizeof(IndexTrigramRecord)));
+				stream.write(postingData.data(), static_cast<std::streamsize>(postingData.size()));
+				stream.write(pathData.data(), static_cast<std::streamsize>(pathData.size()));
+
+				if (!stream.good()) return false;
+			}
+
+			std::error_code error{};
+			std::filesystem::rename(temporaryFile, indexFile, error);
+
+			return !error;
+		}
+
+		inline bool BuildTrigramIndex(
+			const std::string& rootDir,
+			const FileMask& mask,
+			const uint32_t recursiveDepth,
+			const std::string& indexFile,
+			uint32_t& nrOfFilesIndexed,
+			uint32_t& nrOfFilesReused)
+		{
+			std::vector<std::string> files{ GetAllFilesInDirectory(rootDir, mask, recursiveDepth) };
+
+			// the index can live inside the directory it indexes, but should not index itself
+			const std::string absoluteIndexFile{ std::filesystem::absolute(indexFile).lexically_normal().string() };
+			std::erase_if(files, [&absoluteIndexFile](const std::string& file)->bool
+				{
+					return file == absoluteIndexFile || file == absoluteIndexFile + ".tmp";
+				});
+
+			std::sort(files.begin(), files.end());
+
+			std::vector<std::string> paths{};
+			std::vector<FileInfo> fileInfos{};
+			paths.reserve(files.size());
+			fileInfos.reserve(files.size());
+
+			for (const std::string& file : files)
+			{
+				FileInfo info{};
+				if (!GetFileInfo(file, info)) continue;
+
+				paths.push_back(file.substr(std::min(rootDir.size() + 1, file.size())));
+				fileInfos.push_back(info);
+			}
+
+			std::vector<uint64_t> postings{};
+			std::vector<bool> isIndexed(paths.size());
+			nrOfFilesReused = 0;
+
+			// unchanged files keep the trigrams of the old index, only new and changed files are read
+			{
+				const TrigramIndex oldIndex{ indexFile };
+				if (oldIndex.IsValid() && oldIndex.GetRootDir() == rootDir)
+				{
+					std::unordered_map<std::string_view, uint32_t> fileIds{};
+					for (size_t i{}; i < paths.size(); ++i)
+					{
+						fileIds.emplace(paths[i], static_cast<uint32_t>(i));
+					}
+
+					std::vector<uint32_t> newFileIds(oldIndex.GetNrOfFiles(), TrigramIndex::NoFile);
+					for (uint32_t oldFileId{}; oldFileId < oldIndex.GetNrOfFiles(); ++oldFileId)
+					{
+						const auto it{ fileIds.find(oldIndex.GetPath(oldFileId)) };
+						if (it == fileIds.end() || oldIndex.GetFileInfo(oldFileId) != fileInfos[it->second]) continue;
+
+						newFileIds[oldFileId] = it->second;
+						isIndexed[it->second] = true;
+						++nrOfFilesReused;
+					}
+
+					oldIndex.ForEachPosting([&postings, &newFileIds](const uint32_t trigram, const uint32_t oldFileId)->void
+						{
+							if (newFileIds[oldFileId] != TrigramIndex::NoFile) postings.push_back((uint64_t{ trigram } << 32) | newFileIds[oldFileId]);
+						});
+				}
+			}
+
+			std::vector<uint32_t> filesToIndex{};
+			for (size_t i{}; i < paths.size(); ++i)
+			{
+				if (!isIndexed[i]) filesToIndex.push_back(static_cast<uint32_t>(i));
+			}
+
+			nrOfFilesIndexed = static_cast<uint32_t>(filesToIndex.size());
+
+			struct alignas(64) ThreadPostings final
+			{
+				std::vector<uint64_t> Postings;
+			};
+
+			const size_t nrOfThreads{ std::max<size_t>(std::min(GetNrOfSearchThreads(), filesToIndex.size()), 1) };
+			std::vector<ThreadPostings> threadPostings(nrOfThreads);
+			std::atomic<size_t> nextFile{};
+
+			{
+				std::vector<std::jthread> threads{};
+				threads.reserve(nrOfThreads);
+
+				for (size_t i{}; i < nrOfThreads; ++i)
+				{
+					threads.emplace_back([&rootDir, &paths, &filesToIndex, &nextFile, &postings = threadPostings[i].Postings]()->void
+						{
+							TrigramCollector collector{};
+							std::vector<uint32_t> trigrams{};
+
+							for (size_t file{ nextFile++ }; file < filesToIndex.size(); file = nextFile++)
+							{
+								const uint32_t fileId{ filesToIndex[file] };
+								const std::string path{ rootDir + PathSeparator + paths[fileId] };
+
+								if (!collector.Collect(path, trigrams))
+								{
+									PrintMessage("Could not open file: ", path);
+									continue;
+								}
+
+								for (const uint32_t trigram : trigrams)
+								{
+									postings.push_back((uint64_t{ trigram } << 32) | fileId);
+								}
+							}
+						});
+				}
+			}
+
+			for (ThreadPostings& thread : threadPostings)
+			{
+				postings.insert(postings.end(), thread.Postings.begin(), thread.Postings.end());
+				std::vector<uint64_t>{}.swap(thread.Postings);
+			}
+
+			std::sort(postings.begin(), postings.end());
+
+			return WriteTrigramIndex(indexFile, rootDir, paths, fileInfos, postings);
+		}
+
+		/// <summary>
+		/// Marks the files that contain every trigram of literal, starting from the rarest trigram
+		/// Literals shorter than a trigram can be in any file
+		/// </summary>
+		inline void MarkFilesWithLiteral(const TrigramIndex& index, const std::string_view literal, std::vector<bool>& isCandidate)
+		{
+			if (literal.size() < 3)
+			{
+				isCandidate.assign(isCandidate.size(), true);
+				return;
+			}
+
+			std::vector<std::pair<uint32_t, uint32_t>> trigrams{}; // number of files, trigram
+			uint32_t trigram{};
+			for (size_t i{}; i < literal.size(); ++i)
+			{
+				trigram = AddToTrigram(trigram, literal[i]);
+				if (i >= 2) trigrams.emplace_back(index.GetNrOfFilesWithTrigram(trigram), trigram);
+			}
+
+			std::sort(trigrams.begin(), trigrams.end());
+			trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+			std::vector<uint32_t> fileIds{}, trigramFileIds{}, intersection{};
+			index.GetFilesWithTrigram(trigrams.front().second, fileIds);
+
+			for (size_t i{ 1 }; i < trigrams.size() && !fileIds.empty(); ++i)
+			{
+				index.GetFilesWithTrigram(trigrams[i].second, trigramFileIds);
+
+				intersection.clear();
+				std::set_intersection(fileIds.begin(), fileIds.end(), trigramFileIds.begin(), trigramFileIds.end(), std::back_inserter(intersection));
+				fileIds.swap(intersection);
+			}
+
+			for (const uint32_t fileId : fileIds)
+			{
+				isCandidate[fileId] = true;
+			}
+		}
+
+		/// <summary>
+		/// Searches the files of an index that can contain a match, and every file that changed since the index was built
+		/// Returns the number of files searched
+		/// </summary>
+		template<typename Matcher>
+		size_t SearchIndexedFiles(
+			const TrigramIndex& index,
+			const FileMask& mask,
+			const Matcher& matcher,
+			std::vector<FileSearchResult>& results,
+			SearchControl& control,
+			SearchCounters* pCounters)
+		{
+			// picking the files to search replaces walking the directory tree, so it counts as enumeration
+			const uint64_t enumerationStart{ IsMeasuringPhases(pCounters) ? GetNanoseconds() : 0 };
+			const uint32_t nrOfFiles{ index.GetNrOfFiles() };
+
+			std::vector<std::string> literals{};
+			std::vector<bool> isCandidate(nrOfFiles, true);
+
+			if (matcher.GetRequiredLiterals(literals))
+			{
+				isCandidate.assign(nrOfFiles, false);
+
+				for (const std::string& literal : literals)
+				{
+					MarkFilesWithLiteral(index, literal, isCandidate);
+				}
+			}
+
+			const std::string rootDir{ index.GetRootDir() };
+			std::vector<std::string> filesToSearch{};
+			std::string maskedPath{};
+
+			for (uint32_t fileId{}; fileId < nrOfFiles; ++fileId)
+			{
+				const std::string_view relativePath{ index.GetPath(fileId) };
+
+				// the index only holds what passed the ignore files when it was built, the mask can still narrow it down
+				maskedPath.assign(relativePath);
+				std::replace(maskedPath.begin(), maskedPath.end(), PathSeparator, '/');
+
+				if (!mask.IsPathIncluded(maskedPath)) continue;
+
+				std::string path{ rootDir + PathSeparator };
+				path += relativePath;
+
+				// the index knows nothing about what changed since it was built, so changed files are searched regardless
+				FileInfo info{};
+				if (!GetFileInfo(path, info)) continue;
+
+				if (isCandidate[fileId] || info != index.GetFileInfo(fileId))
+				{
+					filesToSearch.push_back(std::move(path));
+				}
+			}
+
+			if (IsMeasuringPhases(pCounters)) pCounters->EnumerationTime += GetNanoseconds() - enumerationStart;
+
+			SearchListedFiles(filesToSearch, matcher, results, control, pCounters);
+
+			return filesToSearch.size();
+		}
+
+		template<typename Matcher>
+		bool SearchIndex(
+			const std::string& indexFile,
+			const Matcher& matcher,
+			const SearchOptions& options,
+			std::vector<FileSearchResult>& results)
+		{
+			const uint64_t startTime{ GetNanoseconds() };
+			SearchCounters counters{};
+
+			const TrigramIndex index{ indexFile };
+			if (!index.IsValid())
+			{
+				std::cout << "Could not open index: " << indexFile << "\n";
+				return false;
+			}
+
+			SearchControl control{ options.BinaryMode, options.Limits, {}, nullptr };
+			const size_t nrOfFilesSearched{ SearchIndexedFiles(index, options.Mask, matcher, results, control, GetCountersToFill(options.pStatistics, counters)) };
+
+			if (options.pStatistics)
+			{
+				options.pStatistics->NumberOfFilesSearched = static_cast<int32_t>(nrOfFilesSearched);
+			}
+
+			SetStatistics(options.pStatistics, counters, startTime);
+
+			return true;
+		}
+
+		/// <summary>
+		/// Every public regex and fuzzy search goes through here: search(matcher) searches files, an index or a cache with the compiled matcher
+		/// A matcher that can fail to compile, one with IsValid(), is checked first. If it is invalid its error is printed and nothing is searched
+		/// Returns false if nothing was searched, either because of the matcher or because search returned false
+		/// </summary>
+		template<typename Matcher, typename Search>
+		bool SearchWithMatcher(const Matcher& matcher, Search&& search)
+		{
+			if constexpr (requires { matcher.IsValid(); })
+			{
+				if (!matcher.IsValid())
+				{
+					std::cout << matcher.GetError() << "\n";
+					return false;
+				}
+			}
+
+			if constexpr (std::is_void_v<std::invoke_result_t<Search, const Matcher&>>)
+			{
+				search(matcher);
+				return true;
+			}
+			else
+			{
+				return search(matcher);
+			}
+		}
+	}
+
+	/// <summary>
+	/// Searches for all strings in a single pass over every file
+	/// Every search thread keeps its own results, they are only merged once all files have been searched
+	/// results is overwritten, and sorted by path and then by pattern so the output of two searches can be diffed
+	/// </summary>
+	inline static void IsStringInFile(
+		const std::string& currentDir,
+		const std::string& fileToSearch,
+		const std::vector<std::string>& stringsToSearch,
+		const SearchOptions& options,
+		std::vector<FileSearchResult>& results)
+	{
+		results.clear();
+
+		Detail::DispatchStringMatcher(stringsToSearch, options.IgnoreCase, [&](const auto& matcher)->void
+			{
+				Detail::SearchFiles(currentDir, fileToSearch, matcher, options, results);
+			});
+	}
+
+	/// <summary>
+	/// Streams the results instead of collecting them: onResult gets the results of every file as soon as it has been searched,
+	/// so memory stays flat however many matches there are
+	/// With reorderWindow 0 results come in the order the files finish. Otherwise they come in the order the files were picked up,
+	/// with a file that takes long holding back at most reorderWindow files that finished after it
+	/// </summary>
+	inline static void IsStringInFile(
+		const std::string& currentDir,
+		const std::string& fileToSearch,
+		const std::vector<std::string>& stringsToSearch,
+		const SearchOptions& options,
+		const ResultCallback& onResult,
+		const size_t reorderWindow)
+	{
+		Detail::DispatchStringMatcher(stringsToSearch, options.IgnoreCase, [&](const auto& matcher)->void
+			{
+				Detail::StreamFiles(currentDir, fileToSearch, matcher, options, onResult, reorderWindow);
+			});
+	}
+
+	/// <summary>
+	/// IsStringInFile for a string known at compile time, see FixedPattern
+	/// The pattern decides whether case is ignored, options.IgnoreCase is not used
+	/// </summary>
+	template<FixedString Needle, bool IgnoreCase>
+	inline static void IsStringInFile(
+		const std::string& currentDir,
+		const std::string& fileToSearch,
+		const FixedPattern<Needle, IgnoreCase>&,
+		const SearchOptions& options,
+		std::vector<FileSearchResult>& results)
+	{
+		results.clear();
+
+		const Detail::FixedPatternMatcher<FixedPattern<Needle, IgnoreCase>> matcher{};
+		Detail::SearchFiles(currentDir, fileToSearch, matcher, options, results);
+	}
+
+	/// <summary>
+	/// Streaming version of IsStringInFile for a string known at compile time, see FixedPattern
+	/// </summary>
+	template<FixedString Needle, bool IgnoreCase>
+	inline static void IsStringInFile(
+		const std::string& currentDir,
+		const std::string& fileToSearch,
+		const FixedPattern<Needle, IgnoreCase>&,
+		const SearchOptions& options,
+		const ResultCallback& onResult,
+		const size_t reorderWindow)
+	{
+		const Detail::FixedPatternMatcher<FixedPattern<Needle, IgnoreCase>> matcher{};
+		Detail::StreamFiles(currentDir, fileToSearch, matcher, options, onResult, reorderWindow);
+	}
+
+	/// <summary>
+	/// foundStrings gets one map per string, in the same order as stringsToSearch
+	/// </summary>
+	inline static void IsStringInFile(
+		const std::string& currentDir,
+		const std::string& fileToSearch,
+		const std::vector<std::string>& stringsToSearch,
+		const SearchOptions& options,
+		std::vector<std::unordered_map<std::string, std::vector<uint32_t>>>& foundStrings)
+	{
+		std::vector<FileSearchResult> results{};
+		IsStringInFile(currentDir, fileToSearch, stringsToSearch, options, results);
+
+		foundStrings.resize(stringsToSearch.size());
+		Detail::AddResultsToMaps(results, foundStrings.data());
+	}
+
+	/// <summary>
+	/// The original signature, kept so existing callers still compile. Binary files are skipped and nothing is limited
+	/// </summary>
+	inline static void IsStringInFile(
+		const std::string& currentDir,
+		const std::string& fileToSearch,
+		const std::string& mask,
+		const std::string& stringToSearch,
+		const bool ignoreCase,
+		const bool recursivelySearch,
+		const uint32_t recursiveDepth,
+		std::unordered_map<std::string, std::vector<uint32_t>>& foundStrings,
+		StringSearchStatistics* pStatistics)
+	{
+		const SearchOptions options{ mask, ignoreCase, recursivelySearch, recursiveDepth, BinaryFileMode::Skip, SearchLimits{}, pStatistics };
+
+		std::vector<FileSearchResult> results{};
+		IsStringInFile(currentDir, fileToSearch, std::vector<std::string>{ stringToSearch }, options, results);
+
+		Detail::AddResultsToMaps(results, &foundStrings);
+	}
+
+	/// <summary>
+	/// Same as IsStringInFile, but every string is a regular expression that has to match somewhere on a line
+	/// Returns false if one of the regexes is invalid, in which case nothing is searched
+	/// </summary>
+	inline static bool IsRegexInFile(
+		const std::string& currentDir,
+		const std::string& fileToSearch,
+		const std::vector<std::string>& regexesToSearch,
+		const SearchOptions& options,
+		std::vector<FileSearchResult>& results)
+	{
+		results.clear();
+
+		return Detail::SearchWithMatcher(Detail::RegexMatcher{ regexesToSearch, options.IgnoreCase }, [&](const auto& matcher)->void
+			{
+				Detail::SearchFiles(currentDir, fileToSearch, matcher, options, results);
+			});
+	}
+
+	/// <summary>
+	/// Streaming version of IsRegexInFile, see the streaming IsStringInFile
+	/// </summary>
+	inline static bool IsRegexInFile(
+		const std::string& currentDir,
+		const std::string& fileToSearch,
+		const std::vector<std::string>& regexesToSearch,
+		const SearchOptions& options,
+		const ResultCallback& onResult,
+		const size_t reorderWindow)
+	{
+		return Detail::SearchWithMatcher(Detail::RegexMatcher{ regexesToSearch, options.IgnoreCase }, [&](const auto& matcher)->void
+			{
+				Detail::StreamFiles(currentDir, fileToSearch, matcher, options, onResult, reorderWindow);
+			});
+	}
+
+	/// <summary>
+	/// foundStrings gets one map per regex, in the same order as regexesToSearch
+	/// </summary>
+	inline static bool IsRegexInFile(
+		const std::string& currentDir,
+		const std::string& fileToSearch,
+		const std::vector<std::string>& regexesToSearch,
+		const SearchOptions& options,
+		std::vector<std::unordered_map<std::string, std::vector<uint32_t>>>& foundStrings)
+	{
+		std::vector<FileSearchResult> results{};
+		if (!IsRegexInFile(currentDir, fileToSearch, regexesToSearch, options, results)) return false;
+
+		foundStrings.resize(regexesToSearch.size());
+		Detail::AddResultsToMaps(results, foundStrings.data());
+
+		return true;
+	}
+
+	/// <summary>
+	/// Same as IsStringInFile, but a line also matches when it holds the string with up to maxNrOfErrors characters inserted, deleted or substituted
+	/// </summary>
+	inline static void IsFuzzyStringInFile(
+		const std::string& currentDir,
+		const std::string& fileToSearch,
+		const std::vector<std::string>& stringsToSearch,
+		const uint32_t maxNrOfErrors,
+		const SearchOptions& options,
+		std::vector<FileSearchResult>& results)
+	{
+		results.clear();
+
+		Detail::SearchWithMatcher(Detail::FuzzyMatcher{ stringsToSearch, maxNrOfErrors, options.IgnoreCase }, [&](const auto& matcher)->void
+			{
+				Detail::SearchFiles(currentDir, fileToSearch, matcher, options, results);
+			});
+	}
+
+	/// <summary>
+	/// Streaming version of IsFuzzyStringInFile, see the streaming IsStringInFile
+	/// </summary>
+	inline static void IsFuzzyStringInFile(
+		const std::string& currentDir,
+		const std::string& fileToSearch,
+		const std::vector<std::string>& stringsToSearch,
+		const uint32_t maxNrOfErrors,
+		const SearchOptions& options,
+		const ResultCallback& onResult,
+		const size_t reorderWindow)
+	{
+		Detail::SearchWithMatcher(Detail::FuzzyMatcher{ stringsToSearch, maxNrOfErrors, options.IgnoreCase }, [&](const auto& matcher)->void
+			{
+				Detail::StreamFiles(currentDir, fileToSearch, matcher, options, onResult, reorderWindow);
+			});
+	}
+
+	/// <summary>
+	/// Compiles its patterns once and searches them as often as needed, in buffers that are already in memory or in files
+	/// Buffers are searched in place, every matching line goes to a callback without being copied or collected
+	/// Searching is const, so one Searcher can be used by several threads at the same time
+	/// </summary>
+	class Searcher final
+	{
+	public:
+		/// <summary>
+		/// With isRegex every pattern is a regular expression, in which case IsValid() tells whether all of them could be compiled
+		/// </summary>
+		Searcher(const std::vector<std::string>& patterns, const bool ignoreCase, const bool isRegex)
+			: m_Matcher{ MakeMatcher(patterns, ignoreCase, isRegex) }
+		{}
+
+		Searcher(const Searcher&) noexcept = delete;
+		Searcher(Searcher&&) noexcept = delete;
+		Searcher& operator=(const Searcher&) noexcept = delete;
+		Searcher& operator=(Searcher&&) noexcept = delete;
+
+		[[nodiscard]] bool IsValid() const
+		{
+			const Detail::RegexMatcher* pRegexMatcher{ std::get_if<Detail::RegexMatcher>(&m_Matcher) };
+			return !pRegexMatcher || pRegexMatcher->IsValid();
+		}
+
+		/// <summary>
+		/// Empty if IsValid()
+		/// </summary>
+		[[nodiscard]] std::string GetError() const
+		{
+			const Detail::RegexMatcher* pRegexMatcher{ std::get_if<Detail::RegexMatcher>(&m_Matcher) };
+			return pRegexMatcher ? pRegexMatcher->GetError() : std::string{};
+		}
+
+		[[nodiscard]] size_t GetNrOfPatterns() const
+		{
+			return std::visit([](const auto& matcher)->size_t { return matcher.GetNrOfPatterns(); }, m_Matcher);
+		}
+
+		/// <summary>
+		/// Calls onMatch(const BufferMatch&) once for every line of buffer that contains a pattern, a line containing several patterns
+		/// is reported once per pattern. Lines come in order, except with several regexes, which are searched one after the other
+		/// </summary>
+		template<typename Callback>
+		void Search(const std::string_view buffer, Callback&& onMatch) const
+		{
+			RDW_SS_ASSERT(IsValid());
+
+			std::visit([buffer, &onMatch](const auto& matcher)->void
+				{
+					Detail::LineCursor lines{ buffer };
+					uint32_t lineNumber{ 1 };
+
+					matcher.SearchBuffer(buffer, lineNumber, [&lines, &onMatch](const size_t patternIndex, const uint32_t matchLineNumber)->void
+						{
+							onMatch(BufferMatch{ patternIndex, matchLineNumber, lines.GetLine(matchLineNumber) });
+						});
+				}, m_Matcher);
+		}
+
+		template<typename Callback>
+		void Search(const std::span<const std::byte> buffer, Callback&& onMatch) const
+		{
+			Search(std::string_view{ reinterpret_cast<const char*>(buffer.data()), buffer.size() }, onMatch);
+		}
+
+		/// <summary>
+		/// Same as the streaming IsStringInFile and IsRegexInFile, without compiling the patterns again
+		/// </summary>
+		void SearchFiles(
+			const std::string& currentDir,
+			const std::string& fileToSearch,
+			const SearchOptions& options,
+			const ResultCallback& onResult,
+			const size_t reorderWindow) const
+		{
+			RDW_SS_ASSERT(IsValid());
+
+			std::visit([&](const auto& matcher)->void
+				{
+					Detail::StreamFiles(currentDir, fileToSearch, matcher, options, onResult, reorderWindow);
+				}, m_Matcher);
+		}
+
+	private:
+		using Matcher = std::variant<Detail::StringMatcher<false>, Detail::StringMatcher<true>, Detail::MultiStringMatcher, Detail::RegexMatcher>;
+
+		// the matchers cannot be moved, so they are constructed in place in the returned variant
+		static Matcher MakeMatcher(const std::vector<std::string>& patterns, const bool ignoreCase, const bool isRegex)
+		{
+			if (isRegex) return Matcher{ std::in_place_type<Detail::RegexMatcher>, patterns, ignoreCase };
+			if (patterns.size() != 1) return Matcher{ std::in_place_type<Detail::MultiStringMatcher>, patterns, ignoreCase };
+			if (ignoreCase) return Matcher{ std::in_place_type<Detail::StringMatcher<true>>, patterns.front() };
+
+			return Matcher{ std::in_place_type<Detail::StringMatcher<false>>, patterns.front() };
+		}
+
+		Matcher m_Matcher;
+	};
+
+	struct IndexStatistics final
+	{
+		int32_t NumberOfFilesIndexed;
+		int32_t NumberOfFilesReused;
+	};
+
+	/// <summary>
+	/// Builds a trigram index of the files in rootDir, or updates indexFile if it already exists
+	/// Files whose size and last write time did not change since the last build are not read again
+	/// </summary>
+	inline static bool BuildIndex(
+		const std::string& rootDir,
+		const FileMask& mask,
+		const uint32_t recursiveDepth,
+		const std::string& indexFile,
+		IndexStatistics* pStatistics)
+	{
+		uint32_t nrOfFilesIndexed{}, nrOfFilesReused{};
+		if (!Detail::BuildTrigramIndex(rootDir, mask, recursiveDepth, indexFile, nrOfFilesIndexed, nrOfFilesReused))
+		{
+			std::cout << "Could not write index: " << indexFile << "\n";
+			return false;
+		}
+
+		if (pStatistics)
+		{
+			pStatistics->NumberOfFilesIndexed = static_cast<int32_t>(nrOfFilesIndexed);
+			pStatistics->NumberOfFilesReused = static_cast<int32_t>(nrOfFilesReused);
+		}
+
+		return true;
+	}
+
+	/// <summary>
+	/// Same results as a recursive IsStringInFile over the indexed directory, but only reads the files that can contain one of the strings
+	/// Files that changed since the index was built are always searched, files added since then are only found once the index is updated
+	/// The index decides which files are searched, so options.RecursivelySearch and options.RecursiveDepth are not used
+	/// </summary>
+	inline static bool IsStringInIndexedFiles(
+		const std::string& indexFile,
+		const std::vector<std::string>& stringsToSearch,
+		const SearchOptions& options,
+		std::vector<FileSearchResult>& results)
+	{
+		results.clear();
+
+		bool isSearched{};
+		Detail::DispatchStringMatcher(stringsToSearch, options.IgnoreCase, [&](const auto& matcher)->void
+			{
+				isSearched = Detail::SearchIndex(indexFile, matcher, options, results);
+			});
+
+		return isSearched;
+	}
+
+	/// <summary>
+	/// Regex version of IsStringInIndexedFiles, files are narrowed down by the literals every match has to contain
+	/// </summary>
+	inline static bool IsRegexInIndexedFiles(
+		const std::string& indexFile,
+		const std::vector<std::string>& regexesToSearch,
+		const SearchOptions& options,
+		std::vector<FileSearchResult>& results)
+	{
+		results.clear();
+
+		return Detail::SearchWithMatcher(Detail::RegexMatcher{ regexesToSearch, options.IgnoreCase }, [&](const auto& matcher)->bool
+			{
+				return Detail::SearchIndex(indexFile, matcher, options, results);
+			});
+	}
+
+	/// <summary>
+	/// Fuzzy version of IsStringInIndexedFiles, files are narrowed down by the pieces of the strings one of which every match contains
+	/// </summary>
+	inline static bool IsFuzzyStringInIndexedFiles(
+		const std::string& indexFile,
+		const std::vector<std::string>& stringsToSearch,
+		const uint32_t maxNrOfErrors,
+		const SearchOptions& options,
+		std::vector<FileSearchResult>& results)
+	{
+		results.clear();
+
+		return Detail::SearchWithMatcher(Detail::FuzzyMatcher{ stringsToSearch, maxNrOfErrors, options.IgnoreCase }, [&](const auto& matcher)->bool
+			{
+				return Detail::SearchIndex(indexFile, matcher, options, results);
+			});
+	}
+
+#ifdef RDW_SS_HAS_INOTIFY
+	/// <summary>
+	/// Keeps the files of a directory tree in memory, and a pool of search threads alive, for a process that searches the same tree over and over
+	/// inotify keeps the files up to date: created, deleted and moved files and directories are applied one by one as Update() reads their events
+	/// A changed ignore file, or events the kernel had to drop, make the whole tree be walked again
+	/// Files are still read by every search, so changes to their contents need no event
+	/// </summary>
+	class DirectoryCache final
+	{
+	public:
+		DirectoryCache(const std::string& rootDir, const FileMask& mask, const uint32_t recursiveDepth)
+			: m_RootDir{ rootDir }
+			, m_Mask{ mask }
+			, m_RecursiveDepth{ recursiveDepth }
+			, m_NotifyDescriptor{ -1 }
+			, m_Directories{}
+			, m_WatchesByPath{}
+			, m_Files{}
+			, m_FilesSnapshot{}
+			, m_FilesToSearch{}
+			, m_IsSnapshotOutdated{ true }
+			, m_NeedsRebuild{}
+			, m_Listing{}
+			, m_Path{}
+			, m_pPaths{}
+			, m_pPathWriter{}
+			, m_ThreadPool{ Detail::GetNrOfSearchThreads() }
+		{
+			Rebuild();
+		}
+
+		~DirectoryCache()
+		{
+			if (m_NotifyDescriptor != -1) close(m_NotifyDescriptor);
+		}
+
+		DirectoryCache(const DirectoryCache&) noexcept = delete;
+		DirectoryCache(DirectoryCache&&) noexcept = delete;
+		DirectoryCache& operator=(const DirectoryCache&) noexcept = delete;
+		DirectoryCache& operator=(DirectoryCache&&) noexcept = delete;
+
+		[[nodiscard]] bool IsValid() const { return m_NotifyDescriptor != -1; }
+
+		/// <summary>
+		/// Becomes readable when there are events for Update(), and changes after the tree was walked again
+		/// </summary>
+		[[nodiscard]] int GetNotifyDescriptor() const { return m_NotifyDescriptor; }
+
+		[[nodiscard]] size_t GetNrOfFiles() const { return m_Files.size(); }
+
+		/// <summary>
+		/// Applies every event that is waiting, never blocks
+		/// </summary>
+		void Update()
+		{
+			alignas(inotify_event) char buffer[1u << 16];
+
+			while (!m_NeedsRebuild)
+			{
+				const ssize_t bytesRead{ read(m_NotifyDescriptor, buffer, sizeof(buffer)) };
+				if (bytesRead <= 0) break;
+
+				for (ssize_t offset{}; offset < bytesRead;)
+				{
+					const inotify_event* pEvent{ reinterpret_cast<const inotify_event*>(buffer + offset) };
+					ApplyEvent(*pEvent);
+					offset += static_cast<ssize_t>(sizeof(inotify_event) + pEvent->len);
+				}
+			}
+
+			if (m_NeedsRebuild) Rebuild();
+		}
+
+		/// <summary>
+		/// Searches the cached files in currentDir and below it, which pass the mask and are at most recursiveDepth directories deep (0 for unlimited)
+		/// Returns false if currentDir is not inside the cached tree
+		/// </summary>
+		template<typename Matcher>
+		bool Search(
+			const std::string& currentDir,
+			const Matcher& matcher,
+			const SearchOptions& options,
+			std::vector<FileSearchResult>& results)
+		{
+			const uint64_t startTime{ Detail::GetNanoseconds() };
+			Detail::SearchCounters counters{};
+			Detail::SearchCounters* const pCounters{ Detail::GetCountersToFill(options.pStatistics, counters) };
+
+			const uint64_t enumerationStart{ Detail::IsMeasuringPhases(pCounters) ? Detail::GetNanoseconds() : 0 };
+
+			Update();
+
+			if (currentDir != m_RootDir && !currentDir.starts_with(m_RootDir + Detail::PathSeparator))
+			{
+				std::cout << currentDir << " is not inside the cached directory " << m_RootDir << "\n";
+				return false;
+			}
+
+			const std::vector<std::string>& filesToSearch{ GetFilesToSearch(currentDir, options.Mask, options.RecursiveDepth) };
+
+			if (Detail::IsMeasuringPhases(pCounters)) pCounters->EnumerationTime += Detail::GetNanoseconds() - enumerationStart;
+
+			Detail::SearchControl control{ options.BinaryMode, options.Limits, {}, nullptr };
+			Detail::SearchListedFiles(filesToSearch, matcher, results, control, pCounters, &m_ThreadPool);
+
+			if (options.pStatistics)
+			{
+				options.pStatistics->NumberOfFilesSearched = static_cast<int32_t>(filesToSearch.size());
+			}
+
+			Detail::SetStatistics(options.pStatistics, counters, startTime);
+
+			return true;
+		}
+
+	private:
+		/// <summary>
+		/// A watched directory, its node lives in the path arena of the last rebuild
+		/// </summary>
+		struct WatchedDirectory final
+		{
+			const Detail::PathNode* pNode;
+			uint32_t Depth;
+			std::shared_ptr<const Detail::IgnoreFile> pIgnoreFile; // the rules that apply to its entries
+		};
+
+		inline static constexpr uint32_t WatchedEvents{ IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE | IN_ONLYDIR | IN_DONT_FOLLOW | IN_EXCL_UNLINK };
+
+		void Rebuild()
+		{
+			if (m_NotifyDescriptor != -1) close(m_NotifyDescriptor);
+			m_NotifyDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+			m_Directories.clear();
+			m_WatchesByPath.clear();
+			m_Files.clear();
+			m_IsSnapshotOutdated = true;
+			m_NeedsRebuild = false;
+
+			// nothing points into the old arena anymore
+			m_pPathWriter.reset();
+			m_pPaths = std::make_unique<Detail::PathArena>();
+			m_pPathWriter = std::make_unique<Detail::PathArena::Writer>(*m_pPaths);
+
+			if (m_NotifyDescriptor == -1)
+			{
+				std::cout << "Could not start watching " << m_RootDir << "\n";
+				return;
+			}
+
+			AddDirectory(Detail::MakeRootDirectoryEntry(*m_pPathWriter, m_RootDir));
+		}
+
+		/// <summary>
+		/// Watches directory and everything below it that passes the mask and the ignore files, and adds their files
+		/// The watch is added before a directory is listed, so a file created in between is seen by either the listing or an event
+		/// </summary>
+		void AddDirectory(Detail::DirectoryEntry&& root)
+		{
+			std::stack<Detail::DirectoryEntry> directories{};
+			directories.push(std::move(root));
+
+			while (!directories.empty())
+			{
+				const Detail::DirectoryEntry directory{ std::move(directories.top()) };
+				directories.pop();
+
+				Detail::BuildPath(directory.pNode, m_Path);
+				const std::string directoryPath{ m_Path };
+
+				const int watch{ inotify_add_watch(m_NotifyDescriptor, directoryPath.c_str(), WatchedEvents) };
+				if (watch == -1)
+				{
+					std::cout << "Could not watch directory: " << directoryPath << "\n";
+				}
+
+				const bool isListed{ Detail::ListMaskedDirectory<false>(directory, m_Mask, m_RecursiveDepth, *m_pPathWriter, m_Listing,
+					[&directories](Detail::DirectoryEntry&& subdirectory)->void
+					{
+						directories.push(std::move(subdirectory));
+					},
+					[this, &directoryPath](const std::string_view name, const uint64_t)->void
+					{
+						m_Path.assign(directoryPath);
+						m_Path += Detail::PathSeparator;
+						m_Path += name;
+
+						m_Files.insert(m_Path);
+					}) };
+
+				if (!isListed)
+				{
+					if (watch != -1) inotify_rm_watch(m_NotifyDescriptor, watch);
+					continue;
+				}
+
+				if (watch != -1)
+				{
+					m_Directories[watch] = WatchedDirectory{ directory.pNode, directory.Depth, m_Mask.UsesIgnoreFiles() ? m_Listing.pIgnoreFile : nullptr };
+					m_WatchesByPath[directoryPath] = watch;
+				}
+
+				m_IsSnapshotOutdated = true;
+			}
+		}
+
+		/// <summary>
+		/// Forgets path and everything below it. A directory that was moved away keeps its watches, so they are removed here
+		/// </summary>
+		void RemoveDirectory(const std::string& path)
+		{
+			const std::string prefix{ path + Detail::PathSeparator };
+
+			m_Files.erase(m_Files.lower_bound(prefix), m_Files.lower_bound(path + static_cast<char>(Detail::PathSeparator + 1)));
+
+			for (auto it{ m_WatchesByPath.lower_bound(path) }; it != m_WatchesByPath.end() && (it->first == path || it->first.starts_with(prefix));)
+			{
+				inotify_rm_watch(m_NotifyDescriptor, it->second);
+				m_Directories.erase(it->second);
+				it = m_WatchesByPath.erase(it);
+			}
+
+			m_IsSnapshotOutdated = true;
+		}
+
+		/// <summary>
+		/// The same checks a walk does for an entry of directory
+		/// </summary>
+		bool IsEntrySearched(const WatchedDirectory& directory, const std::string_view name, const bool isDirectory)
+		{
+			if (isDirectory && (!Detail::ShouldDirectoryBeConsidered(directory.Depth + 1, m_RecursiveDepth) || (m_Mask.UsesIgnoreFiles() && name == ".git"))) return false;
+
+			std::string_view relativePath{ name };
+			std::string path{};
+
+			if (m_Mask.IsPathNeeded())
+			{
+				Detail::BuildRelativePath(directory.pNode, nullptr, path);
+				if (!path.empty()) path += '/';
+				path += name;
+
+				relativePath = path;
+			}
+
+			if (isDirectory ? m_Mask.IsDirectoryExcluded(name, relativePath) : !m_Mask.IsFileIncluded(name, relativePath)) return false;
+
+			return !directory.pIgnoreFile || !directory.pIgnoreFile->IsIgnored(directory.pNode, name, isDirectory, m_Listing.IgnorePath);
+		}
+
+		void ApplyEvent(const inotify_event& event)
+		{
+			if ((event.mask & IN_Q_OVERFLOW) != 0)
+			{
+				m_NeedsRebuild = true;
+				return;
+			}
+
+			const auto it{ m_Directories.find(event.wd) };
+			if (it == m_Directories.end() || event.len == 0) return;
+
+			const WatchedDirectory directory{ it->second };
+			const std::string_view name{ event.name };
+			const bool isDirectory{ (event.mask & IN_ISDIR) != 0 };
+
+			if (!isDirectory && m_Mask.UsesIgnoreFiles() && Detail::IsIgnoreFileName(name))
+			{
+				m_NeedsRebuild = true;
+				return;
+			}
+
+			Detail::BuildPath(directory.pNode, m_Path);
+			m_Path += Detail::PathSeparator;
+			m_Path += name;
+
+			if ((event.mask & (IN_DELETE | IN_MOVED_FROM)) != 0)
+			{
+				if (isDirectory)
+				{
+					RemoveDirectory(m_Path);
+				}
+				else if (m_Files.erase(m_Path) != 0)
+				{
+					m_IsSnapshotOutdated = true;
+				}
+			}
+			else if ((event.mask & (IN_CREATE | IN_MOVED_TO)) != 0 && IsEntrySearched(directory, name, isDirectory))
+			{
+				if (isDirectory)
+				{
+					AddDirectory(Detail::DirectoryEntry{ m_pPathWriter->StoreNode(directory.pNode, name), directory.Depth + 1, nullptr, directory.pIgnoreFile });
+				}
+				else
+				{
+					// a walk searches symbolic links to files, but no other kind of file
+					struct stat fileStat {};
+					if (stat(m_Path.c_str(), &fileStat) != 0 || !S_ISREG(fileStat.st_mode)) return;
+
+					m_Files.insert(m_Path);
+					m_IsSnapshotOutdated = true;
+				}
+			}
+		}
+
+		const std::vector<std::string>& GetFilesToSearch(const std::string& currentDir, const FileMask& mask, const uint32_t recursiveDepth)
+		{
+			if (m_IsSnapshotOutdated)
+			{
+				m_FilesSnapshot.assign(m_Files.cbegin(), m_Files.cend());
+				m_IsSnapshotOutdated = false;
+			}
+
+			// a search of the whole tree uses the snapshot as it is
+			if (currentDir == m_RootDir && !mask.HasGlobs() && recursiveDepth == 0) return m_FilesSnapshot;
+
+			const std::string prefix{ currentDir + Detail::PathSeparator };
+			m_FilesToSearch.clear();
+
+			for (auto it{ std::lower_bound(m_FilesSnapshot.cbegin(), m_FilesSnapshot.cend(), prefix) }; it != m_FilesSnapshot.cend() && it->starts_with(prefix); ++it)
+			{
+				m_Path.assign(*it, prefix.size());
+				std::replace(m_Path.begin(), m_Path.end(), Detail::PathSeparator, '/');
+
+				if (recursiveDepth != 0 && static_cast<uint32_t>(std::count(m_Path.cbegin(), m_Path.cend(), '/')) > recursiveDepth) continue;
+				if (!mask.IsPathIncluded(m_Path)) continue;
+
+				m_FilesToSearch.push_back(*it);
+			}
+
+			return m_FilesToSearch;
+		}
+
+		const std::string m_RootDir;
+		const FileMask m_Mask;
+		const uint32_t m_RecursiveDepth;
+		int m_NotifyDescriptor;
+
+		std::unordered_map<int, WatchedDirectory> m_Directories;
+		std::map<std::string, int> m_WatchesByPath;
+		std::set<std::string> m_Files; // full paths, sorted so a directory's files are next to each other
+		std::vector<std::string> m_FilesSnapshot;
+		std::vector<std::string> m_FilesToSearch;
+		bool m_IsSnapshotOutdated;
+		bool m_NeedsRebuild;
+
+		Detail::DirectoryListing m_Listing;
+		std::string m_Path;
+		std::unique_ptr<Detail::PathArena> m_pPaths;
+		std::unique_ptr<Detail::PathArena::Writer> m_pPathWriter;
+		Detail::ThreadPool m_ThreadPool;
+	};
+
+	/// <summary>
+	/// Same results as a recursive IsStringInFile from currentDir, but searches the files of a DirectoryCache instead of walking the tree
+	/// The search is always recursive, options.RecursivelySearch is not used
+	/// </summary>
+	inline static bool IsStringInCachedFiles(
+		DirectoryCache& cache,
+		const std::string& currentDir,
+		const std::vector<std::string>& stringsToSearch,
+		const SearchOptions& options,
+		std::vector<FileSearchResult>& results)
+	{
+		results.clear();
+
+		bool isSearched{};
+		Detail::DispatchStringMatcher(stringsToSearch, options.IgnoreCase, [&](const auto& matcher)->void
+			{
+				isSearched = cache.Search(currentDir, matcher, options, results);
+			});
+
+		return isSearched;
+	}
+
+	/// <summary>
+	/// Regex version of IsStringInCachedFiles
+	/// </summary>
+	inline static bool IsRegexInCachedFiles(
+		DirectoryCache& cache,
+		const std::string& currentDir,
+		const std::vector<std::string>& regexesToSearch,
+		const SearchOptions& options,
+		std::vector<FileSearchResult>& results)
+	{
+		results.clear();
+
+		return Detail::SearchWithMatcher(Detail::RegexMatcher{ regexesToSearch, options.IgnoreCase }, [&](const auto& matcher)->bool
+			{
+				return cache.Search(currentDir, matcher, options, results);
+			});
+	}
+
+	/// <summary>
+	/// Fuzzy version of IsStringInCachedFiles, see IsFuzzyStringInFile
+	/// </summary>
+	inline static bool IsFuzzyStringInCachedFiles(
+		DirectoryCache& cache,
+		const std::string& currentDir,
+		const std::vector<std::string>& stringsToSearch,
+		const uint32_t maxNrOfErrors,
+		const SearchOptions& options,
+		std::vector<FileSearchResult>& results)
+	{
+		results.clear();
+
+		return Detail::SearchWithMatcher(Detail::FuzzyMatcher{ stringsToSearch, maxNrOfErrors, options.IgnoreCase }, [&](const auto& matcher)->bool
+			{
+				return cache.Search(currentDir, matcher, options, results);
+			});
+	}
+#endif
+
+	/// <summary>
+	/// How a ResultPrinter prints results
+	/// </summary>
+	enum class OutputFormat
+	{
+		Plain, // one line per result: Found 2 occurences in <path> at lines: 3, 7
+		Line, // one <path>:<line> line per matching line, like grep -n without the line itself. A line matching several patterns is printed once
+		Json, // one line with a JSON object per result: {"path":"<path>","pattern":"<pattern>","binary":false,"lines":[3,7]}
+	};
+
+	namespace Detail
+	{
+		/// <summary>
+		/// A ResultPrinter writes its buffer out once it grows past this, and formats at most this many line numbers per thread before writing
+		/// </summary>
+		inline static constexpr size_t OutputBufferSize{ 1u << 16 };
+		inline static constexpr size_t LinesPerOutputBuffer{ 1u << 14 };
+
+		/// <summary>
+		/// Whether stdout is a terminal, which should see every result as soon as it is written
+		/// </summary>
+		inline static bool IsOutputTerminal()
+		{
+#ifdef _WIN32
+			return GetFileType(GetStdHandle(STD_OUTPUT_HANDLE)) == FILE_TYPE_CHAR;
+#else
+			return isatty(STDOUT_FILENO) == 1;
+#endif
+		}
+
+		/// <summary>
+		/// Writes the buffers to stdout, in order and with as few system calls as possible
+		/// std::cout is flushed first, so everything printed through it before comes out before the buffers
+		/// </summary>
+		inline static void WriteToOutput(const std::span<const std::string> buffers)
+		{
+			std::cout.flush();
+			std::fflush(stdout);
+
+#ifdef _WIN32
+			const HANDLE output{ GetStdHandle(STD_OUTPUT_HANDLE) };
+
+			for (const std::string& buffer : buffers)
+			{
+				for (size_t offset{}; offset < buffer.size();)
+				{
+					DWORD bytesWritten{};
+					const DWORD bytesToWrite{ static_cast<DWORD>(std::min<size_t>(buffer.size() - offset, 1u << 30)) };
+					if (!WriteFile(output, buffer.data() + offset, bytesToWrite, &bytesWritten, nullptr) || bytesWritten == 0) return;
+
+					offset += bytesWritten;
+				}
+			}
+#else
+			std::vector<iovec> vectors{};
+			vectors.reserve(buffers.size());
+
+			for (const std::string& buffer : buffers)
+			{
+				if (!buffer.empty()) vectors.push_back(iovec{ const_cast<char*>(buffer.data()), buffer.size() });
+			}
+
+			// a short write leaves the vectors that were not written in full
+			for (size_t first{}; first < vectors.size();)
+			{
+				const int nrOfVectors{ static_cast<int>(std::min<size_t>(vectors.size() - first, IOV_MAX)) };
+				ssize_t bytesWritten{ writev(STDOUT_FILENO, vectors.data() + first, nrOfVectors) };
+
+				if (bytesWritten < 0)
+				{
+					if (errno == EINTR) continue;
+					return;
+				}
+
+				for (; first < vectors.size() && static_cast<size_t>(bytesWritten) >= vectors[first].iov_len; ++first)
+				{
+					bytesWritten -= static_cast<ssize_t>(vectors[first].iov_len);
+				}
+
+				if (first < vectors.size())
+				{
+					vectors[first].iov_base = static_cast<char*>(vectors[first].iov_base) + bytesWritten;
+					vectors[first].iov_len -= static_cast<size_t>(bytesWritten);
+				}
+			}
+#endif
+		}
+
+		inline static void AppendNumber(std::string& buffer, const uint64_t number)
+		{
+			char digits[20];
+			const std::to_chars_result end{ std::to_chars(std::begin(digits), std::end(digits), number) };
+			buffer.append(digits, end.ptr);
+		}
+
+		inline static void AppendJsonString(std::string& buffer, const std::string_view string)
+		{
+			constexpr std::string_view hexDigits{ "0123456789abcdef" };
+
+			buffer.push_back('"');
+
+			for (const char c : string)
+			{
+				if (c == '"' || c == '\\')
+				{
+					buffer.push_back('\\');
+					buffer.push_back(c);
+				}
+				else if (static_cast<unsigned char>(c) < 0x20)
+				{
+					buffer.append("\\u00");
+					buffer.push_back(hexDigits[static_cast<unsigned char>(c) >> 4]);
+					buffer.push_back(hexDigits[static_cast<unsigned char>(c) & 0xF]);
+				}
+				else
+				{
+					buffer.push_back(c);
+				}
+			}
+
+			buffer.push_back('"');
+		}
+
+		/// <summary>
+		/// Formats the results of one file, which follow each other in results
+		/// pPatterns is only given when the pattern of a result should be named in the Plain format
+		/// lines is scratch space for merging the lines of several patterns in the Line format
+		/// </summary>
+		inline static void FormatFileResults(
+			std::string& buffer,
+			const OutputFormat format,
+			const std::span<const FileSearchResult> results,
+			const std::vector<std::string>& patterns,
+			const std::vector<std::string>* pPatterns,
+			std::vector<uint32_t>& lines)
+		{
+			if (format == OutputFormat::Line)
+			{
+				const std::string& path{ results.front().Path };
+
+				if (results.front().IsBinary)
+				{
+					buffer.append("Binary file ").append(path).append(" matches\n");
+					return;
+				}
+
+				std::span<const uint32_t> sortedLines{ results.front().LineNumbers };
+
+				if (results.size() > 1)
+				{
+					lines.clear();
+					for (const FileSearchResult& result : results) lines.insert(lines.end(), result.LineNumbers.cbegin(), result.LineNumbers.cend());
+
+					std::sort(lines.begin(), lines.end());
+					lines.erase(std::unique(lines.begin(), lines.end()), lines.end());
+					sortedLines = lines;
+				}
+
+				for (const uint32_t line : sortedLines)
+				{
+					buffer.append(path).push_back(':');
+					AppendNumber(buffer, line);
+					buffer.push_back('\n');
+				}
+
+				return;
+			}
+
+			for (const FileSearchResult& result : results)
+			{
+				if (format == OutputFormat::Json)
+				{
+					buffer.append("{\"path\":");
+					AppendJsonString(buffer, result.Path);
+					buffer.append(",\"pattern\":");
+					AppendJsonString(buffer, patterns[result.PatternIndex]);
+					buffer.append(result.IsBinary ? ",\"binary\":true,\"lines\":[" : ",\"binary\":false,\"lines\":[");
+
+					for (size_t i{}; i < result.LineNumbers.size(); ++i)
+					{
+						if (i != 0) buffer.push_back(',');
+						AppendNumber(buffer, result.LineNumbers[i]);
+					}
+
+					buffer.append("]}\n");
+					continue;
+				}
+
+				if (result.IsBinary)
+				{
+					buffer.append("Binary file ").append(result.Path).append(" matches");
+					if (pPatterns) buffer.append(" \"").append((*pPatterns)[result.PatternIndex]).push_back('"');
+					buffer.push_back('\n');
+					continue;
+				}
+
+				buffer.append("Found ");
+				AppendNumber(buffer, result.LineNumbers.size());
+				buffer.append(" occurences");
+				if (pPatterns) buffer.append(" of \"").append((*pPatterns)[result.PatternIndex]).push_back('"');
+				buffer.append(" in ").append(result.Path).append(" at lines: ");
+
+				for (size_t i{}; i < result.LineNumbers.size(); ++i)
+				{
+					if (i != 0) buffer.append(", ");
+					AppendNumber(buffer, result.LineNumbers[i]);
+				}
+
+				buffer.push_back('\n');
+			}
+		}
+	}
+
+	/// <summary>
+	/// Prints search results to stdout without going through std::cout for every number
+	/// Results are formatted with std::to_chars into buffers that are written out in one system call, a big list of results is formatted by several threads
+	/// </summary>
+	class ResultPrinter final
+	{
+	public:
+		inline static constexpr uint32_t AllPatterns{ std::numeric_limits<uint32_t>::max() };
+
+		/// <summary>
+		/// patterns are the searched strings the PatternIndex of a result refers to, they have to outlive the writer
+		/// </summary>
+		ResultPrinter(const OutputFormat format, const std::vector<std::string>& patterns)
+			: m_Format{ format }
+			, m_Patterns{ patterns }
+			, m_IsTerminal{ Detail::IsOutputTerminal() }
+			, m_Buffer{}
+			, m_PendingResults{}
+			, m_Lines{}
+		{
+			m_Buffer.reserve(Detail::OutputBufferSize);
+		}
+
+		~ResultPrinter()
+		{
+			Flush();
+		}
+
+		ResultPrinter(const ResultPrinter&) noexcept = delete;
+		ResultPrinter(ResultPrinter&&) noexcept = delete;
+		ResultPrinter& operator=(const ResultPrinter&) noexcept = delete;
+		ResultPrinter& operator=(ResultPrinter&&) noexcept = delete;
+
+		/// <summary>
+		/// Writes a result the way a streamed search hands them over, with the results of a file one after the other
+		/// A terminal gets every file as soon as the next one comes in, anything else gets full buffers
+		/// </summary>
+		void Write(FileSearchResult&& result)
+		{
+			if (!m_PendingResults.empty() && m_PendingResults.front().Path != result.Path)
+			{
+				FormatPendingResults();
+
+				if (m_IsTerminal || m_Buffer.size() >= Detail::OutputBufferSize) WriteBuffer();
+			}
+
+			m_PendingResults.push_back(std::move(result));
+		}
+
+		/// <summary>
+		/// Writes results sorted by path, or only those of patternIndex. The pattern of a result is only named in the Plain format when all patterns are written
+		/// The results are split over threads that each format into their own buffer, and the buffers are written out in order
+		/// </summary>
+		void Write(const std::vector<FileSearchResult>& results, const uint32_t patternIndex = AllPatterns)
+		{
+			Flush();
+
+			const std::vector<std::string>* const pPatterns{ patternIndex == AllPatterns && m_Patterns.size() > 1 ? &m_Patterns : nullptr };
+			const size_t nrOfThreads{ Detail::GetNrOfSearchThreads() };
+
+			// every range ends at the last result of a file, after at least LinesPerOutputBuffer line numbers
+			std::vector<std::pair<size_t, size_t>> ranges{};
+			std::vector<std::string> buffers(nrOfThreads);
+
+			const auto formatRange{ [this, &results, &ranges, &buffers, patternIndex, pPatterns](const size_t rangeIndex, std::vector<uint32_t>& lines)->void
+				{
+					std::string& buffer{ buffers[rangeIndex] };
+					buffer.clear();
+
+					for (size_t first{ ranges[rangeIndex].first }; first < ranges[rangeIndex].second;)
+					{
+						size_t last{ first + 1 };
+						while (last < ranges[rangeIndex].second && results[last].Path == results[first].Path) ++last;
+
+						if (patternIndex == AllPatterns)
+						{
+							Detail::FormatFileResults(buffer, m_Format, std::span{ results }.subspan(first, last - first), m_Patterns, pPatterns, lines);
+						}
+						else
+						{
+							for (size_t i{ first }; i < last; ++i)
+							{
+								if (results[i].PatternIndex == patternIndex) Detail::FormatFileResults(buffer, m_Format, std::span{ results }.subspan(i, 1), m_Patterns, pPatterns, lines);
+							}
+						}
+
+						first = last;
+					}
+				} };
+
+			for (size_t first{}; first < results.size();)
+			{
+				ranges.clear();
+
+				while (ranges.size() < nrOfThreads && first < results.size())
+				{
+					size_t last{ first }, nrOfLines{};
+					while (last < results.size() && (nrOfLines < Detail::LinesPerOutputBuffer || results[last].Path == results[last - 1].Path))
+					{
+						nrOfLines += results[last].LineNumbers.size() + 1;
+						++last;
+					}
+
+					ranges.emplace_back(first, last);
+					first = last;
+				}
+
+				if (ranges.size() == 1)
+				{
+					formatRange(0, m_Lines);
+				}
+				else
+				{
+					std::vector<std::jthread> threads{};
+					threads.reserve(ranges.size());
+
+					for (size_t i{}; i < ranges.size(); ++i)
+					{
+						threads.emplace_back([&formatRange, i]() { std::vector<uint32_t> lines{}; formatRange(i, lines); });
+					}
+				}
+
+				Detail::WriteToOutput(std::span{ buffers }.first(ranges.size()));
+			}
+		}
+
+		/// <summary>
+		/// Writes out everything that was buffered, call before printing anything else to stdout
+		/// </summary>
+		void Flush()
+		{
+			FormatPendingResults();
+			WriteBuffer();
+		}
+
+	private:
+		void FormatPendingResults()
+		{
+			if (m_PendingResults.empty()) return;
+
+			Detail::FormatFileResults(m_Buffer, m_Format, m_PendingResults, m_Patterns, m_Patterns.size() > 1 ? &m_Patterns : nullptr, m_Lines);
+			m_PendingResults.clear();
+		}
+
+		void WriteBuffer()
+		{
+			if (m_Buffer.empty()) return;
+
+			Detail::WriteToOutput(std::span{ &m_Buffer, 1 });
+			m_Buffer.clear();
+		}
+
+		const OutputFormat m_Format;
+		const std::vector<std::string>& m_Patterns;
+		const bool m_IsTerminal;
+
+		std::string m_Buffer;
+		std::vector<FileSearchResult> m_PendingResults; // the results of the last file, a file is only formatted once all of its results are in
+		std::vector<uint32_t> m_Lines;
+	};
 
 	/*
 	command line format:
-		StringSearcher.exe [--recursive N | -r  N] [--ignorecase | -i] [--file <file> | -f <file>] <strings> <mask>
+		StringSearcher.exe [--recursive N | -r  N] [--ignorecase | -i] [--file <file> | -f <file>] [--pattern <string> | -e <string>]... [--patternfile <file> | -p <file>] [--regex | -x] [--fuzzy K] [--stream N | -s] [--buildindex <file> | -b <file>] [--index <file>] [--stats [text | json]] [--binary skip | match | text] [--format plain | line | json] [--files-with-matches | -l] [--max-count N | -m N] [--quiet | -q] [--include <glob>]... [--exclude <glob>]... [--no-ignore] [--daemon <socket>] <strings> <mask>
 
 		command line options :
 			--recursive [N]		search current directory and subdirectories, limited to N levels deep of sub directories. If N is not given or 0, this is unlimited
 			--ignorecase		ignore case of characters
 			--file				file to look through (required when --recursive or -r are not specified, but not available if -r or --recursive is specified)
+			--pattern			string to search for, can be given several times to search for all of them in a single pass
+			--patternfile		file with one string to search for per line
+			--regex				the strings are regular expressions
+			--fuzzy K			also match the strings with up to K characters inserted, deleted or substituted, not together with --regex
+			--stream [N]		print the results of every file as soon as it is searched. With N, files are printed in the order they were found, with a slow file holding back at most N others
+			--buildindex		build or update an index of the current directory and its subdirectories in the given file, limited by the mask and --recursive. No strings are given
+			--index				search the files of the given index instead of walking the directory, only reading files that can contain a match
+			--stats [F]			print the bytes, lines and matches searched and the time spent in every phase of the search. F is text (the default) or json
+			--binary M			what to do with binary files: skip them (the default), match to only report that they match, or text to search them like any other file
+			--format F			how results are printed: plain (the default), line for one <file>:<line> per matching line like grep -n, or json for one JSON object per file and string. line and json print nothing but the results
+			--files-with-matches	only print the files that contain a match, every file stops being searched at its first match
+			--max-count N		stop searching a file after N matching lines
+			--quiet				print nothing and stop at the first match, the exit code is 0 when a match was found and 1 otherwise
+			--include			only search files matching the glob, can be given several times
+			--exclude			skip files and directories matching the glob, can be given several times
+			--no-ignore			also search what .gitignore and .ignore files exclude, and .git directories
+			--daemon			keep the files of the current directory and its subdirectories in memory, limited by the mask and --recursive, and search them for the clients of the given socket. Linux only
+			--client			must come first: pass the other arguments on to the daemon of the given socket, which searches its files instead of walking the directory. Linux only
 			-r					search current directory and subdirectories. Same as --recursive 0
 			-i					ignore case of characters
 			-f					file to look through (required when --recursive or -r are not specified, but not available if -r or --recursive is specified)
+			-e					same as --pattern
+			-p					same as --patternfile
+			-x					same as --regex
+			-s					print the results of every file as soon as it is searched. Same as --stream 0
+			-l					same as --files-with-matches
+			-m					same as --max-count
+			-q					same as --quiet
+			-b					same as --buildindex
 
 		example:
 			D:\ExampleDir\> StringSearcher.exe -i --file hello_world.txt "Hello World"
 			D:\ExampleDir\> StringSearcher.exe --recursive 3 "Hello World"
 			D:\ExampleDir\> StringSearcher.exe --recursive -i Hello!
+			D:\ExampleDir\> StringSearcher.exe --recursive -e ERROR_1 -e ERROR_2 *.log
+			D:\ExampleDir\> StringSearcher.exe --recursive -x "ERROR_[0-9]+: .*timeout" *.log
+			D:\ExampleDir\> StringSearcher.exe --recursive --fuzzy 2 -i ConnectionTimeout *.log
+			D:\ExampleDir\> StringSearcher.exe --buildindex search.idx *.log
+			D:\ExampleDir\> StringSearcher.exe --index search.idx -i timeout
+			D:\ExampleDir\> StringSearcher.exe -r -l TODO *.cpp
+			D:\ExampleDir\> StringSearcher.exe -r --exclude third_party TODO "*.cpp;*.h"
+			~/project$ StringSearcher --daemon /tmp/search.sock -r &
+			~/project/src$ StringSearcher --client /tmp/search.sock -r TODO *.cpp
 	*/
 
 	inline static void PrintHelp()
 	{
 		std::cout << "Command Line Format:\n";
-		std::cout << "StringSearcher.exe [--recursive N | -r  N] [--ignorecase | -i] [--file <file> | -f <file>] <strings> <mask>\n\n";
+		std::cout << "StringSearcher.exe [--recursive N | -r  N] [--ignorecase | -i] [--file <file> | -f <file>] [--pattern <string> | -e <string>]... [--patternfile <file> | -p <file>] [--regex | -x] [--fuzzy K] [--stream N | -s] [--buildindex <file> | -b <file>] [--index <file>] [--stats [text | json]] [--binary skip | match | text] [--format plain | line | json] [--files-with-matches | -l] [--max-count N | -m N] [--quiet | -q] [--include <glob>]... [--exclude <glob>]... [--no-ignore] [--daemon <socket>] <strings> <mask>\n\n";
 
 		std::cout << "command line options :\n";
 		std::cout << "--recursive [N]		search current directory and subdirectories, limited to N levels deep of sub directories. If N is not given or 0, this is unlimited\n";
 		std::cout << "--ignorecase			ignore case of characters\n";
 		std::cout << "--file				file to look through (required when --recursive or -r are not specified)\n";
+		std::cout << "--pattern			string to search for, can be given several times to search for all of them in a single pass\n";
+		std::cout << "--patternfile		file with one string to search for per line\n";
+		std::cout << "--regex				the strings are regular expressions\n";
+		std::cout << "--fuzzy K			also match the strings with up to K characters inserted, deleted or substituted, not together with --regex\n";
+		std::cout << "--stream [N]		print the results of every file as soon as it is searched. With N, files are printed in the order they were found, with a slow file holding back at most N others\n";
+		std::cout << "--buildindex		build or update an index of the current directory and its subdirectories in the given file, limited by the mask and --recursive. No strings are given\n";
+		std::cout << "--index				search the files of the given index instead of walking the directory, only reading files that can contain a match\n";
+		std::cout << "--stats [F]			print the bytes, lines and matches searched and the time spent in every phase of the search. F is text (the default) or json\n";
+		std::cout << "--binary M			what to do with binary files: skip them (the default), match to only report that they match, or text to search them like any other file\n";
+		std::cout << "--format F			how results are printed: plain (the default), line for one <file>:<line> per matching line like grep -n, or json for one JSON object per file and string. line and json print nothing but the results\n";
+		std::cout << "--files-with-matches	only print the files that contain a match, every file stops being searched at its first match\n";
+		std::cout << "--max-count N		stop searching a file after N matching lines\n";
+		std::cout << "--quiet				print nothing and stop at the first match, the exit code is 0 when a match was found and 1 otherwise\n";
+		std::cout << "--include			only search files matching the glob, can be given several times\n";
+		std::cout << "--exclude			skip files and directories matching the glob, can be given several times\n";
+		std::cout << "--no-ignore			also search what .gitignore and .ignore files exclude, and .git directories\n";
+		std::cout << "--daemon			keep the files of the current directory and its subdirectories in memory, limited by the mask and --recursive, and search them for the clients of the given socket. Linux only\n";
+		std::cout << "--client			must come first: pass the other arguments on to the daemon of the given socket, which searches its files instead of walking the directory. Linux only\n";
 		std::cout << "-r					search current directory and subdirectories. Same as --recursive 0\n";
 		std::cout << "-i					ignore case of characters\n";
-		std::cout << "-f					file to look through (required when --recursive or -r are not specified)\n\n";
+		std::cout << "-f					file to look through (required when --recursive or -r are not specified)\n";
+		std::cout << "-e					same as --pattern\n";
+		std::cout << "-p					same as --patternfile\n";
+		std::cout << "-x					same as --regex\n";
+		std::cout << "-s					print the results of every file as soon as it is searched. Same as --stream 0\n";
+		std::cout << "-l					same as --files-with-matches\n";
+		std::cout << "-m					same as --max-count\n";
+		std::cout << "-q					same as --quiet\n";
+		std::cout << "-b					same as --buildindex\n\n";
 
 		std::cout << "Notes:\n";
 		std::cout << "The string to be searched must be between quotation marks if separated by spaces\n";
-		std::cout << "The mask is only applied when searching recursively, and accepts a wildcard token: *\n\n";
+		std::cout << "The mask is only applied when searching recursively. It holds globs separated by ;, a glob starting with ! excludes what it matches\n";
+		std::cout << "Globs accept * ? [abc] [!abc] and ** to match across directories. A glob with a / is matched against the path below the current directory\n";
+		std::cout << "Directories ignored by the .gitignore and .ignore files found while searching recursively are never opened, neither are .git directories\n";
+		std::cout << "When strings are given through --pattern or --patternfile, the first remaining argument is the mask\n";
+		std::cout << "An index only knows the files that existed when it was last built, changed files are always searched\n";
+		std::cout << "A daemon follows created, deleted and moved files through inotify. Its clients must run inside its directory, their mask and --recursive only narrow down its files\n";
+		std::cout << "A daemon only searches for its clients, it refuses --buildindex, --index, --patternfile and --daemon\n";
+		std::cout << "A fuzzy match is a part of a line within K insertions, deletions or substitutions of the string, e.g. --fuzzy 1 matches conection and connecton for connection\n";
+		std::cout << "Regular expressions support . [] [^] [:alpha:] \\d \\w \\s * + ? {m,n} | () ^ $, and are matched against every line on its own\n\n";
 
 		std::cout << "Example: StringSearcher.exe -i --file hello_world.txt \"Hello World\"\n";
 		std::cout << "Example: StringSearcher.exe --recursive 2 Hello! *.txt\n";
+		std::cout << "Example: StringSearcher.exe --recursive -e ERROR_1 -e ERROR_2 *.log\n";
+		std::cout << "Example: StringSearcher.exe --recursive -x \"ERROR_[0-9]+: .*timeout\" *.log\n";
+		std::cout << "Example: StringSearcher.exe --recursive --fuzzy 2 -i ConnectionTimeout *.log\n";
+		std::cout << "Example: StringSearcher.exe --buildindex search.idx *.log\n";
+		std::cout << "Example: StringSearcher.exe --index search.idx -i timeout\n";
+		std::cout << "Example: StringSearcher.exe -r -l TODO *.cpp\n";
+		std::cout << "Example: StringSearcher.exe -r --exclude third_party TODO \"*.cpp;*.h\"\n";
+		std::cout << "Example: StringSearcher --daemon /tmp/search.sock -r & StringSearcher --client /tmp/search.sock -r TODO *.cpp\n";
 	}
 }
\ No newline at end of file
@@ -0,0 +1,1306 @@
+#include "../StringSearcher.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <numeric>
+#include <random>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef RDW_SS_HAS_INOTIFY
+#include <poll.h>
+#endif
+
+/*
+command line format:
+	Tests.exe
+
+	output:
+		every failed check on stdout, followed by the number of checks and failures of every test
+		the exit code is 1 if any check failed
+
+	the tests compare the search code against simple reference implementations on generated inputs, from a fixed seed so every run checks the same inputs
+	the searches of files run in a directory under the temporary directory, which is removed again
+*/
+
+namespace RDW_SS::Tests
+{
+	namespace
+	{
+		inline static constexpr uint32_t Seed{ 0x7E57 };
+
+		// only the first failures of a test are printed, the rest are counted
+		inline static constexpr uint32_t MaxNrOfFailuresPrinted{ 10 };
+
+		class TestResult final
+		{
+		public:
+			explicit TestResult(const std::string_view name)
+				: m_Name{ name }
+				, m_NrOfChecks{}
+				, m_NrOfFailures{}
+			{}
+
+			TestResult(const TestResult&) noexcept = delete;
+			TestResult(TestResult&&) noexcept = delete;
+			TestResult& operator=(const TestResult&) noexcept = delete;
+			TestResult& operator=(TestResult&&) noexcept = delete;
+
+			/// <summary>
+			/// describe is only called for a failed check, so building its message costs nothing while everything passes
+			/// </summary>
+			template<typename Describe>
+			void Check(const bool isCorrect, Describe&& describe)
+			{
+				++m_NrOfChecks;
+				if (isCorrect) return;
+
+				if (m_NrOfFailures++ < MaxNrOfFailuresPrinted)
+				{
+					std::cout << "FAILED " << m_Name << ": " << describe() << "\n";
+				}
+			}
+
+			/// <summary>
+			/// Prints the totals, returns whether every check passed
+			/// </summary>
+			bool Finish() const
+			{
+				std::cout << m_Name << ": " << m_NrOfChecks << " checks, " << m_NrOfFailures << " failed\n";
+				return m_NrOfFailures == 0;
+			}
+
+		private:
+			std::string_view m_Name;
+			uint64_t m_NrOfChecks;
+			uint64_t m_NrOfFailures;
+		};
+
+		/// <summary>
+		/// Shows the control characters of a generated string, so a failure can be reproduced from its message
+		/// </summary>
+		static std::string Escape(const std::string_view string)
+		{
+			std::string escaped{};
+
+			for (const char c : string)
+			{
+				if (c == '\n') escaped += "\\n";
+				else if (c == '\0') escaped += "\\0";
+				else escaped += c;
+			}
+
+			return escaped;
+		}
+
+		/// <summary>
+		/// Memory whose last byte is followed by a page that can not be read, so a kernel reading past the end of a haystack
+		/// placed at the end of the buffer crashes the tests instead of going unnoticed
+		/// </summary>
+		class GuardedBuffer final
+		{
+		public:
+			explicit GuardedBuffer(const size_t size)
+				: m_PageSize{ GetPageSize() }
+				, m_Size{ (size + m_PageSize - 1) / m_PageSize * m_PageSize + m_PageSize }
+				, m_pMemory{}
+			{
+#ifdef _WIN32
+				m_pMemory = static_cast<char*>(VirtualAlloc(nullptr, m_Size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+				DWORD oldProtection{};
+				if (m_pMemory) VirtualProtect(m_pMemory + m_Size - m_PageSize, m_PageSize, PAGE_NOACCESS, &oldProtection);
+#else
+				void* pMemory{ mmap(nullptr, m_Size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0) };
+				if (pMemory != MAP_FAILED) m_pMemory = static_cast<char*>(pMemory);
+				if (m_pMemory) mprotect(m_pMemory + m_Size - m_PageSize, m_PageSize, PROT_NONE);
+#endif
+
+				if (!m_pMemory)
+				{
+					std::cout << "Could not allocate a guarded buffer\n";
+					std::exit(1);
+				}
+			}
+
+			~GuardedBuffer()
+			{
+#ifdef _WIN32
+				VirtualFree(m_pMemory, 0, MEM_RELEASE);
+#else
+				munmap(m_pMemory, m_Size);
+#endif
+			}
+
+			GuardedBuffer(const GuardedBuffer&) noexcept = delete;
+			GuardedBuffer(GuardedBuffer&&) noexcept = delete;
+			GuardedBuffer& operator=(const GuardedBuffer&) noexcept = delete;
+			GuardedBuffer& operator=(GuardedBuffer&&) noexcept = delete;
+
+			/// <summary>
+			/// Copies string so it ends right before the guard page, and returns the copy
+			/// </summary>
+			std::string_view Place(const std::string_view string)
+			{
+				RDW_SS_ASSERT(string.size() <= m_Size - m_PageSize);
+
+				char* const pStart{ m_pMemory + m_Size - m_PageSize - string.size() };
+				std::copy(string.begin(), string.end(), pStart);
+
+				return std::string_view{ pStart, string.size() };
+			}
+
+		private:
+			static size_t GetPageSize()
+			{
+#ifdef _WIN32
+				SYSTEM_INFO systemInfo{};
+				GetSystemInfo(&systemInfo);
+				return systemInfo.dwPageSize;
+#else
+				return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+			}
+
+			size_t m_PageSize;
+			size_t m_Size;
+			char* m_pMemory;
+		};
+
+		/// <summary>
+		/// Letters in both cases, and the non-letters that equal a letter or each other once 0x20 is OR'ed in, which the SIMD kernels
+		/// have to weed out when ignoring case. A small alphabet makes the needles show up often, and nearly match even more often
+		/// </summary>
+		inline static constexpr std::string_view KernelAlphabet{ "aAbBzZ@`[{\n " };
+
+		inline static constexpr size_t MaxNeedleSize{ 33 };
+
+		struct Kernel final
+		{
+			std::string Name;
+			Detail::FindStringFunction pFindString;
+			bool IgnoreCase;
+			bool IsNeedleLowercase; // the needle is passed in lowercase when ignoring case, as the matchers do
+			size_t NeedleSize; // 0 for any size, otherwise the only size the kernel handles
+		};
+
+		template<bool IgnoreCase>
+		static size_t FindString(const std::string_view haystack, const std::string_view needle)
+		{
+			return RDW_SS::FindString(haystack, needle, IgnoreCase);
+		}
+
+#ifdef RDW_SS_HAS_SSE2
+		template<bool IgnoreCase, size_t ... FixedSizes>
+		static void AddFixedSizeKernels(std::vector<Kernel>& kernels, const bool isAVX2Supported, std::index_sequence<FixedSizes...>)
+		{
+			const std::string suffix{ IgnoreCase ? ", ignore case" : "" };
+
+			((kernels.push_back(Kernel{ "FindStringSSE2<" + std::to_string(FixedSizes + 2) + ">" + suffix, &Detail::FindStringSSE2<IgnoreCase, FixedSizes + 2>, IgnoreCase, IgnoreCase, FixedSizes + 2 })), ...);
+
+			if (isAVX2Supported)
+			{
+				((kernels.push_back(Kernel{ "FindStringAVX2<" + std::to_string(FixedSizes + 2) + ">" + suffix, &Detail::FindStringAVX2<IgnoreCase, FixedSizes + 2>, IgnoreCase, IgnoreCase, FixedSizes + 2 })), ...);
+			}
+		}
+#endif
+
+		template<bool IgnoreCase>
+		static void AddKernels(std::vector<Kernel>& kernels)
+		{
+			const std::string suffix{ IgnoreCase ? ", ignore case" : "" };
+
+			kernels.push_back(Kernel{ "FindStringScalar" + suffix, &Detail::FindStringScalar<IgnoreCase>, IgnoreCase, IgnoreCase, 0 });
+			kernels.push_back(Kernel{ "FindByte" + suffix, &Detail::FindByte<IgnoreCase>, IgnoreCase, IgnoreCase, 1 });
+
+			// folds the needle itself
+			kernels.push_back(Kernel{ "FindString" + suffix, &FindString<IgnoreCase>, IgnoreCase, false, 0 });
+
+#ifdef RDW_SS_HAS_SSE2
+			const bool isAVX2Supported{ Detail::IsAVX2Supported() };
+
+			kernels.push_back(Kernel{ "FindStringSSE2" + suffix, &Detail::FindStringSSE2<IgnoreCase>, IgnoreCase, IgnoreCase, 0 });
+			if (isAVX2Supported) kernels.push_back(Kernel{ "FindStringAVX2" + suffix, &Detail::FindStringAVX2<IgnoreCase>, IgnoreCase, IgnoreCase, 0 });
+
+			AddFixedSizeKernels<IgnoreCase>(kernels, isAVX2Supported, std::make_index_sequence<MaxNeedleSize - 1>{});
+#endif
+		}
+
+		static std::string GenerateString(std::mt19937& generator, const size_t size, const std::string_view alphabet)
+		{
+			std::uniform_int_distribution<size_t> character{ 0, alphabet.size() - 1 };
+
+			std::string string(size, '\0');
+			for (char& c : string) c = alphabet[character(generator)];
+
+			return string;
+		}
+
+		/// <summary>
+		/// Every kernel against std::string_view::find, on haystacks placed right before a page that can not be read
+		/// For every needle size the haystacks are of every size up to a few SIMD blocks past the needle, and a few sizes spanning pages.
+		/// The needle is a random string, a piece of the haystack, or put at the very end of the haystack, with and without its last byte changed
+		/// </summary>
+		static bool TestFindStringKernels(std::mt19937& generator)
+		{
+			TestResult test{ "substring kernels" };
+
+			std::vector<Kernel> kernels{};
+			AddKernels<false>(kernels);
+			AddKernels<true>(kernels);
+
+			GuardedBuffer guardedBuffer{ 3 * 4096 };
+
+			for (size_t needleSize{ 1 }; needleSize <= MaxNeedleSize; ++needleSize)
+			{
+				std::vector<size_t> haystackSizes(needleSize + 3 * 32);
+				std::iota(haystackSizes.begin(), haystackSizes.end(), size_t{ 0 });
+				haystackSizes.insert(haystackSizes.end(), { 4095, 4096, 4097, 2 * 4096 + 17 });
+
+				for (const size_t haystackSize : haystackSizes)
+				{
+					const std::string haystack{ GenerateString(generator, haystackSize, KernelAlphabet) };
+					std::vector<std::string> needles{ GenerateString(generator, needleSize, KernelAlphabet) };
+
+					if (haystackSize >= needleSize)
+					{
+						std::uniform_int_distribution<size_t> start{ 0, haystackSize - needleSize };
+						needles.push_back(haystack.substr(start(generator), needleSize));
+
+						// the needle only at the very end of the haystack, and the same with its last byte changed
+						std::string tailNeedle{ haystack.substr(haystackSize - needleSize) };
+						needles.push_back(tailNeedle);
+
+						tailNeedle.back() = tailNeedle.back() == 'a' ? 'b' : 'a';
+						needles.push_back(tailNeedle);
+					}
+
+					const std::string_view placedHaystack{ guardedBuffer.Place(haystack) };
+
+					std::string lowercaseHaystack{ haystack };
+					Detail::TransformStringToLowercase(lowercaseHaystack);
+
+					for (const std::string& needle : needles)
+					{
+						std::string lowercaseNeedle{ needle };
+						Detail::TransformStringToLowercase(lowercaseNeedle);
+
+						const size_t expected{ haystack.find(needle) };
+						const size_t expectedIgnoringCase{ lowercaseHaystack.find(lowercaseNeedle) };
+
+						for (const Kernel& kernel : kernels)
+						{
+							if (kernel.NeedleSize != 0 && kernel.NeedleSize != needleSize) continue;
+
+							const size_t position{ kernel.pFindString(placedHaystack, kernel.IsNeedleLowercase ? lowercaseNeedle : needle) };
+							const size_t expectedPosition{ kernel.IgnoreCase ? expectedIgnoringCase : expected };
+
+							test.Check(position == expectedPosition, [&]()
+								{
+									return kernel.Name + " found \"" + Escape(needle) + "\" at " + std::to_string(static_cast<int64_t>(position)) + " instead of "
+										+ std::to_string(static_cast<int64_t>(expectedPosition)) + " in \"" + Escape(haystack) + "\"";
+								});
+						}
+					}
+				}
+			}
+
+			return test.Finish();
+		}
+
+		using LineMatches = std::vector<std::pair<size_t, uint32_t>>; // pattern index and line number, sorted
+
+		static std::string JoinLines(const std::vector<std::string>& lines)
+		{
+			std::string buffer{};
+			for (const std::string& line : lines) buffer.append(line).push_back('\n');
+
+			return buffer;
+		}
+
+		static LineMatches SearchLines(const Searcher& searcher, const std::string_view buffer)
+		{
+			LineMatches matches{};
+			searcher.Search(buffer, [&matches](const BufferMatch& match)->void { matches.emplace_back(match.PatternIndex, match.LineNumber); });
+
+			std::sort(matches.begin(), matches.end());
+			return matches;
+		}
+
+		template<typename Matcher>
+		static LineMatches SearchLines(const Matcher& matcher, const std::string_view buffer)
+		{
+			LineMatches matches{};
+			uint32_t lineNumber{ 1 };
+			matcher.SearchBuffer(buffer, lineNumber, [&matches](const size_t patternIndex, const uint32_t matchLineNumber)->void { matches.emplace_back(patternIndex, matchLineNumber); });
+
+			std::sort(matches.begin(), matches.end());
+			return matches;
+		}
+
+		/// <summary>
+		/// isLineMatch(patternIndex, line) is the reference the search is compared against
+		/// </summary>
+		template<typename IsLineMatch>
+		static LineMatches SearchLinesReference(const std::vector<std::string>& lines, const size_t nrOfPatterns, IsLineMatch&& isLineMatch)
+		{
+			LineMatches matches{};
+
+			for (size_t patternIndex{}; patternIndex < nrOfPatterns; ++patternIndex)
+			{
+				for (size_t i{}; i < lines.size(); ++i)
+				{
+					if (isLineMatch(patternIndex, lines[i])) matches.emplace_back(patternIndex, static_cast<uint32_t>(i + 1));
+				}
+			}
+
+			std::sort(matches.begin(), matches.end());
+			return matches;
+		}
+
+		/// <summary>
+		/// Names the first line the search got wrong
+		/// </summary>
+		static std::string DescribeDifference(const LineMatches& matches, const LineMatches& expected, const std::vector<std::string>& patterns, const std::vector<std::string>& lines)
+		{
+			LineMatches missed{}, extra{};
+			std::set_difference(expected.begin(), expected.end(), matches.begin(), matches.end(), std::back_inserter(missed));
+			std::set_difference(matches.begin(), matches.end(), expected.begin(), expected.end(), std::back_inserter(extra));
+
+			const bool isMissed{ !missed.empty() };
+			const auto [patternIndex, lineNumber] { isMissed ? missed.front() : extra.front() };
+
+			return std::string{ isMissed ? "missed \"" : "wrongly found \"" } + Escape(patterns[patternIndex]) + "\" on line " + std::to_string(lineNumber)
+				+ " \"" + Escape(lines[lineNumber - 1]) + "\"";
+		}
+
+		inline static constexpr std::string_view RegexLineAlphabet{ "abcAB1 _-" };
+		inline static constexpr std::string_view RegexLiterals{ "abc1 " };
+		inline static constexpr std::string_view RegexClasses[]
+		{
+			".", "[ab]", "[^a]", "[a-c]", "[[:alpha:]]", "[[:digit:]_]", "[^[:space:]]", "\\d", "\\w", "\\s", "\\W",
+		};
+
+		/// <summary>
+		/// A random regex in the syntax both the searched regexes and std::regex's ECMAScript grammar take the same way
+		/// </summary>
+		static std::string GenerateRegex(std::mt19937& generator, const uint32_t depth)
+		{
+			std::uniform_int_distribution<uint32_t> percent{ 0, 99 };
+			std::uniform_int_distribution<size_t> literal{ 0, RegexLiterals.size() - 1 };
+			std::uniform_int_distribution<size_t> regexClass{ 0, std::size(RegexClasses) - 1 };
+
+			std::string regex{};
+
+			const uint32_t nrOfBranches{ percent(generator) < 25 ? 2u : 1u };
+			for (uint32_t branch{}; branch < nrOfBranches; ++branch)
+			{
+				if (branch > 0) regex += '|';
+
+				const uint32_t nrOfPieces{ 1 + percent(generator) % 4 };
+				for (uint32_t piece{}; piece < nrOfPieces; ++piece)
+				{
+					const uint32_t atom{ percent(generator) };
+
+					if (atom < 45) regex += RegexLiterals[literal(generator)];
+					else if (atom < 80 || depth == 0) regex += RegexClasses[regexClass(generator)];
+					else regex += "(" + GenerateRegex(generator, depth - 1) + ")";
+
+					const uint32_t quantifier{ percent(generator) };
+
+					if (quantifier < 10) regex += '*';
+					else if (quantifier < 18) regex += '+';
+					else if (quantifier < 26) regex += '?';
+					else if (quantifier < 30) regex += "{1,3}";
+					else if (quantifier < 33) regex += "{2}";
+					else if (quantifier < 35) regex += "{2,}";
+				}
+			}
+
+			return regex;
+		}
+
+		/// <summary>
+		/// Generated regexes against std::regex, one line at a time. Now and then two regexes are searched together
+		/// </summary>
+		static bool TestRegex(std::mt19937& generator)
+		{
+			TestResult test{ "regex" };
+
+			std::uniform_int_distribution<uint32_t> percent{ 0, 99 };
+			std::uniform_int_distribution<size_t> lineSize{ 0, 20 };
+
+			for (uint32_t i{}; i < 1000; ++i)
+			{
+				const bool ignoreCase{ i % 2 == 1 };
+
+				std::vector<std::string> regexes{};
+				const uint32_t nrOfRegexes{ percent(generator) < 20 ? 2u : 1u };
+
+				for (uint32_t j{}; j < nrOfRegexes; ++j)
+				{
+					std::string regex{ GenerateRegex(generator, 2) };
+					if (percent(generator) < 15) regex = "^" + regex;
+					if (percent(generator) < 15) regex += "$";
+
+					regexes.push_back(std::move(regex));
+				}
+
+				std::vector<std::string> lines(40);
+				for (std::string& line : lines) line = GenerateString(generator, lineSize(generator), RegexLineAlphabet);
+
+				const Searcher searcher{ regexes, ignoreCase, true };
+				test.Check(searcher.IsValid(), [&]() { return "\"" + regexes.front() + "\" was rejected: " + searcher.GetError(); });
+				if (!searcher.IsValid()) continue;
+
+				std::vector<std::regex> references{};
+				for (const std::string& regex : regexes)
+				{
+					references.emplace_back(regex, ignoreCase ? std::regex::ECMAScript | std::regex::icase : std::regex::ECMAScript);
+				}
+
+				const LineMatches matches{ SearchLines(searcher, JoinLines(lines)) };
+				const LineMatches expected{ SearchLinesReference(lines, regexes.size(), [&references](const size_t patternIndex, const std::string& line)->bool
+					{
+						return std::regex_search(line, references[patternIndex]);
+					}) };
+
+				test.Check(matches == expected, [&]()
+					{
+						return std::string{ ignoreCase ? "ignoring case, " : "" } + DescribeDifference(matches, expected, regexes, lines);
+					});
+			}
+
+			return test.Finish();
+		}
+
+		inline static constexpr std::string_view MultiStringAlphabet{ "abcAB \t" };
+
+		/// <summary>
+		/// Sets of strings against std::string::find on every line. Up to Teddy::MaxNrOfPatterns strings go through Teddy, more through Aho-Corasick
+		/// Every set holds strings that overlap and share prefixes, and some sets an empty string or one with a newline, which never match
+		/// </summary>
+		static bool TestMultiString(std::mt19937& generator)
+		{
+			TestResult test{ "multiple strings" };
+
+			std::uniform_int_distribution<uint32_t> percent{ 0, 99 };
+			std::uniform_int_distribution<size_t> patternSize{ 1, 8 };
+			std::uniform_int_distribution<size_t> lineSize{ 0, 60 };
+
+			for (const size_t nrOfPatterns : { 1, 2, 3, 8, 31, 32, 33, 100 })
+			{
+				for (uint32_t i{}; i < 50; ++i)
+				{
+					const bool ignoreCase{ i % 2 == 1 };
+
+					std::vector<std::string> lines(50);
+					for (std::string& line : lines) line = GenerateString(generator, lineSize(generator), MultiStringAlphabet);
+
+					std::vector<std::string> patterns{};
+					while (patterns.size() < nrOfPatterns)
+					{
+						const std::string& line{ lines[percent(generator) % lines.size()] };
+						const size_t size{ patternSize(generator) };
+
+						// half of the strings are taken from the lines, so most lines match something
+						if (line.size() >= size && percent(generator) < 50) patterns.push_back(line.substr(percent(generator) % (line.size() - size + 1), size));
+						else patterns.push_back(GenerateString(generator, size, MultiStringAlphabet));
+					}
+
+					if (nrOfPatterns > 1 && percent(generator) < 20) patterns[1] = "";
+					if (nrOfPatterns > 2 && percent(generator) < 20) patterns[2] = "a\nb";
+
+					std::vector<std::string> lowercaseLines{ lines };
+					for (std::string& line : lowercaseLines) Detail::TransformStringToLowercase(line);
+
+					std::vector<std::string> lowercasePatterns{ patterns };
+					for (std::string& pattern : lowercasePatterns) Detail::TransformStringToLowercase(pattern);
+
+					const Searcher searcher{ patterns, ignoreCase, false };
+
+					const LineMatches matches{ SearchLines(searcher, JoinLines(lines)) };
+					const LineMatches expected{ SearchLinesReference(ignoreCase ? lowercaseLines : lines, patterns.size(), [&](const size_t patternIndex, const std::string& line)->bool
+						{
+							const std::string& pattern{ (ignoreCase ? lowercasePatterns : patterns)[patternIndex] };
+							return !pattern.empty() && line.find(pattern) != std::string::npos;
+						}) };
+
+					test.Check(matches == expected, [&]()
+						{
+							return std::to_string(nrOfPatterns) + " strings" + (ignoreCase ? " ignoring case, " : ", ") + DescribeDifference(matches, expected, patterns, lines);
+						});
+				}
+			}
+
+			// every byte value in some string, as a binary pattern file can have, leaves no byte for the class of bytes in no string
+			{
+				std::vector<std::string> patterns{};
+				std::vector<uint32_t> patternIndices{};
+				std::string buffer{};
+
+				for (uint32_t byte{}; byte < 256; ++byte)
+				{
+					patterns.push_back(std::string{ static_cast<char>(byte), static_cast<char>(255 - byte) });
+					patternIndices.push_back(byte);
+					buffer += patterns.back();
+				}
+
+				std::uniform_int_distribution<uint32_t> byte{ 0, 255 };
+				for (uint32_t i{}; i < 4096; ++i) buffer += static_cast<char>(byte(generator));
+
+				std::vector<std::pair<size_t, uint32_t>> matches{}, expected{};
+				Detail::AhoCorasick{ patterns, patternIndices, false }.Scan(buffer, [&matches](const size_t position, const uint32_t patternIndex)->void
+					{
+						matches.emplace_back(position, patternIndex);
+					});
+
+				for (uint32_t patternIndex{}; patternIndex < patterns.size(); ++patternIndex)
+				{
+					for (size_t position{ buffer.find(patterns[patternIndex]) }; position != std::string::npos; position = buffer.find(patterns[patternIndex], position + 1))
+					{
+						expected.emplace_back(position + 1, patternIndex);
+					}
+				}
+
+				std::sort(matches.begin(), matches.end());
+				std::sort(expected.begin(), expected.end());
+
+				test.Check(matches == expected, [&]()
+					{
+						return "with every byte value in the strings, Aho-Corasick found " + std::to_string(matches.size()) + " matches instead of " + std::to_string(expected.size());
+					});
+			}
+
+			return test.Finish();
+		}
+
+		/// <summary>
+		/// Whether some part of line is within maxNrOfErrors insertions, deletions or substitutions of string
+		/// The edit distance matrix one column at a time, where a match may start anywhere in the line
+		/// </summary>
+		static bool IsFuzzyMatchReference(const std::string_view string, const std::string_view line, const uint32_t maxNrOfErrors)
+		{
+			std::vector<uint32_t> column(string.size() + 1);
+			std::iota(column.begin(), column.end(), 0u);
+
+			if (column.back() <= maxNrOfErrors) return true;
+
+			for (const char c : line)
+			{
+				uint32_t diagonal{ column[0] };
+
+				for (size_t i{ 1 }; i <= string.size(); ++i)
+				{
+					const uint32_t above{ column[i] };
+					column[i] = std::min({ column[i] + 1, column[i - 1] + 1, diagonal + (string[i - 1] == c ? 0u : 1u) });
+					diagonal = above;
+				}
+
+				if (column.back() <= maxNrOfErrors) return true;
+			}
+
+			return false;
+		}
+
+		inline static constexpr std::string_view FuzzyAlphabet{ "abcdAB" };
+
+		/// <summary>
+		/// Strings of up to a few blocks of 64 characters against the edit distance computed in full
+		/// The lines hold copies of the strings with about as many errors as are allowed, so lines right below and above the limit come up
+		/// </summary>
+		static bool TestFuzzy(std::mt19937& generator)
+		{
+			TestResult test{ "fuzzy" };
+
+			std::uniform_int_distribution<uint32_t> percent{ 0, 99 };
+			std::uniform_int_distribution<size_t> character{ 0, FuzzyAlphabet.size() - 1 };
+
+			for (uint32_t maxNrOfErrors{}; maxNrOfErrors <= 3; ++maxNrOfErrors)
+			{
+				for (uint32_t i{}; i < 10; ++i)
+				{
+					const bool ignoreCase{ i % 2 == 1 };
+
+					std::vector<std::string> strings{};
+					for (const size_t size : { 1, 2, 3, 5, 8, 13, 20, 40, 63, 64, 65, 100, 127, 128, 129, 200 })
+					{
+						strings.push_back(GenerateString(generator, size, FuzzyAlphabet));
+					}
+
+					std::vector<std::string> lines(60);
+					for (std::string& line : lines)
+					{
+						std::string copy{ strings[percent(generator) % strings.size()] };
+
+						for (uint32_t nrOfErrors{ percent(generator) % (maxNrOfErrors + 2) }; nrOfErrors > 0 && !copy.empty(); --nrOfErrors)
+						{
+							const size_t position{ percent(generator) % copy.size() };
+							const uint32_t error{ percent(generator) % 3 };
+
+							if (error == 0) copy.insert(position, 1, FuzzyAlphabet[character(generator)]);
+							else if (error == 1) copy.erase(position, 1);
+							else copy[position] = FuzzyAlphabet[character(generator)];
+						}
+
+						line = GenerateString(generator, percent(generator) % 30, FuzzyAlphabet) + copy + GenerateString(generator, percent(generator) % 30, FuzzyAlphabet);
+					}
+
+					std::vector<std::string> lowercaseLines{ lines };
+					for (std::string& line : lowercaseLines) Detail::TransformStringToLowercase(line);
+
+					std::vector<std::string> lowercaseStrings{ strings };
+					for (std::string& string : lowercaseStrings) Detail::TransformStringToLowercase(string);
+
+					const Detail::FuzzyMatcher matcher{ strings, maxNrOfErrors, ignoreCase };
+
+					const LineMatches matches{ SearchLines(matcher, JoinLines(lines)) };
+					const LineMatches expected{ SearchLinesReference(ignoreCase ? lowercaseLines : lines, strings.size(), [&](const size_t patternIndex, const std::string& line)->bool
+						{
+							return IsFuzzyMatchReference((ignoreCase ? lowercaseStrings : strings)[patternIndex], line, maxNrOfErrors);
+						}) };
+
+					test.Check(matches == expected, [&]()
+						{
+							return std::to_string(maxNrOfErrors) + " errors" + (ignoreCase ? " ignoring case, " : ", ") + DescribeDifference(matches, expected, strings, lines);
+						});
+				}
+			}
+
+			return test.Finish();
+		}
+
+		/// <summary>
+		/// A buffer of a few chunks, with matches on the lines around the places it is split and a line that crosses one of them
+		/// Searched on the calling thread only, and together with a helper thread, against a search of one line at a time
+		/// </summary>
+		static bool TestChunkedSearch(std::mt19937& generator)
+		{
+			TestResult test{ "chunked search" };
+
+			constexpr std::string_view needle{ "chunk_needle" };
+			constexpr size_t nrOfChunks{ 3 };
+
+			std::string buffer{};
+			buffer.reserve(nrOfChunks * Detail::ParallelChunkSize + (1u << 20));
+
+			const std::string block{ JoinLines(std::vector<std::string>(1024, "some text without the string in it")) };
+			while (buffer.size() < nrOfChunks * Detail::ParallelChunkSize) buffer += block;
+
+			std::uniform_int_distribution<size_t> offset{ 0, 200 };
+			for (size_t i{ 1 }; i < nrOfChunks; ++i)
+			{
+				const size_t split{ buffer.size() / nrOfChunks * i };
+
+				for (const size_t position : { split - offset(generator), split, split + 1, split + offset(generator) })
+				{
+					buffer.replace(position, needle.size(), needle);
+				}
+			}
+
+			// a line that runs across the second split, with the string right after the split
+			const size_t longLineSplit{ buffer.size() / nrOfChunks * 2 };
+			std::replace(buffer.begin() + static_cast<ptrdiff_t>(longLineSplit - 5000), buffer.begin() + static_cast<ptrdiff_t>(longLineSplit + 5000), '\n', ' ');
+			buffer.replace(longLineSplit + 100, needle.size(), needle);
+
+			// the last line has no newline
+			buffer.append("the last line holds ").append(needle);
+
+			std::vector<uint32_t> expected{};
+			uint32_t lineNumber{ 1 };
+			for (size_t lineStart{}; lineStart <= buffer.size(); ++lineNumber)
+			{
+				const size_t lineEnd{ std::min(buffer.find('\n', lineStart), buffer.size()) };
+				if (std::string_view{ buffer }.substr(lineStart, lineEnd - lineStart).find(needle) != std::string_view::npos) expected.push_back(lineNumber);
+
+				lineStart = lineEnd + 1;
+			}
+
+			const Detail::StringMatcher<false> matcher{ needle };
+
+			std::vector<uint32_t> matches{};
+			const auto onMatch{ [&matches](const size_t, const uint32_t matchLineNumber)->void { matches.push_back(matchLineNumber); } };
+
+			Detail::SearchBufferInChunks(buffer, matcher, onMatch, nullptr, nullptr);
+			test.Check(matches == expected, [&]() { return "found " + std::to_string(matches.size()) + " lines instead of " + std::to_string(expected.size()) + " without helpers"; });
+
+			matches.clear();
+			{
+				Detail::SearchHelpers helpers{ 2 };
+				std::jthread helper{ [&helpers]() { helpers.HelpUntilDone(); } };
+
+				Detail::SearchBufferInChunks(buffer, matcher, onMatch, &helpers, nullptr);
+				helpers.HelpUntilDone();
+			}
+
+			test.Check(matches == expected, [&]() { return "found " + std::to_string(matches.size()) + " lines instead of " + std::to_string(expected.size()) + " with a helper"; });
+
+			return test.Finish();
+		}
+
+		/// <summary>
+		/// Files streamed through a reorder window while the first one is still being searched. Once the window skipped over it,
+		/// that file and every file after it are expected to be written as soon as they arrive, not once the window fills up again
+		/// </summary>
+		static bool TestResultWriter()
+		{
+			TestResult test{ "result writer" };
+
+			std::mutex mutex{};
+			std::condition_variable onWritten{};
+			std::vector<uint64_t> writtenFiles{};
+
+			const ResultCallback onResult{ [&](FileSearchResult&& result)->void
+				{
+					{
+						const std::lock_guard<std::mutex> lock{ mutex };
+						writtenFiles.push_back(std::stoull(result.Path));
+					}
+
+					onWritten.notify_one();
+				} };
+
+			Detail::ResultQueue queue{ Detail::ResultQueueCapacity };
+			Detail::ResultWriter writer{ queue, onResult, 2, nullptr };
+			std::jthread writerThread{ [&writer]() { writer.Run(); } };
+
+			const auto push{ [&](const uint64_t sequenceNumber, const size_t nrOfFilesWritten)->void
+				{
+					queue.Push(Detail::FileResults{ sequenceNumber, { FileSearchResult{ std::to_string(sequenceNumber), 0, { 1 }, false } } });
+
+					std::unique_lock<std::mutex> lock{ mutex };
+					const bool isWritten{ onWritten.wait_for(lock, std::chrono::seconds{ 5 }, [&]() { return writtenFiles.size() >= nrOfFilesWritten; }) };
+
+					test.Check(isWritten, [&]() { return "file " + std::to_string(sequenceNumber) + " left " + std::to_string(nrOfFilesWritten - writtenFiles.size()) + " files unwritten"; });
+				} };
+
+			// file 0 is still being searched, the third file after it overflows the window
+			push(1, 0);
+			push(2, 0);
+			push(3, 3);
+			push(4, 4);
+
+			// file 0 arrives late, then the files after it
+			push(0, 5);
+			push(5, 6);
+			push(6, 7);
+
+			queue.Close();
+			writerThread.join();
+
+			const std::vector<uint64_t> expected{ 1, 2, 3, 4, 0, 5, 6 };
+			test.Check(writtenFiles == expected, [&]()
+				{
+					std::string order{};
+					for (const uint64_t file : writtenFiles) order += std::to_string(file) + " ";
+
+					return "files were written in the order " + order;
+				});
+
+			return test.Finish();
+		}
+
+		/// <summary>
+		/// Escapes the way JSON requires, with the standard streams instead of the formatter's tables
+		/// </summary>
+		static std::string FormatJsonStringReference(const std::string_view string)
+		{
+			std::ostringstream stream{};
+			stream << '"';
+
+			for (const char c : string)
+			{
+				if (c == '"' || c == '\\') stream << '\\' << c;
+				else if (static_cast<unsigned char>(c) < 0x20) stream << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+				else stream << c;
+			}
+
+			stream << '"';
+			return stream.str();
+		}
+
+		/// <summary>
+		/// The formats as described at OutputFormat, written out with the standard streams like the output was before the formatter
+		/// </summary>
+		static std::string FormatFileResultsReference(const OutputFormat format, const std::vector<FileSearchResult>& results, const std::vector<std::string>& patterns, const bool isPatternNamed)
+		{
+			std::ostringstream stream{};
+
+			if (format == OutputFormat::Line)
+			{
+				if (results.front().IsBinary)
+				{
+					stream << "Binary file " << results.front().Path << " matches\n";
+					return stream.str();
+				}
+
+				std::set<uint32_t> lines{};
+				for (const FileSearchResult& result : results) lines.insert(result.LineNumbers.begin(), result.LineNumbers.end());
+
+				for (const uint32_t line : lines) stream << results.front().Path << ':' << line << '\n';
+				return stream.str();
+			}
+
+			for (const FileSearchResult& result : results)
+			{
+				if (format == OutputFormat::Json)
+				{
+					stream << "{\"path\":" << FormatJsonStringReference(result.Path) << ",\"pattern\":" << FormatJsonStringReference(patterns[result.PatternIndex])
+						<< ",\"binary\":" << (result.IsBinary ? "true" : "false") << ",\"lines\":[";
+
+					for (size_t i{}; i < result.LineNumbers.size(); ++i) stream << (i == 0 ? "" : ",") << result.LineNumbers[i];
+
+					stream << "]}\n";
+				}
+				else if (result.IsBinary)
+				{
+					stream << "Binary file " << result.Path << " matches";
+					if (isPatternNamed) stream << " \"" << patterns[result.PatternIndex] << '"';
+					stream << '\n';
+				}
+				else
+				{
+					stream << "Found " << result.LineNumbers.size() << " occurences";
+					if (isPatternNamed) stream << " of \"" << patterns[result.PatternIndex] << '"';
+					stream << " in " << result.Path << " at lines: ";
+
+					for (size_t i{}; i < result.LineNumbers.size(); ++i) stream << (i == 0 ? "" : ", ") << result.LineNumbers[i];
+
+					stream << '\n';
+				}
+			}
+
+			return stream.str();
+		}
+
+		/// <summary>
+		/// The results of generated files in every format, against the same results written with the standard streams
+		/// Paths and patterns hold what JSON has to escape, and line numbers run up to the largest there can be
+		/// </summary>
+		static bool TestResultFormat(std::mt19937& generator)
+		{
+			TestResult test{ "result format" };
+
+			const std::vector<std::string> patterns{ "needle", "say \"hi\"", "back\\slash\tand tab" };
+
+			std::uniform_int_distribution<uint32_t> percent{ 0, 99 };
+			std::uniform_int_distribution<uint32_t> lineNumber{ 1, std::numeric_limits<uint32_t>::max() };
+
+			std::vector<uint32_t> scratchLines{};
+
+			for (uint32_t i{}; i < 300; ++i)
+			{
+				const std::string path{ "dir/" + GenerateString(generator, 1 + percent(generator) % 12, "ab\"\\\x01\x1f :") + ".txt" };
+				const bool isBinary{ percent(generator) < 10 };
+
+				// one result per pattern found in the file, in the order of the patterns
+				std::vector<FileSearchResult> results{};
+				for (uint32_t patternIndex{}; patternIndex < patterns.size(); ++patternIndex)
+				{
+					if (percent(generator) < 40 && !(patternIndex + 1 == patterns.size() && results.empty())) continue;
+
+					std::vector<uint32_t> lines{};
+					if (!isBinary)
+					{
+						for (uint32_t j{ 1 + percent(generator) % 6 }; j > 0; --j) lines.push_back(percent(generator) < 10 ? lineNumber(generator) : 1 + percent(generator));
+
+						std::sort(lines.begin(), lines.end());
+						lines.erase(std::unique(lines.begin(), lines.end()), lines.end());
+					}
+
+					results.push_back(FileSearchResult{ path, patternIndex, std::move(lines), isBinary });
+				}
+
+				for (const OutputFormat format : { OutputFormat::Plain, OutputFormat::Line, OutputFormat::Json })
+				{
+					for (const bool isPatternNamed : { false, true })
+					{
+						std::string buffer{ "earlier output\n" };
+						Detail::FormatFileResults(buffer, format, results, patterns, isPatternNamed ? &patterns : nullptr, scratchLines);
+
+						const std::string expected{ "earlier output\n" + FormatFileResultsReference(format, results, patterns, isPatternNamed) };
+						test.Check(buffer == expected, [&]() { return "formatted\n" + buffer + "instead of\n" + expected; });
+					}
+				}
+			}
+
+			return test.Finish();
+		}
+
+		/// <summary>
+		/// A directory of files for the tests that search files, removed again when it goes out of scope
+		/// </summary>
+		class TestDirectory final
+		{
+		public:
+			explicit TestDirectory(const std::string_view name)
+				: m_Path{ std::filesystem::temp_directory_path() / "StringSearcherTests" / name }
+			{
+				std::filesystem::remove_all(m_Path);
+				std::filesystem::create_directories(m_Path);
+			}
+
+			~TestDirectory()
+			{
+				std::error_code error{};
+				std::filesystem::remove_all(m_Path, error);
+			}
+
+			TestDirectory(const TestDirectory&) noexcept = delete;
+			TestDirectory(TestDirectory&&) noexcept = delete;
+			TestDirectory& operator=(const TestDirectory&) noexcept = delete;
+			TestDirectory& operator=(TestDirectory&&) noexcept = delete;
+
+			/// <summary>
+			/// relativePath is separated by '/', missing directories are created
+			/// </summary>
+			void WriteFile(const std::string_view relativePath, const std::string_view contents) const
+			{
+				const std::filesystem::path path{ GetPath(relativePath) };
+				std::filesystem::create_directories(path.parent_path());
+
+				std::ofstream stream{ path, std::ios::binary | std::ios::trunc };
+				stream.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+			}
+
+			[[nodiscard]] std::filesystem::path GetPath(const std::string_view relativePath) const
+			{
+				return (m_Path / std::filesystem::path{ relativePath }).lexically_normal();
+			}
+
+			[[nodiscard]] std::string GetPath() const { return m_Path.string(); }
+
+			/// <summary>
+			/// The files of the results relative to the directory and separated by '/', sorted and without duplicates
+			/// </summary>
+			[[nodiscard]] std::vector<std::string> GetRelativePaths(const std::vector<FileSearchResult>& results) const
+			{
+				std::vector<std::string> paths{};
+
+				for (const FileSearchResult& result : results)
+				{
+					paths.push_back(std::filesystem::path{ result.Path }.lexically_relative(m_Path).generic_string());
+				}
+
+				std::sort(paths.begin(), paths.end());
+				paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+
+				return paths;
+			}
+
+		private:
+			std::filesystem::path m_Path;
+		};
+
+		static std::string JoinPaths(const std::vector<std::string>& paths)
+		{
+			std::string joined{};
+			for (const std::string& path : paths) joined += (joined.empty() ? "" : ", ") + path;
+
+			return joined;
+		}
+
+		/// <summary>
+		/// Recursive searches of a tree with .gitignore and .ignore files, with masks of name globs, path globs and excludes
+		/// Every file holds the string, so the files found are the files that were not pruned
+		/// </summary>
+		static bool TestFileMask()
+		{
+			TestResult test{ "masks and ignore files" };
+
+			const TestDirectory directory{ "mask" };
+
+			directory.WriteFile(".gitignore", "build/\n*.tmp\n!keep.tmp\n/rootonly.txt\n# a comment\n");
+			directory.WriteFile("src/.ignore", "*.log\n");
+
+			for (const std::string_view file : { "a.cpp", "b.h", "c.txt", "x.tmp", "keep.tmp", "rootonly.txt", "build/out.cpp", "src/rootonly.txt",
+				"src/d.cpp", "src/e_test.cpp", "src/f.log", "src/deep/g.cpp", "third_party/h.cpp", ".git/config", ".git/hook.cpp" })
+			{
+				directory.WriteFile(file, "the string is here\n");
+			}
+
+			struct MaskCase final
+			{
+				std::string_view Mask;
+				bool UseIgnoreFiles;
+				std::vector<std::string> Expected;
+			};
+
+			const MaskCase cases[]
+			{
+				{ "", true, { "a.cpp", "b.h", "c.txt", "keep.tmp", "src/d.cpp", "src/deep/g.cpp", "src/e_test.cpp", "src/rootonly.txt", "third_party/h.cpp" } },
+				{ "*.cpp;*.h;!*_test.cpp", true, { "a.cpp", "b.h", "src/d.cpp", "src/deep/g.cpp", "third_party/h.cpp" } },
+				{ "src/*.cpp", true, { "src/d.cpp", "src/e_test.cpp" } },
+				{ "src/**/*.cpp", true, { "src/d.cpp", "src/deep/g.cpp", "src/e_test.cpp" } },
+				{ "[ab].*", true, { "a.cpp", "b.h" } },
+				{ "?.cpp;!third_party;!deep", true, { "a.cpp", "src/d.cpp" } },
+				{ "*.tmp;*.log;*.cpp", false, { ".git/hook.cpp", "a.cpp", "build/out.cpp", "keep.tmp", "src/d.cpp", "src/deep/g.cpp", "src/e_test.cpp", "src/f.log", "third_party/h.cpp", "x.tmp" } },
+			};
+
+			for (const MaskCase& maskCase : cases)
+			{
+				std::vector<FileSearchResult> results{};
+				IsStringInFile(directory.GetPath(), "", { "the string" }, SearchOptions{ .Mask{ std::string{ maskCase.Mask }, maskCase.UseIgnoreFiles }, .RecursivelySearch = true }, results);
+
+				const std::vector<std::string> paths{ directory.GetRelativePaths(results) };
+				test.Check(paths == maskCase.Expected, [&]()
+					{
+						return "mask \"" + std::string{ maskCase.Mask } + "\"" + (maskCase.UseIgnoreFiles ? "" : " without ignore files") + " found " + JoinPaths(paths)
+							+ " instead of " + JoinPaths(maskCase.Expected);
+					});
+			}
+
+			return test.Finish();
+		}
+
+		/// <summary>
+		/// Writes files whose lines are made of a few words, so strings, regexes and fuzzy strings have something to find in most of them
+		/// </summary>
+		static void WriteSearchTree(std::mt19937& generator, const TestDirectory& directory, const uint32_t nrOfFiles)
+		{
+			constexpr std::string_view words[]{ "alpha", "beta", "gamma", "delta", "error", "timeout", "connection", "value" };
+			std::uniform_int_distribution<size_t> word{ 0, std::size(words) - 1 };
+
+			for (uint32_t i{}; i < nrOfFiles; ++i)
+			{
+				std::string contents{};
+				for (uint32_t line{ i % 7 }; line < 20; ++line)
+				{
+					contents.append(words[word(generator)]).append(" ").append(words[word(generator)]).append(std::to_string(line)).push_back('\n');
+				}
+
+				directory.WriteFile("dir" + std::to_string(i % 4) + "/file" + std::to_string(i) + ".txt", contents);
+			}
+		}
+
+		/// <summary>
+		/// The same search through an index, a cache or some other way is expected to give exactly the results of a recursive search
+		/// </summary>
+		static std::string DescribeResults(const std::vector<FileSearchResult>& results)
+		{
+			std::string description{};
+			for (const FileSearchResult& result : results)
+			{
+				description += result.Path + " (" + std::to_string(result.PatternIndex) + "): " + std::to_string(result.LineNumbers.size()) + " lines\n";
+			}
+
+			return description;
+		}
+
+		static bool AreResultsEqual(const std::vector<FileSearchResult>& results, const std::vector<FileSearchResult>& expected)
+		{
+			return std::equal(results.begin(), results.end(), expected.begin(), expected.end(), [](const FileSearchResult& result, const FileSearchResult& expectedResult)->bool
+				{
+					return result.Path == expectedResult.Path && result.PatternIndex == expectedResult.PatternIndex && result.LineNumbers == expectedResult.LineNumbers;
+				});
+		}
+
+		/// <summary>
+		/// Searches through a trigram index against recursive searches of the indexed directory, before and after files changed
+		/// </summary>
+		static bool TestIndex(std::mt19937& generator)
+		{
+			TestResult test{ "trigram index" };
+
+			const TestDirectory directory{ "index" };
+			WriteSearchTree(generator, directory, 40);
+
+			const std::string indexFile{ (directory.GetPath(".index")).string() };
+			test.Check(BuildIndex(directory.GetPath(), "*.txt", 0, indexFile, nullptr), []() { return std::string{ "the index could not be built" }; });
+
+			const auto compare{ [&](const std::string_view when)->void
+				{
+					const SearchOptions options{ .Mask{ "*.txt" }, .RecursivelySearch = true };
+					std::vector<FileSearchResult> results{}, expected{};
+
+					for (const std::vector<std::string>& strings : std::vector<std::vector<std::string>>{ { "error" }, { "timeout", "gamma1" }, { "delta1" }, { "not in any file" } })
+					{
+						IsStringInIndexedFiles(indexFile, strings, options, results);
+						IsStringInFile(directory.GetPath(), "", strings, options, expected);
+						test.Check(AreResultsEqual(results, expected), [&]() { return std::string{ when } + ", \"" + strings.front() + "\" found\n" + DescribeResults(results) + "instead of\n" + DescribeResults(expected); });
+					}
+
+					IsRegexInIndexedFiles(indexFile, { "con+ection[0-9]+" }, options, results);
+					IsRegexInFile(directory.GetPath(), "", { "con+ection[0-9]+" }, options, expected);
+					test.Check(AreResultsEqual(results, expected), [&]() { return std::string{ when } + ", the regex found\n" + DescribeResults(results) + "instead of\n" + DescribeResults(expected); });
+
+					IsFuzzyStringInIndexedFiles(indexFile, { "conection" }, 1, options, results);
+					IsFuzzyStringInFile(directory.GetPath(), "", { "conection" }, 1, options, expected);
+					test.Check(AreResultsEqual(results, expected), [&]() { return std::string{ when } + ", the fuzzy string found\n" + DescribeResults(results) + "instead of\n" + DescribeResults(expected); });
+				} };
+
+			compare("right after indexing");
+
+			// files that changed since the index was built are always searched
+			directory.WriteFile("dir0/file0.txt", "a new error line that is longer than the file was\ndelta1\n");
+			directory.WriteFile("dir1/file1.txt", "");
+			compare("after changing files");
+
+			test.Check(BuildIndex(directory.GetPath(), "*.txt", 0, indexFile, nullptr), []() { return std::string{ "the index could not be updated" }; });
+			compare("after updating the index");
+
+			return test.Finish();
+		}
+
+		/// <summary>
+		/// Searches limited to a number of matching lines per file, or stopped at the first match, against the same search without limits
+		/// A few files span several read blocks with their matches far apart, so a limit can be reached in any block
+		/// </summary>
+		static bool TestSearchLimits(std::mt19937& generator)
+		{
+			TestResult test{ "search limits" };
+
+			const TestDirectory directory{ "limits" };
+
+			std::uniform_int_distribution<uint32_t> percent{ 0, 99 };
+			for (uint32_t i{}; i < 12; ++i)
+			{
+				const bool isLarge{ i % 4 == 0 };
+				const uint32_t nrOfLines{ isLarge ? 60000u : 200u };
+
+				std::string contents{};
+				for (uint32_t line{}; line < nrOfLines; ++line)
+				{
+					const bool isMatch{ isLarge ? line % 9000 == 4500 : percent(generator) < 5 };
+					contents.append(isMatch ? "a line with the needle in it" : "a line of text without it, padded to be a bit longer").push_back('\n');
+				}
+
+				directory.WriteFile("file" + std::to_string(i) + ".txt", contents);
+			}
+
+			for (const bool isRegex : { false, true })
+			{
+				const std::vector<std::string> patterns{ isRegex ? "ne+dle" : "needle" };
+
+				const auto search{ [&](const SearchLimits limits, std::vector<FileSearchResult>& results)->void
+					{
+						const SearchOptions options{ .RecursivelySearch = true, .Limits = limits };
+
+						if (isRegex) IsRegexInFile(directory.GetPath(), "", patterns, options, results);
+						else IsStringInFile(directory.GetPath(), "", patterns, options, results);
+					} };
+
+				std::vector<FileSearchResult> allResults{}, results{};
+				search(SearchLimits{}, allResults);
+
+				for (const uint32_t maxMatchesPerFile : { 1, 2, 5 })
+				{
+					search(SearchLimits{ maxMatchesPerFile, false }, results);
+
+					// the first lines of every file, in the order they are in the file
+					std::vector<FileSearchResult> expected{ allResults };
+					for (FileSearchResult& result : expected) result.LineNumbers.resize(std::min<size_t>(result.LineNumbers.size(), maxMatchesPerFile));
+
+					test.Check(AreResultsEqual(results, expected), [&]()
+						{
+							return patterns.front() + " with at most " + std::to_string(maxMatchesPerFile) + " lines per file found\n" + DescribeResults(results) + "instead of\n" + DescribeResults(expected);
+						});
+				}
+
+				// the files that matched before the search stopped, each with its first line
+				search(SearchLimits{ 0, true }, results);
+
+				const bool areFirstLines{ std::all_of(results.begin(), results.end(), [&allResults](const FileSearchResult& result)->bool
+					{
+						const auto it{ std::find_if(allResults.begin(), allResults.end(), [&result](const FileSearchResult& other) { return other.Path == result.Path; }) };
+						return it != allResults.end() && result.LineNumbers.size() == 1 && result.LineNumbers.front() == it->LineNumbers.front();
+					}) };
+
+				test.Check(!results.empty() && areFirstLines, [&]()
+					{
+						return patterns.front() + " stopped at the first match found\n" + DescribeResults(results);
+					});
+			}
+
+			return test.Finish();
+		}
+
+#ifdef RDW_SS_HAS_INOTIFY
+		/// <summary>
+		/// Applies the events of the changes made so far. The kernel queues them right away, so they are waiting once the changes are made
+		/// </summary>
+		static void UpdateCache(DirectoryCache& cache)
+		{
+			pollfd descriptor{ cache.GetNotifyDescriptor(), POLLIN, 0 };
+			while (poll(&descriptor, 1, 100) > 0) cache.Update();
+		}
+
+		/// <summary>
+		/// Searches of the cached files, as the daemon runs them, against recursive searches while files and directories are created, moved and deleted
+		/// </summary>
+		static bool TestDirectoryCache(std::mt19937& generator)
+		{
+			TestResult test{ "directory cache" };
+
+			const TestDirectory directory{ "cache" };
+			WriteSearchTree(generator, directory, 40);
+
+			DirectoryCache cache{ directory.GetPath(), "", 0 };
+			test.Check(cache.IsValid(), []() { return std::string{ "the cache could not watch the directory" }; });
+			if (!cache.IsValid()) return test.Finish();
+
+			const auto compare{ [&](const std::string_view when)->void
+				{
+					const SearchOptions options{ .RecursivelySearch = true };
+					std::vector<FileSearchResult> results{}, expected{};
+
+					IsStringInCachedFiles(cache, directory.GetPath(), { "error", "value" }, options, results);
+					IsStringInFile(directory.GetPath(), "", { "error", "value" }, options, expected);
+					test.Check(AreResultsEqual(results, expected), [&]() { return std::string{ when } + ", found\n" + DescribeResults(results) + "instead of\n" + DescribeResults(expected); });
+
+					// a client in a subdirectory only searches below it
+					const std::string subdirectory{ directory.GetPath("dir2").string() };
+					IsStringInCachedFiles(cache, subdirectory, { "error" }, options, results);
+					IsStringInFile(subdirectory, "", { "error" }, options, expected);
+					test.Check(AreResultsEqual(results, expected), [&]() { return std::string{ when } + ", in a subdirectory found\n" + DescribeResults(results) + "instead of\n" + DescribeResults(expected); });
+				} };
+
+			compare("right after walking");
+
+			directory.WriteFile("dir0/new.txt", "a new error\n");
+			directory.WriteFile("new_dir/deeper/file.txt", "an error in a new directory\n");
+			std::filesystem::remove(directory.GetPath("dir1/file1.txt"));
+			std::filesystem::rename(directory.GetPath("dir3"), directory.GetPath("dir2/moved"));
+			UpdateCache(cache);
+			compare("after creating, deleting and moving files");
+
+			std::filesystem::remove_all(directory.GetPath("dir2/moved"));
+			directory.WriteFile(".gitignore", "dir0/\n");
+			UpdateCache(cache);
+			compare("after deleting a directory and ignoring another one");
+
+			return test.Finish();
+		}
+#endif
+	}
+}
+
+int main()
+{
+	using namespace RDW_SS::Tests;
+
+	std::mt19937 generator{ Seed };
+
+	bool isCorrect{ true };
+	isCorrect &= TestFindStringKernels(generator);
+	isCorrect &= TestRegex(generator);
+	isCorrect &= TestMultiString(generator);
+	isCorrect &= TestFuzzy(generator);
+	isCorrect &= TestChunkedSearch(generator);
+	isCorrect &= TestResultWriter();
+	isCorrect &= TestResultFormat(generator);
+	isCorrect &= TestFileMask();
+	isCorrect &= TestIndex(generator);
+	isCorrect &= TestSearchLimits(generator);
+#ifdef RDW_SS_HAS_INOTIFY
+	isCorrect &= TestDirectoryCache(generator);
+#endif
+
+	return isCorrect ? 0 : 1;
+}
@@ -1,6 +1,12 @@
 #pragma once
 
+#include <algorithm> /* std::min */
+#include <chrono> /* std::chrono::steady_clock */
+#include <cmath> /* abs */
+#include <cstdint> /* int64_t */
+#include <limits> /* std::numeric_limits */
 #include <memory> /* std::unique_ptr */
+#include <type_traits> /* std::is_fundamental_v */
 
 #ifdef max
 #	undef max
@@ -207,6 +213,7 @@ namespace RDW_SS::Time
 
 		[[nodiscard]] static Timepoint Now()
 		{
+#ifdef _WIN32
 			const int64_t frequency{ _Query_perf_frequency() };
 			const int64_t counter{ _Query_perf_counter() };
 
@@ -232,6 +239,11 @@ namespace RDW_SS::Time
 				const int64_t part = (counter % frequency) * static_cast<int64_t>(SecToNano) / frequency;
 				return Timepoint{ (whole + part) * NanoToSec };
 			}
+#else
+			// steady_clock is monotonic like QPC, on Linux it is backed by CLOCK_MONOTONIC
+			const int64_t nanoSeconds{ std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count() };
+			return Timepoint{ nanoSeconds * NanoToSec };
+#endif
 		}
 
 		[[nodiscard]] double GetElapsedSeconds() const { return m_ElapsedSeconds; }
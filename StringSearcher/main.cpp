@@ -2,30 +2,119 @@
 
 #include <chrono>
 #include <filesystem>
+#include <fstream>
 #include <string>
+#include <vector>
+
+#ifdef RDW_SS_HAS_INOTIFY
+#include <csignal>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#endif
 
 /*
 command line format:
-	StringSearcher.exe [--recursive N | -r  N] [--ignorecase | -i] [--file <file> | -f <file>] <strings> <mask>
+	StringSearcher.exe [--recursive N | -r  N] [--ignorecase | -i] [--file <file> | -f <file>] [--pattern <string> | -e <string>]... [--patternfile <file> | -p <file>] [--regex | -x] [--fuzzy K] [--stream N | -s] [--buildindex <file> | -b <file>] [--index <file>] [--stats [text | json]] [--binary skip | match | text] [--format plain | line | json] [--files-with-matches | -l] [--max-count N | -m N] [--quiet | -q] [--include <glob>]... [--exclude <glob>]... [--no-ignore] [--daemon <socket>] <strings> <mask>
 
 	command line options :
 		--recursive [N]		search current directory and subdirectories, limited to N levels deep of sub directories. If N is not given or 0, this is unlimited
 		--ignorecase		ignore case of characters
 		--file				file to look through (required when --recursive or -r are not specified)
+		--pattern			string to search for, can be given several times to search for all of them in a single pass
+		--patternfile		file with one string to search for per line
+		--regex				the strings are regular expressions
+		--fuzzy K			also match the strings with up to K characters inserted, deleted or substituted, not together with --regex
+		--stream [N]		print the results of every file as soon as it is searched. With N, files are printed in the order they were found, with a slow file holding back at most N others
+		--buildindex		build or update an index of the current directory and its subdirectories in the given file, limited by the mask and --recursive. No strings are given
+		--index				search the files of the given index instead of walking the directory, only reading files that can contain a match
+		--stats [F]			print the bytes, lines and matches searched and the time spent in every phase of the search. F is text (the default) or json
+		--binary M			what to do with binary files: skip them (the default), match to only report that they match, or text to search them like any other file
+		--format F			how results are printed: plain (the default), line for one <file>:<line> per matching line like grep -n, or json for one JSON object per file and string. line and json print nothing but the results
+		--files-with-matches	only print the files that contain a match, every file stops being searched at its first match
+		--max-count N		stop searching a file after N matching lines
+		--quiet				print nothing and stop at the first match, the exit code is 0 when a match was found and 1 otherwise
+		--include			only search files matching the glob, can be given several times
+		--exclude			skip files and directories matching the glob, can be given several times
+		--no-ignore			also search what .gitignore and .ignore files exclude, and .git directories
+		--daemon			keep the files of the current directory and its subdirectories in memory, limited by the mask and --recursive, and search them for the clients of the given socket. Linux only
+		--client			must come first: pass the other arguments on to the daemon of the given socket, which searches its files instead of walking the directory. Linux only
 		-r					search current directory and subdirectories. Same as --recursive 0
 		-i					ignore case of characters
 		-f					file to look through (required when --recursive or -r are not specified)
+		-e					same as --pattern
+		-p					same as --patternfile
+		-x					same as --regex
+		-s					print the results of every file as soon as it is searched. Same as --stream 0
+		-l					same as --files-with-matches
+		-m					same as --max-count
+		-q					same as --quiet
+		-b					same as --buildindex
 
 	example:
 		D:\ExampleDir\> StringSearch.exe -i --file hello_world.txt "Hello World"
 		D:\ExampleDir\> StringSearch.exe --recursive 3 "Hello World"
 		D:\ExampleDir\> StringSearch.exe --recursive -i Hello!
+		D:\ExampleDir\> StringSearcher.exe --recursive -e ERROR_1 -e ERROR_2 *.log
+		D:\ExampleDir\> StringSearcher.exe --recursive -x "ERROR_[0-9]+: .*timeout" *.log
+		D:\ExampleDir\> StringSearcher.exe --recursive --fuzzy 2 -i ConnectionTimeout *.log
+		D:\ExampleDir\> StringSearcher.exe --buildindex search.idx *.log
+		D:\ExampleDir\> StringSearcher.exe --index search.idx -i timeout
+		D:\ExampleDir\> StringSearcher.exe -r -l TODO *.cpp
+		D:\ExampleDir\> StringSearcher.exe -r --exclude third_party TODO "*.cpp;*.h"
+		~/project$ StringSearcher --daemon /tmp/search.sock -r &
+		~/project/src$ StringSearcher --client /tmp/search.sock -r TODO *.cpp
 */
 
+#ifdef RDW_SS_HAS_INOTIFY
+using DirectoryCache = RDW_SS::DirectoryCache;
+#else
+// the daemon needs inotify
+struct DirectoryCache;
+#endif
+
+/// <summary>
+/// pCache is only set for the searches a daemon runs for its clients
+/// </summary>
+int RunCmdLine(int argc, char* argv[], const std::string& currentDir, DirectoryCache* pCache);
+
 namespace RDW_SS
 {
 	namespace
 	{
+		/// <summary>
+		/// Everything the command line asks for, as given. RunCmdLine fills in what it depends on, such as the mask with --include and --exclude
+		/// </summary>
+		struct CmdOptions final
+		{
+			std::vector<std::string> StringsToSearch{};
+			std::string Mask{};
+			std::string FileToSearch{};
+			bool IgnoreCase{};
+			bool UseRegex{};
+			bool UseFuzzy{};
+			uint32_t MaxNrOfErrors{};
+			bool RecursivelySearch{};
+			uint32_t RecursiveDepth{}; // 0 for no limit
+			bool StreamResults{};
+			int32_t ReorderWindow{};
+			std::string IndexToBuild{};
+			std::string IndexToSearch{};
+			bool PrintStatistics{};
+			bool PrintStatisticsAsJson{};
+			RDW_SS::BinaryFileMode BinaryMode{ RDW_SS::BinaryFileMode::Skip };
+			RDW_SS::OutputFormat Format{ RDW_SS::OutputFormat::Plain };
+			bool ListFiles{};
+			bool Quiet{};
+			uint32_t MaxCount{}; // 0 for no limit
+			std::vector<std::string> Includes{};
+			std::vector<std::string> Excludes{};
+			bool UseIgnoreFiles{ true };
+			std::string DaemonSocket{};
+			bool HasPatternFile{}; // the file is not read for the client of a daemon
+		};
+
 		static bool IsArgDigit(char* pArg)
 		{
 			while (*pArg != '\0')
@@ -36,157 +125,839 @@ namespace RDW_SS
 			return true;
 		}
 
-		static void ParseCmdArgs(int argc, char* argv[], std::string& stringToSearch, std::string& mask, bool& ignoreCase, bool& recursivelySearch, int32_t& recursiveDepth, std::string& fileToSearch)
+		static void ReadPatternFile(const std::string& patternFile, std::vector<std::string>& stringsToSearch)
 		{
+			std::ifstream stream{ patternFile };
+
+			if (!stream.is_open())
+			{
+				std::cout << "Warning: Could not open pattern file: " << patternFile << "\n";
+				return;
+			}
+
+			std::string pattern{};
+			while (std::getline(stream, pattern))
+			{
+				if (!pattern.empty() && pattern.back() == '\r') pattern.pop_back();
+				if (!pattern.empty()) stringsToSearch.push_back(pattern);
+			}
+		}
+
+		static CmdOptions ParseCmdArgs(int argc, char* argv[], const bool isDaemonClient)
+		{
+			CmdOptions options{};
+			std::vector<std::string> positionalArgs{};
+
 			for (int i{ 1 }; i < argc; ++i)
 			{
 				const std::string& currentArg{ argv[i] };
 
 				if (currentArg == "--recursive")
 				{
-					recursivelySearch = true;
+					options.RecursivelySearch = true;
 
 					// Check if next arg is a number
 					if (i < argc - 1 && IsArgDigit(argv[i + 1]))
 					{
-						recursiveDepth = std::stoi(argv[++i]);
+						options.RecursiveDepth = static_cast<uint32_t>(std::stoul(argv[++i]));
 					}
 				}
 				else if (currentArg == "-r")
 				{
-					recursivelySearch = true;
+					options.RecursivelySearch = true;
 				}
 				else if (currentArg == "--ignorecase" || currentArg == "-i")
 				{
-					ignoreCase = true;
+					options.IgnoreCase = true;
+				}
+				else if (currentArg == "--stream")
+				{
+					options.StreamResults = true;
+
+					// Check if next arg is a number
+					if (i < argc - 1 && IsArgDigit(argv[i + 1]))
+					{
+						options.ReorderWindow = std::stoi(argv[++i]);
+					}
+				}
+				else if (currentArg == "-s")
+				{
+					options.StreamResults = true;
+				}
+				else if (currentArg == "--stats")
+				{
+					options.PrintStatistics = true;
+
+					// Check if next arg is a format
+					if (i < argc - 1 && (std::string_view{ argv[i + 1] } == "text" || std::string_view{ argv[i + 1] } == "json"))
+					{
+						options.PrintStatisticsAsJson = std::string_view{ argv[++i] } == "json";
+					}
+				}
+				else if (currentArg == "--binary")
+				{
+					const std::string_view mode{ i < argc - 1 ? argv[++i] : "" };
+
+					if (mode == "skip") options.BinaryMode = RDW_SS::BinaryFileMode::Skip;
+					else if (mode == "match") options.BinaryMode = RDW_SS::BinaryFileMode::ReportMatch;
+					else if (mode == "text") options.BinaryMode = RDW_SS::BinaryFileMode::SearchAsText;
+					else std::cout << "Warning: --binary expects skip, match or text, binary files are being skipped\n";
+				}
+				else if (currentArg == "--format")
+				{
+					const std::string_view format{ i < argc - 1 ? argv[++i] : "" };
+
+					if (format == "plain") options.Format = RDW_SS::OutputFormat::Plain;
+					else if (format == "line") options.Format = RDW_SS::OutputFormat::Line;
+					else if (format == "json") options.Format = RDW_SS::OutputFormat::Json;
+					else std::cout << "Warning: --format expects plain, line or json, results are being printed as plain\n";
+				}
+				else if (currentArg == "--regex" || currentArg == "-x")
+				{
+					options.UseRegex = true;
+				}
+				else if (currentArg == "--files-with-matches" || currentArg == "-l")
+				{
+					options.ListFiles = true;
+				}
+				else if (currentArg == "--quiet" || currentArg == "-q")
+				{
+					options.Quiet = true;
+				}
+				else if (currentArg == "--include" || currentArg == "--exclude")
+				{
+					if (i < argc - 1)
+					{
+						(currentArg == "--include" ? options.Includes : options.Excludes).push_back(argv[++i]);
+					}
+					else
+					{
+						std::cout << "Warning: Missing glob for " << currentArg << "\n";
+					}
+				}
+				else if (currentArg == "--daemon")
+				{
+					if (i < argc - 1)
+					{
+						options.DaemonSocket = argv[++i];
+					}
+					else
+					{
+						std::cout << "Warning: Missing socket for --daemon\n";
+					}
+				}
+				else if (currentArg == "--no-ignore")
+				{
+					options.UseIgnoreFiles = false;
+				}
+				else if (currentArg == "--max-count" || currentArg == "-m")
+				{
+					if (i < argc - 1 && IsArgDigit(argv[i + 1]))
+					{
+						options.MaxCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+					}
+					else
+					{
+						std::cout << "Warning: Missing number for --max-count (-m)\n";
+					}
+				}
+				else if (currentArg == "--fuzzy")
+				{
+					if (i < argc - 1 && IsArgDigit(argv[i + 1]))
+					{
+						options.UseFuzzy = true;
+						options.MaxNrOfErrors = static_cast<uint32_t>(std::stoul(argv[++i]));
+					}
+					else
+					{
+						std::cout << "Warning: Missing number for --fuzzy\n";
+					}
 				}
 				else if (currentArg == "--file" || currentArg == "-f")
 				{
 					if (i < argc - 1)
 					{
-						fileToSearch = argv[++i];
+						options.FileToSearch = argv[++i];
 					}
 					else
 					{
 						std::cout << "Warning: Missing argument for --file (-f)\n";
 					}
 				}
-				else if (currentArg[0] == '"')
+				else if (currentArg == "--buildindex" || currentArg == "-b")
 				{
-					stringToSearch = currentArg;
-					stringToSearch.pop_back();
-					stringToSearch.erase(stringToSearch.begin());
+					if (i < argc - 1)
+					{
+						options.IndexToBuild = argv[++i];
+					}
+					else
+					{
+						std::cout << "Warning: Missing argument for --buildindex (-b)\n";
+					}
 				}
-				else
+				else if (currentArg == "--index")
 				{
-					// no cmd, so fill in stringToSearch and mask, in that order
-					if (stringToSearch.empty())
+					if (i < argc - 1)
 					{
-						stringToSearch = currentArg;
+						options.IndexToSearch = argv[++i];
 					}
-					else if (mask.empty())
+					else
 					{
-						mask = currentArg;
+						std::cout << "Warning: Missing argument for --index\n";
+					}
+				}
+				else if (currentArg == "--pattern" || currentArg == "-e")
+				{
+					if (i < argc - 1)
+					{
+						options.StringsToSearch.push_back(argv[++i]);
 					}
 					else
 					{
-						std::cout << "Warning, argument " << currentArg << " is unknown and being discarded\n";
+						std::cout << "Warning: Missing argument for --pattern (-e)\n";
 					}
 				}
+				else if (currentArg == "--patternfile" || currentArg == "-p")
+				{
+					if (i < argc - 1)
+					{
+						options.HasPatternFile = true;
+
+						// the daemon would read a file of its own rather than the client's, so it is refused instead
+						if (isDaemonClient) ++i;
+						else ReadPatternFile(argv[++i], options.StringsToSearch);
+					}
+					else
+					{
+						std::cout << "Warning: Missing argument for --patternfile (-p)\n";
+					}
+				}
+				else if (currentArg[0] == '"')
+				{
+					std::string arg{ currentArg };
+					arg.pop_back();
+					arg.erase(arg.begin());
+					positionalArgs.push_back(arg);
+				}
+				else
+				{
+					positionalArgs.push_back(currentArg);
+				}
+			}
+
+			// no cmd, so fill in the string to search (unless given through --pattern or --patternfile, or building an index) and mask, in that order
+			const bool hasPatterns{ !options.StringsToSearch.empty() || !options.IndexToBuild.empty() || !options.DaemonSocket.empty() };
+			for (const std::string& arg : positionalArgs)
+			{
+				if (!hasPatterns && options.StringsToSearch.empty())
+				{
+					options.StringsToSearch.push_back(arg);
+				}
+				else if (options.Mask.empty())
+				{
+					options.Mask = arg;
+				}
+				else
+				{
+					std::cout << "Warning, argument " << arg << " is unknown and being discarded\n";
+				}
 			}
+
+			return options;
 		}
 
-		static bool CheckCmdArgs(const std::string& stringToSearch, const std::string& fileToSearch, const bool recursivelySearch)
+		static bool CheckCmdArgs(const CmdOptions& options)
 		{
-			if (!recursivelySearch)
+			if (!options.IndexToBuild.empty()) return options.StringsToSearch.empty() && options.IndexToSearch.empty();
+
+			if (!options.RecursivelySearch && options.IndexToSearch.empty())
 			{
-				if (fileToSearch.empty() || fileToSearch.find("*") != std::string::npos) return false;
+				if (options.FileToSearch.empty() || options.FileToSearch.find("*") != std::string::npos) return false;
 			}
 
-			if (!fileToSearch.empty() && !std::filesystem::path{ fileToSearch }.has_extension())
+			if (!options.FileToSearch.empty() && !std::filesystem::path{ options.FileToSearch }.has_extension())
 			{
 				return false;
 			}
 
-			if (stringToSearch.empty()) return false;
+			if (options.StringsToSearch.empty()) return false;
+
+			return std::none_of(options.StringsToSearch.cbegin(), options.StringsToSearch.cend(), [](const std::string& str) { return str.empty(); });
+		}
+
+		/// <summary>
+		/// Prints every file once, results is sorted by path
+		/// </summary>
+		static void PrintMatchingFiles(const std::vector<RDW_SS::FileSearchResult>& results)
+		{
+			for (size_t i{}; i < results.size(); ++i)
+			{
+				if (i == 0 || results[i].Path != results[i - 1].Path) std::cout << results[i].Path << "\n";
+			}
+		}
+
+		static void PrintFoundStrings(const std::vector<RDW_SS::FileSearchResult>& results, const uint32_t patternIndex, RDW_SS::ResultPrinter& printer)
+		{
+			size_t nrOfOccurences{}, nrOfFiles{};
+			for (const RDW_SS::FileSearchResult& result : results)
+			{
+				if (result.PatternIndex != patternIndex) continue;
+
+				nrOfOccurences += result.LineNumbers.size();
+				++nrOfFiles;
+			}
+
+			if (nrOfFiles == 0)
+			{
+				std::cout << "No occurences found!\n";
+				return;
+			}
+
+			std::cout << "Found " << nrOfOccurences << " of string search occurences across " << nrOfFiles << " files\n";
+
+			// results are sorted by path, so the output is the same every run
+			printer.Write(results, patternIndex);
+		}
+
+		static void PrintNrOfFilesSearched(const RDW_SS::StringSearchStatistics& statistics)
+		{
+			std::cout << "Searched through " << statistics.NumberOfFilesSearched << " files\n";
+
+			if (statistics.NumberOfBinaryFilesSkipped > 0)
+			{
+				std::cout << "Skipped " << statistics.NumberOfBinaryFilesSkipped << " binary files\n";
+			}
+		}
+
+		static double ToMilliseconds(const uint64_t nanoseconds)
+		{
+			return static_cast<double>(nanoseconds) / 1'000'000.0;
+		}
+
+		static void PrintStatistics(const RDW_SS::StringSearchStatistics& statistics, const bool asJson)
+		{
+			if (asJson)
+			{
+				std::cout << "{\"files_searched\":" << statistics.NumberOfFilesSearched
+					<< ",\"binary_files_skipped\":" << statistics.NumberOfBinaryFilesSkipped
+					<< ",\"bytes_read\":" << statistics.NumberOfBytesRead
+					<< ",\"lines_scanned\":" << statistics.NumberOfLinesScanned
+					<< ",\"matches\":" << statistics.NumberOfMatches
+					<< ",\"open_failures\":" << statistics.NumberOfOpenFailures
+					<< ",\"total_ns\":" << statistics.TotalTime
+					<< ",\"enumeration_ns\":" << statistics.EnumerationTime
+					<< ",\"open_ns\":" << statistics.OpenTime
+					<< ",\"read_ns\":" << statistics.ReadTime
+					<< ",\"match_ns\":" << statistics.MatchTime
+					<< ",\"wait_ns\":" << statistics.WaitTime
+					<< ",\"output_ns\":" << statistics.OutputTime << "}\n";
+
+				return;
+			}
+
+			std::cout << "\nStatistics:\n";
+			std::cout << "Files searched:		" << statistics.NumberOfFilesSearched << "\n";
+			std::cout << "Binary files skipped:	" << statistics.NumberOfBinaryFilesSkipped << "\n";
+			std::cout << "Bytes read:			" << statistics.NumberOfBytesRead << "\n";
+			std::cout << "Lines scanned:		" << statistics.NumberOfLinesScanned << "\n";
+			std::cout << "Matches:			" << statistics.NumberOfMatches << "\n";
+			std::cout << "Open failures:		" << statistics.NumberOfOpenFailures << "\n";
+			std::cout << "Total:				" << ToMilliseconds(statistics.TotalTime) << " ms\n";
+			std::cout << "Phases, summed over all threads:\n";
+			std::cout << "Enumeration:		" << ToMilliseconds(statistics.EnumerationTime) << " ms\n";
+			std::cout << "Open:				" << ToMilliseconds(statistics.OpenTime) << " ms\n";
+			std::cout << "Read:				" << ToMilliseconds(statistics.ReadTime) << " ms\n";
+			std::cout << "Match:				" << ToMilliseconds(statistics.MatchTime) << " ms\n";
+			std::cout << "Wait:				" << ToMilliseconds(statistics.WaitTime) << " ms\n";
+			std::cout << "Output:				" << ToMilliseconds(statistics.OutputTime) << " ms\n";
+		}
+
+#ifdef RDW_SS_HAS_INOTIFY
+		static bool MakeSocketAddress(const std::string& socketPath, sockaddr_un& address)
+		{
+			if (socketPath.size() >= sizeof(address.sun_path))
+			{
+				std::cout << "Socket path is too long: " << socketPath << "\n";
+				return false;
+			}
+
+			address.sun_family = AF_UNIX;
+			std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+			return true;
+		}
+
+		static bool SendAll(const int socketDescriptor, std::string_view data)
+		{
+			while (!data.empty())
+			{
+				const ssize_t bytesSent{ send(socketDescriptor, data.data(), data.size(), MSG_NOSIGNAL) };
+				if (bytesSent <= 0) return false;
+
+				data.remove_prefix(static_cast<size_t>(bytesSent));
+			}
 
 			return true;
 		}
+
+		static std::string ReceiveAll(const int socketDescriptor)
+		{
+			std::string data{};
+			char buffer[1u << 14];
+
+			for (;;)
+			{
+				const ssize_t bytesReceived{ recv(socketDescriptor, buffer, sizeof(buffer), 0) };
+				if (bytesReceived <= 0) break;
+
+				data.append(buffer, static_cast<size_t>(bytesReceived));
+			}
+
+			return data;
+		}
+
+		/// <summary>
+		/// Passes the arguments on to the daemon listening on socketPath, and prints its answer
+		/// A request is the current directory followed by every argument, each ending in a '\0'. The answer is the output of the search followed by a byte holding its exit code
+		/// </summary>
+		static int RunClient(const std::string& socketPath, const std::string& currentDir, const std::vector<std::string>& args)
+		{
+			sockaddr_un address{};
+			if (!MakeSocketAddress(socketPath, address)) return 1;
+
+			const int server{ socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0) };
+			if (server == -1 || connect(server, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+			{
+				std::cout << "Could not connect to a daemon on " << socketPath << "\n";
+				if (server != -1) close(server);
+
+				return 1;
+			}
+
+			std::string request{ currentDir };
+			request += '\0';
+
+			for (const std::string& arg : args)
+			{
+				request += arg;
+				request += '\0';
+			}
+
+			const bool isSent{ SendAll(server, request) };
+			shutdown(server, SHUT_WR);
+
+			// the answer is printed as it comes in, only its last byte is held back until the daemon is done
+			std::string answer{};
+			char buffer[1u << 14];
+
+			while (isSent)
+			{
+				const ssize_t bytesReceived{ recv(server, buffer, sizeof(buffer), 0) };
+				if (bytesReceived <= 0) break;
+
+				answer.append(buffer, static_cast<size_t>(bytesReceived));
+				std::cout.write(answer.data(), static_cast<std::streamsize>(answer.size() - 1));
+				answer.erase(0, answer.size() - 1);
+			}
+
+			close(server);
+
+			if (answer.empty())
+			{
+				std::cout << "The daemon on " << socketPath << " did not answer\n";
+				return 1;
+			}
+
+			return static_cast<unsigned char>(answer.back());
+		}
+
+		/// <summary>
+		/// A client can only search the files of the daemon, so the options that would make the daemon read or write any other file are refused
+		/// </summary>
+		static bool CheckClientArgs(const CmdOptions& options)
+		{
+			const char* pRefusedArg{ !options.IndexToBuild.empty() ? "--buildindex"
+				: !options.IndexToSearch.empty() ? "--index"
+				: options.HasPatternFile ? "--patternfile"
+				: !options.DaemonSocket.empty() ? "--daemon"
+				: nullptr };
+
+			if (!pRefusedArg) return true;
+
+			std::cout << pRefusedArg << " is not supported by a daemon\n";
+			return false;
+		}
+
+		/// <summary>
+		/// Runs the search a client asked for against the cache, with everything it prints going back to the client
+		/// </summary>
+		static void AnswerClient(const int client, RDW_SS::DirectoryCache& cache)
+		{
+			// a client that never finishes its request can not hold up the daemon
+			const timeval timeout{ 5, 0 };
+			setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+			std::string request{ ReceiveAll(client) };
+
+			std::vector<char*> args{};
+			for (size_t start{}; start < request.size(); start = request.find('\0', start) + 1)
+			{
+				if (request.find('\0', start) == std::string::npos) break;
+
+				args.push_back(request.data() + start);
+			}
+
+			if (args.empty()) return;
+
+			// the first field is the client's current directory, it takes the place of the program name
+			const std::string currentDir{ args.front() };
+
+			// the search prints straight to the client, through std::cout as well as through the writes of a ResultPrinter
+			std::cout.flush();
+			std::fflush(stdout);
+
+			const int daemonOutput{ dup(STDOUT_FILENO) };
+			dup2(client, STDOUT_FILENO);
+
+			const int exitCode{ RunCmdLine(static_cast<int>(args.size()), args.data(), currentDir, &cache) };
+
+			std::cout.flush();
+			std::fflush(stdout);
+
+			dup2(daemonOutput, STDOUT_FILENO);
+			close(daemonOutput);
+
+			// a client that went away leaves stdout in an error state
+			std::clearerr(stdout);
+			std::cout.clear();
+
+			const char exitCodeByte{ static_cast<char>(exitCode) };
+			SendAll(client, std::string_view{ &exitCodeByte, 1 });
+		}
+
+		/// <summary>
+		/// Keeps the files of currentDir in a DirectoryCache and answers the searches of clients on socketPath, one at a time, until it is killed
+		/// </summary>
+		static int RunDaemon(const std::string& socketPath, const std::string& currentDir, const RDW_SS::FileMask& fileMask, const uint32_t recursiveDepth)
+		{
+			sockaddr_un address{};
+			if (!MakeSocketAddress(socketPath, address)) return 1;
+
+			RDW_SS::DirectoryCache cache{ currentDir, fileMask, recursiveDepth };
+			if (!cache.IsValid()) return 1;
+
+			// a socket left behind by a daemon that was killed
+			unlink(socketPath.c_str());
+
+			// writing to a client that went away fails instead of killing the daemon
+			std::signal(SIGPIPE, SIG_IGN);
+
+			const int listener{ socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0) };
+
+			// only the user running the daemon can search through it. The socket is created that way, rather than restricted once it already takes connections
+			const mode_t previousMask{ umask(S_IXUSR | S_IRWXG | S_IRWXO) };
+			const bool isBound{ listener != -1 && bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0 };
+			umask(previousMask);
+
+			if (!isBound || listen(listener, 16) != 0)
+			{
+				std::cout << "Could not listen on " << socketPath << "\n";
+				if (listener != -1) close(listener);
+
+				return 1;
+			}
+
+			std::cout << "Serving the " << cache.GetNrOfFiles() << " files of " << currentDir << " on " << socketPath << std::endl;
+
+			for (;;)
+			{
+				pollfd descriptors[2]{ { listener, POLLIN, 0 }, { cache.GetNotifyDescriptor(), POLLIN, 0 } };
+
+				if (poll(descriptors, 2, -1) == -1)
+				{
+					if (errno == EINTR) continue;
+					break;
+				}
+
+				if ((descriptors[1].revents & POLLIN) != 0) cache.Update();
+
+				if ((descriptors[0].revents & POLLIN) != 0)
+				{
+					const int client{ accept4(listener, nullptr, nullptr, SOCK_CLOEXEC) };
+					if (client == -1) continue;
+
+					AnswerClient(client, cache);
+					close(client);
+				}
+			}
+
+			close(listener);
+
+			return 1;
+		}
+#endif
 	}
 }
 
-int RunCmdLine(int argc, char* argv[]);
-
 int main(int argc, char* argv[])
 {
-	return RunCmdLine(argc, argv);
+	const std::string currentDir{ std::filesystem::current_path().string() };
+
+#ifdef RDW_SS_HAS_INOTIFY
+	// a client only passes its arguments on
+	if (argc > 2 && std::string_view{ argv[1] } == "--client")
+	{
+		return RDW_SS::RunClient(argv[2], currentDir, std::vector<std::string>(argv + 3, argv + argc));
+	}
+#endif
+
+	return RunCmdLine(argc, argv, currentDir, nullptr);
 }
 
-int RunCmdLine(int argc, char* argv[])
+int RunCmdLine(int argc, char* argv[], const std::string& currentDir, DirectoryCache* pCache)
 {
 	using clock = std::chrono::high_resolution_clock;
 	const clock::time_point start{ clock::now() };
 
 	constexpr uint8_t MIN_NR_OF_ARGS{ 2 };
-	constexpr uint8_t MAX_NR_OF_ARGS{ 7 };
 
-	const uint8_t actualNrOfArgs{ static_cast<uint8_t>(argc - 1) };
-	if (!(actualNrOfArgs >= MIN_NR_OF_ARGS && actualNrOfArgs <= MAX_NR_OF_ARGS))
+	const int actualNrOfArgs{ argc - 1 };
+	if (actualNrOfArgs < MIN_NR_OF_ARGS)
 	{
 		std::cout << "Not enough arguments\n";
 		RDW_SS::PrintHelp();
 		return 1;
 	}
 
-	const std::string currentDir{ std::filesystem::current_path().string() };
+	RDW_SS::CmdOptions options{ RDW_SS::ParseCmdArgs(argc, argv, pCache != nullptr) };
+
+#ifdef RDW_SS_HAS_INOTIFY
+	if (pCache && !RDW_SS::CheckClientArgs(options)) return 1;
+#endif
+
+	// the globs of --include and --exclude join the mask, so it is compiled once
+	for (const std::string& glob : options.Includes) options.Mask += ";" + glob;
+	for (const std::string& glob : options.Excludes) options.Mask += ";!" + glob;
 
-	std::string stringToSearch{}, mask{}, fileToSearch{};
-	bool ignoreCase{}, recursivelySearch{};
-	int32_t recursiveDepth{};
+	const RDW_SS::FileMask fileMask{ options.Mask, options.UseIgnoreFiles };
 
-	RDW_SS::ParseCmdArgs(argc, argv, stringToSearch, mask, ignoreCase, recursivelySearch, recursiveDepth, fileToSearch);
+	if (!options.DaemonSocket.empty())
+	{
+#ifdef RDW_SS_HAS_INOTIFY
+		return RDW_SS::RunDaemon(options.DaemonSocket, currentDir, fileMask, options.RecursiveDepth);
+#else
+		std::cout << "--daemon is only supported on Linux\n";
+		return 1;
+#endif
+	}
 
-	if (!RDW_SS::CheckCmdArgs(stringToSearch, fileToSearch, recursivelySearch))
+	if (!RDW_SS::CheckCmdArgs(options))
 	{
 		std::cout << "Incorrect argument usage\n";
 		RDW_SS::PrintHelp();
 		return 1;
 	}
 
-	if (!recursivelySearch && std::filesystem::path{ fileToSearch }.is_relative())
+	if (!options.RecursivelySearch && std::filesystem::path{ options.FileToSearch }.is_relative())
 	{
-		fileToSearch = currentDir + "\\" + fileToSearch;
+		options.FileToSearch = (std::filesystem::path{ currentDir } / options.FileToSearch).string();
+	}
+
+	if (!options.IndexToBuild.empty())
+	{
+		RDW_SS::IndexStatistics indexStatistics{};
+		if (!RDW_SS::BuildIndex(currentDir, fileMask, options.RecursiveDepth, options.IndexToBuild, &indexStatistics)) return 1;
+
+		std::cout << "Indexed " << indexStatistics.NumberOfFilesIndexed << " files, reused " << indexStatistics.NumberOfFilesReused << " unchanged files\n";
+		std::cout << "Finished in " << std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - start).count() << " milliseconds\n";
+
+		return 0;
 	}
 
 	RDW_SS::StringSearchStatistics statistics{};
-	std::unordered_map<std::string, std::vector<uint32_t>> foundStrings{};
-	RDW_SS::IsStringInFile(currentDir, fileToSearch, mask, stringToSearch, ignoreCase, recursivelySearch, recursiveDepth, foundStrings, &statistics);
+	statistics.MeasurePhases = options.PrintStatistics;
+
+	// only the first match of a file is needed to list it
+	const RDW_SS::SearchOptions searchOptions{ fileMask, options.IgnoreCase, options.RecursivelySearch, options.RecursiveDepth, options.BinaryMode, { options.ListFiles ? 1 : options.MaxCount, options.Quiet }, &statistics };
+
+	if (options.Quiet && options.StreamResults)
+	{
+		// nothing gets printed anyway
+		options.StreamResults = false;
+	}
+
+	// the cached files are only searched as a whole
+	if (pCache && options.StreamResults)
+	{
+		options.StreamResults = false;
+	}
+
+	if (options.UseRegex && options.UseFuzzy)
+	{
+		std::cout << "Warning: --fuzzy is not supported together with --regex and is being ignored\n";
+		options.UseFuzzy = false;
+	}
 
-	std::cout << "Searched through " << statistics.NumberOfFilesSearched << " files\n";
+	if (!options.IndexToSearch.empty() && options.StreamResults)
+	{
+		std::cout << "Warning: --stream is not supported together with --index and is being ignored\n";
+		options.StreamResults = false;
+	}
+
+	// the line and json formats print nothing but the results, so other tools can read them
+	const bool printsSummary{ options.Format == RDW_SS::OutputFormat::Plain };
+	RDW_SS::ResultPrinter printer{ options.Format, options.StringsToSearch };
 
-	if (!foundStrings.empty())
+	if (options.StreamResults)
 	{
-		size_t nrOfOccurences{};
-		std::for_each(foundStrings.cbegin(), foundStrings.cend(), [&nrOfOccurences](const auto& kvPair)->void { nrOfOccurences += kvPair.second.size(); });
+		// results are printed as soon as their file is searched, only the totals are kept
+		std::vector<size_t> nrOfOccurences(options.StringsToSearch.size()), nrOfFiles(options.StringsToSearch.size());
+		std::string lastListedFile{};
 
-		std::cout << "Found " << nrOfOccurences << " of string search occurences across " << foundStrings.size() << " files\n";
+		const RDW_SS::ResultCallback onResult{ [&nrOfOccurences, &nrOfFiles, &lastListedFile, &printer, listFiles{ options.ListFiles }](RDW_SS::FileSearchResult&& result)->void
+			{
+				nrOfOccurences[result.PatternIndex] += result.LineNumbers.size();
+				++nrOfFiles[result.PatternIndex];
+
+				// all results of a file come in one after the other
+				if (listFiles)
+				{
+					if (result.Path != lastListedFile) std::cout << result.Path << "\n";
+
+					lastListedFile = std::move(result.Path);
+					return;
+				}
+
+				printer.Write(std::move(result));
+			} };
+
+		if (options.UseRegex)
+		{
+			if (!RDW_SS::IsRegexInFile(currentDir, options.FileToSearch, options.StringsToSearch, searchOptions, onResult, options.ReorderWindow)) return 1;
+		}
+		else if (options.UseFuzzy)
+		{
+			RDW_SS::IsFuzzyStringInFile(currentDir, options.FileToSearch, options.StringsToSearch, options.MaxNrOfErrors, searchOptions, onResult, options.ReorderWindow);
+		}
+		else
+		{
+			RDW_SS::IsStringInFile(currentDir, options.FileToSearch, options.StringsToSearch, searchOptions, onResult, options.ReorderWindow);
+		}
+
+		printer.Flush();
+
+		if (options.ListFiles)
+		{
+			if (options.PrintStatistics) RDW_SS::PrintStatistics(statistics, options.PrintStatisticsAsJson);
+
+			return 0;
+		}
 
-		for (const auto& [file, lineNumbers] : foundStrings)
+		if (printsSummary)
 		{
-			std::cout << "Found " << lineNumbers.size() << " occurences in " << file << " at lines: ";
-			for (size_t i{}; i < lineNumbers.size() - 1; ++i)
+			std::cout << "\n";
+			RDW_SS::PrintNrOfFilesSearched(statistics);
+
+			for (size_t i{}; i < options.StringsToSearch.size(); ++i)
 			{
-				std::cout << lineNumbers[i] << ", ";
+				if (options.StringsToSearch.size() > 1) std::cout << "\"" << options.StringsToSearch[i] << "\": ";
+
+				std::cout << "Found " << nrOfOccurences[i] << " of string search occurences across " << nrOfFiles[i] << " files\n";
 			}
-			std::cout << lineNumbers.back() << "\n";
 		}
 	}
 	else
 	{
-		std::cout << "No occurences found!\n";
+		std::vector<RDW_SS::FileSearchResult> results{};
+#ifdef RDW_SS_HAS_INOTIFY
+		if (pCache && options.RecursivelySearch && options.IndexToSearch.empty())
+		{
+			const bool isSearched{ options.UseRegex
+				? RDW_SS::IsRegexInCachedFiles(*pCache, currentDir, options.StringsToSearch, searchOptions, results)
+				: options.UseFuzzy
+				? RDW_SS::IsFuzzyStringInCachedFiles(*pCache, currentDir, options.StringsToSearch, options.MaxNrOfErrors, searchOptions, results)
+				: RDW_SS::IsStringInCachedFiles(*pCache, currentDir, options.StringsToSearch, searchOptions, results) };
+
+			if (!isSearched) return 1;
+		}
+		else
+#endif
+		if (!options.IndexToSearch.empty())
+		{
+			const bool isSearched{ options.UseRegex
+				? RDW_SS::IsRegexInIndexedFiles(options.IndexToSearch, options.StringsToSearch, searchOptions, results)
+				: options.UseFuzzy
+				? RDW_SS::IsFuzzyStringInIndexedFiles(options.IndexToSearch, options.StringsToSearch, options.MaxNrOfErrors, searchOptions, results)
+				: RDW_SS::IsStringInIndexedFiles(options.IndexToSearch, options.StringsToSearch, searchOptions, results) };
+
+			if (!isSearched) return 1;
+		}
+		else if (options.UseRegex)
+		{
+			if (!RDW_SS::IsRegexInFile(currentDir, options.FileToSearch, options.StringsToSearch, searchOptions, results)) return 1;
+		}
+		else if (options.UseFuzzy)
+		{
+			RDW_SS::IsFuzzyStringInFile(currentDir, options.FileToSearch, options.StringsToSearch, options.MaxNrOfErrors, searchOptions, results);
+		}
+		else
+		{
+			RDW_SS::IsStringInFile(currentDir, options.FileToSearch, options.StringsToSearch, searchOptions, results);
+		}
+
+		// like grep, a quiet search only tells through its exit code whether anything was found
+		if (options.Quiet)
+		{
+			if (options.PrintStatistics) RDW_SS::PrintStatistics(statistics, options.PrintStatisticsAsJson);
+
+			return results.empty() ? 1 : 0;
+		}
+
+		if (options.ListFiles)
+		{
+			RDW_SS::PrintMatchingFiles(results);
+
+			if (options.PrintStatistics) RDW_SS::PrintStatistics(statistics, options.PrintStatisticsAsJson);
+
+			return 0;
+		}
+
+		const clock::time_point outputStart{ clock::now() };
+
+		if (printsSummary)
+		{
+			RDW_SS::PrintNrOfFilesSearched(statistics);
+
+			for (size_t i{}; i < options.StringsToSearch.size(); ++i)
+			{
+				if (options.StringsToSearch.size() > 1)
+				{
+					std::cout << "\nResults for \"" << options.StringsToSearch[i] << "\":\n";
+				}
+
+				RDW_SS::PrintFoundStrings(results, static_cast<uint32_t>(i), printer);
+			}
+		}
+		else
+		{
+			printer.Write(results);
+		}
+
+		// the results are only printed once the search is done, so printing them is part of the output phase
+		const uint64_t outputTime{ static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - outputStart).count()) };
+		statistics.OutputTime += outputTime;
+		statistics.TotalTime += outputTime;
 	}
 
-	std::cout << "Finished in " << std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - start).count() << " milliseconds\n";
+	if (options.PrintStatistics)
+	{
+		RDW_SS::PrintStatistics(statistics, options.PrintStatisticsAsJson);
+	}
+
+	if (printsSummary)
+	{
+		std::cout << "Finished in " << std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - start).count() << " milliseconds\n";
+	}
 
 	return 0;
 }
\ No newline at end of file